@@ -0,0 +1,202 @@
+#include "../includes/allocation_trace.h"
+#include "../includes/latency_histogram.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+std::atomic<uint64_t> next_writer_serial{1};
+std::atomic<uint64_t> next_thread_token{1};
+
+// Unlike std::thread::id, never reused by a later thread
+thread_local uint64_t thread_token = 0;
+
+// Last buffer this thread used; the serial keeps a stale entry from matching a newer writer
+struct ThreadCache {
+    uint64_t serial = 0;
+    void* buffer = nullptr;
+};
+
+thread_local ThreadCache thread_cache;
+
+uint8_t alignmentLog2(size_t alignment) {
+    if (alignment <= 8) return 0;
+    uint8_t shift = 0;
+    while ((size_t(1) << shift) < alignment) ++shift;
+    return shift;
+}
+
+} // namespace
+
+TraceWriter::TraceWriter(const std::string& path)
+    : file_(std::fopen(path.c_str(), "wb")), active_(false), buffers_(nullptr), next_thread_(0),
+      recorded_(0), serial_(next_writer_serial.fetch_add(1, std::memory_order_relaxed)),
+      start_ticks_(cycle_clock::now()) {
+    if (!file_) {
+        throw std::runtime_error("cannot create trace file " + path);
+    }
+
+    TraceFileHeader header{};
+    std::memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+    header.version = kTraceVersion;
+    header.record_size = sizeof(TraceRecord);
+    header.ns_per_tick = cycle_clock::nanosecondsPerTick();
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+        std::fclose(file_);
+        throw std::runtime_error("cannot write trace file " + path);
+    }
+    active_.store(true, std::memory_order_release);
+}
+
+TraceWriter::~TraceWriter() {
+    finish();
+    ThreadBuffer* buffer = buffers_.load(std::memory_order_acquire);
+    while (buffer) {
+        ThreadBuffer* next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+}
+
+void TraceWriter::recordAllocation(void* ptr, size_t size, size_t alignment) {
+    record(TraceOp::ALLOCATE, ptr, size, alignmentLog2(alignment));
+}
+
+void TraceWriter::recordDeallocation(void* ptr, size_t size) {
+    record(TraceOp::DEALLOCATE, ptr, size, 0);
+}
+
+void TraceWriter::record(TraceOp op, void* ptr, size_t size, uint8_t alignment_log2) {
+    if (!active_.load(std::memory_order_acquire)) return;
+
+    ThreadBuffer* buffer = threadBuffer();
+    TraceRecord& entry = buffer->records[buffer->count];
+    entry.timestamp = cycle_clock::now() - start_ticks_;
+    entry.object_id = reinterpret_cast<uintptr_t>(ptr);
+    entry.size = size;
+    entry.thread = buffer->thread;
+    entry.op = static_cast<uint8_t>(op);
+    entry.alignment_log2 = alignment_log2;
+    entry.reserved = 0;
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+
+    if (++buffer->count == kChunkRecords) {
+        std::lock_guard<std::mutex> lock(file_mutex_);
+        writeChunk(*buffer);
+    }
+}
+
+TraceWriter::ThreadBuffer* TraceWriter::threadBuffer() {
+    if (thread_cache.serial == serial_) {
+        return static_cast<ThreadBuffer*>(thread_cache.buffer);
+    }
+    ThreadBuffer* buffer = attachThread();
+    thread_cache.serial = serial_;
+    thread_cache.buffer = buffer;
+    return buffer;
+}
+
+TraceWriter::ThreadBuffer* TraceWriter::attachThread() {
+    // A thread whose cache now points at another writer continues its old buffer
+    if (thread_token == 0) {
+        thread_token = next_thread_token.fetch_add(1, std::memory_order_relaxed);
+    }
+    uint64_t self = thread_token;
+    for (ThreadBuffer* buffer = buffers_.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        if (buffer->owner == self) return buffer;
+    }
+
+    ThreadBuffer* created = new ThreadBuffer;
+    created->owner = self;
+    created->thread = next_thread_.fetch_add(1, std::memory_order_relaxed);
+    created->count = 0;
+    created->next = buffers_.load(std::memory_order_relaxed);
+    while (!buffers_.compare_exchange_weak(created->next, created,
+                                           std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return created;
+}
+
+void TraceWriter::writeChunk(ThreadBuffer& buffer) {
+    if (buffer.count == 0) return;
+
+    if (file_) {
+        TraceChunkHeader chunk{buffer.thread, static_cast<uint32_t>(buffer.count)};
+        std::fwrite(&chunk, sizeof(chunk), 1, file_);
+        std::fwrite(buffer.records, sizeof(TraceRecord), buffer.count, file_);
+    }
+    buffer.count = 0;
+}
+
+void TraceWriter::finish() {
+    if (!active_.exchange(false, std::memory_order_acq_rel)) return;
+
+    std::lock_guard<std::mutex> lock(file_mutex_);
+    for (ThreadBuffer* buffer = buffers_.load(std::memory_order_acquire); buffer; buffer = buffer->next) {
+        writeChunk(*buffer);
+    }
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+AllocationTrace AllocationTrace::load(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("cannot open trace file " + path);
+    }
+
+    TraceFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        std::memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0) {
+        std::fclose(file);
+        throw std::runtime_error(path + " is not an allocation trace");
+    }
+    if (header.version != kTraceVersion || header.record_size != sizeof(TraceRecord)) {
+        std::fclose(file);
+        throw std::runtime_error(path + ": unsupported trace version " + std::to_string(header.version));
+    }
+
+    AllocationTrace trace;
+    trace.ns_per_tick = header.ns_per_tick;
+
+    TraceChunkHeader chunk;
+    while (std::fread(&chunk, sizeof(chunk), 1, file) == 1) {
+        size_t first = trace.records.size();
+        trace.records.resize(first + chunk.count);
+        if (std::fread(&trace.records[first], sizeof(TraceRecord), chunk.count, file) != chunk.count) {
+            std::fclose(file);
+            throw std::runtime_error(path + ": truncated chunk");
+        }
+        trace.thread_count = std::max(trace.thread_count, chunk.thread + 1);
+    }
+    std::fclose(file);
+
+    // Chunks of one thread are in file order, so a stable sort keeps its program order
+    std::stable_sort(trace.records.begin(), trace.records.end(),
+                     [](const TraceRecord& a, const TraceRecord& b) { return a.timestamp < b.timestamp; });
+    return trace;
+}
+
+TracingAllocator::TracingAllocator(MemoryAllocator& inner, TraceWriter& writer)
+    : MemoryAllocator(inner.getTotalMemory()), inner_(inner), writer_(writer) {
+}
+
+void* TracingAllocator::allocate(size_t size) {
+    void* ptr = inner_.allocate(size);
+    writer_.recordAllocation(ptr, size); // Failures are kept with id 0
+    return ptr;
+}
+
+void TracingAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+    // Before the free: once released, another thread may get this address back
+    writer_.recordDeallocation(ptr);
+    inner_.deallocate(ptr);
+}
+
+void TracingAllocator::deallocate(void* ptr, size_t size) {
+    if (!ptr) return;
+    writer_.recordDeallocation(ptr, size);
+    inner_.deallocate(ptr, size);
+}
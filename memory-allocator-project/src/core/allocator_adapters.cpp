@@ -0,0 +1,53 @@
+#include "../includes/allocator_adapters.h"
+#include <cassert>
+#include <cstdint>
+
+namespace allocator_adapters {
+
+void* allocateAligned(MemoryAllocator& allocator, size_t bytes, size_t alignment) {
+    if (bytes == 0) bytes = 1;
+    if (alignment <= kNaturalAlignment) {
+        void* ptr = allocator.allocate(bytes);
+        assert(reinterpret_cast<uintptr_t>(ptr) % kNaturalAlignment == 0 && "allocator broke kNaturalAlignment");
+        return ptr;
+    }
+    
+    // Room to slide up to the boundary, plus a slot for the original pointer
+    void* raw = allocator.allocate(bytes + alignment + sizeof(void*));
+    if (!raw) return nullptr;
+    
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+    uintptr_t aligned = (start + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void deallocateAligned(MemoryAllocator& allocator, void* ptr, size_t bytes, size_t alignment) {
+    if (!ptr) return;
+    if (bytes == 0) bytes = 1;
+    if (alignment <= kNaturalAlignment) {
+        allocator.deallocate(ptr, bytes);
+        return;
+    }
+    
+    allocator.deallocate(static_cast<void**>(ptr)[-1], bytes + alignment + sizeof(void*));
+}
+
+} // namespace allocator_adapters
+
+void* MemoryResourceAdapter::do_allocate(size_t bytes, size_t alignment) {
+    void* ptr = allocator_adapters::allocateAligned(*allocator_, bytes, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void MemoryResourceAdapter::do_deallocate(void* ptr, size_t bytes, size_t alignment) {
+    allocator_adapters::deallocateAligned(*allocator_, ptr, bytes, alignment);
+}
+
+bool MemoryResourceAdapter::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    const auto* adapter = dynamic_cast<const MemoryResourceAdapter*>(&other);
+    return adapter && adapter->allocator_ == allocator_;
+}
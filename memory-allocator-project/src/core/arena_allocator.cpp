@@ -0,0 +1,150 @@
+#include "../includes/arena_allocator.h"
+#include "../includes/os_memory.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+ArenaAllocator::ArenaAllocator(size_t total_memory, size_t chunk_size)
+    : MemoryAllocator(total_memory), chunk_size_(os_round_to_pages(chunk_size ? chunk_size : 1)),
+      chunks_(nullptr), cursor_(nullptr), limit_(nullptr), chunk_count_(0), mapped_bytes_(0),
+      used_bytes_(0), live_allocations_(0), resets_(0) {
+    // The first chunk is mapped up front and kept across resets
+    if (chunk_size_ <= total_memory && !mapChunk(0)) {
+        throw std::runtime_error("Failed to map arena chunk");
+    }
+}
+
+ArenaAllocator::~ArenaAllocator() {
+    releaseChunks(nullptr);
+}
+
+ArenaAllocator::Chunk* ArenaAllocator::mapChunk(size_t min_payload) {
+    size_t size = std::max(chunk_size_, os_round_to_pages(sizeof(Chunk) + min_payload));
+    if (size > total_memory_ - std::min(total_memory_, mapped_bytes_)) {
+        return nullptr;
+    }
+
+    Chunk* chunk = static_cast<Chunk*>(os_map_pages(size));
+    if (!chunk) return nullptr;
+
+    chunk->next = chunks_;
+    chunk->size = size;
+    chunks_ = chunk;
+    cursor_ = reinterpret_cast<char*>(chunk + 1);
+    limit_ = reinterpret_cast<char*>(chunk) + size;
+    ++chunk_count_;
+    mapped_bytes_ += size;
+    return chunk;
+}
+
+void ArenaAllocator::releaseChunks(Chunk* stop) {
+    while (chunks_ != stop) {
+        Chunk* next = chunks_->next;
+        mapped_bytes_ -= chunks_->size;
+        --chunk_count_;
+        os_unmap_pages(chunks_, chunks_->size);
+        chunks_ = next;
+    }
+}
+
+void* ArenaAllocator::allocate(size_t size, size_t alignment) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || size > total_memory_) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+    if (!cursor_ || size > static_cast<size_t>(limit_ - cursor_) ||
+        aligned + size > reinterpret_cast<uintptr_t>(limit_)) {
+        // The rest of the current chunk is abandoned until reset()
+        if (!mapChunk(size + alignment)) {
+            counters_.recordFailure();
+            return nullptr;
+        }
+        aligned = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(alignment - 1);
+    }
+
+    cursor_ = reinterpret_cast<char*>(aligned + size);
+    used_bytes_ += size;
+    ++live_allocations_;
+    counters_.recordAllocation(size);
+    return reinterpret_cast<void*>(aligned);
+}
+
+void ArenaAllocator::reset() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Keep the oldest chunk (the constructor's), unmap the ones chained in front of it
+    Chunk* oldest = chunks_;
+    while (oldest && oldest->next) {
+        oldest = oldest->next;
+    }
+    releaseChunks(oldest);
+
+    cursor_ = oldest ? reinterpret_cast<char*>(oldest + 1) : nullptr;
+    limit_ = oldest ? reinterpret_cast<char*>(oldest) + oldest->size : nullptr;
+
+    // One bulk deallocation, so totals and peaks stay meaningful across resets
+    if (live_allocations_ > 0) {
+        counters_.recordDeallocation(used_bytes_, StatsCounters::kNoClass, live_allocations_);
+    }
+    used_bytes_ = 0;
+    live_allocations_ = 0;
+    ++resets_;
+}
+
+size_t ArenaAllocator::getChunkCount() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return chunk_count_;
+}
+
+size_t ArenaAllocator::getMappedBytes() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return mapped_bytes_;
+}
+
+size_t ArenaAllocator::getFragmentation() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Padding, headers and abandoned chunk tails, relative to the mapped chunks
+    // in use; the untouched rest of the current chunk is not counted
+    if (!chunks_) return 0;
+    size_t consumed = mapped_bytes_ - static_cast<size_t>(limit_ - cursor_);
+    return consumed ? (consumed - used_bytes_) * 100 / consumed : 0;
+}
+
+std::string ArenaAllocator::getStats() const {
+    // Base stats call getFragmentation(), which takes the lock itself
+    std::string stats = MemoryAllocator::getStats();
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    std::ostringstream oss;
+    oss << "Arena Allocator Stats:\n";
+    oss << "  Chunk Size: " << chunk_size_ << " bytes\n";
+    oss << "  Chunks: " << chunk_count_ << " (" << mapped_bytes_ << " bytes mapped)\n";
+    oss << "  In Use Since Reset: " << used_bytes_ << " bytes in " << live_allocations_ << " allocations\n";
+    oss << "  Left In Current Chunk: " << (chunks_ ? static_cast<size_t>(limit_ - cursor_) : 0) << " bytes\n";
+    oss << "  Resets: " << resets_ << "\n";
+    return stats + oss.str();
+}
+
+std::vector<MemoryAllocator::MemoryBlock> ArenaAllocator::getMemoryLayout() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Per chunk: what the bump pointer has passed, and what is left of it
+    std::vector<MemoryAllocator::MemoryBlock> layout;
+    for (const Chunk* chunk = chunks_; chunk; chunk = chunk->next) {
+        size_t base = reinterpret_cast<size_t>(chunk);
+        size_t used = chunk == chunks_ ? static_cast<size_t>(cursor_ - reinterpret_cast<const char*>(chunk))
+                                       : chunk->size;
+        layout.push_back({base, used, false, "Arena Used"});
+        if (used < chunk->size) {
+            layout.push_back({base + used, chunk->size - used, true, "Arena Free"});
+        }
+    }
+    return layout;
+}
@@ -4,21 +4,27 @@
 #include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <cassert>
 
-BuddyAllocator::BuddyAllocator(size_t initial_size)
+BuddyAllocator::BuddyAllocator(size_t initial_size, void* memory)
     : MemoryAllocator(initial_size),
-      root_block_(nullptr), min_block_size_(32), 
+      root_block_(nullptr), memory_pool_(memory), owns_memory_(memory == nullptr), min_block_size_(32),
       total_splits_(0), total_coalesces_(0), failed_coalesces_(0) {
     
     // Ensure initial_size is power of 2
     max_block_size_ = next_power_of_2(initial_size);
+    if (!owns_memory_ && max_block_size_ != initial_size) {
+        max_block_size_ >>= 1; // Must fit inside the caller's region
+    }
     if (max_block_size_ != initial_size) {
         // Update total memory to correct size
         total_memory_ = max_block_size_;
     }
     
     // Allocate memory pool
-    memory_pool_ = std::malloc(max_block_size_);
+    if (owns_memory_) {
+        memory_pool_ = std::malloc(max_block_size_);
+    }
     if (!memory_pool_) {
         throw std::bad_alloc();
     }
@@ -31,38 +37,45 @@ BuddyAllocator::BuddyAllocator(size_t initial_size)
     // Add root block to level 0 free list
     free_lists_[0].push_back(root_block_);
     
+#ifndef MEMORY_ALLOCATOR_QUIET
     std::cout << "Buddy Allocator initialized:\n";
     std::cout << "  Total size: " << max_block_size_ << " bytes\n";
     std::cout << "  Min block size: " << min_block_size_ << " bytes\n";
     std::cout << "  Tree grows dynamically based on allocations\n";
+#endif
 }
 
 BuddyAllocator::~BuddyAllocator() {
+#ifndef MEMORY_ALLOCATOR_QUIET
     std::cout << "Buddy Allocator Statistics:\n";
     std::cout << "  Total splits: " << total_splits_ << "\n";
     std::cout << "  Total coalesces: " << total_coalesces_ << "\n";
     std::cout << "  Failed coalesces: " << failed_coalesces_ << "\n";
+#endif
     
     // Clean up buddy tree (recursive deletion handled by destructor)
     delete root_block_;
     
     // Free memory pool
-    if (memory_pool_) {
+    if (memory_pool_ && owns_memory_) {
         std::free(memory_pool_);
     }
 }
 
 void* BuddyAllocator::allocate(size_t size) {
-    std::lock_guard<std::mutex> lock(allocator_mutex_);
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    std::lock_guard<ContendedMutex> lock(allocator_mutex_);
     
     if (size == 0) return nullptr;
     
     // Find appropriate block size (next power of 2, at least min_block_size)
     size_t block_size = std::max(next_power_of_2(size), min_block_size_);
+    if (probe.active()) probe.setClass(get_level_for_size(block_size));
     
     // Find a free block
     BuddyBlock* block = find_free_block(block_size);
     if (!block) {
+        counters_.recordFailure();
         return nullptr; // Out of memory
     }
     
@@ -73,32 +86,61 @@ void* BuddyAllocator::allocate(size_t size) {
     
     // Mark block as allocated
     block->is_free = false;
-    allocated_blocks_[block->address] = block;
     
     // Update statistics
-    allocated_size_ += block->size;
-    allocation_count_++;
+    counters_.recordAllocation(block->size);
     
     return block->address;
 }
 
-void BuddyAllocator::deallocate(void* ptr) {
-    if (!ptr) return;
+size_t BuddyAllocator::release(void* ptr) {
+    if (!ptr) return 0;
     
-    std::lock_guard<std::mutex> lock(allocator_mutex_);
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    std::lock_guard<ContendedMutex> lock(allocator_mutex_);
     
     // Find the block
-    auto it = allocated_blocks_.find(ptr);
-    if (it == allocated_blocks_.end()) {
+    BuddyBlock* block = find_block_by_address(ptr);
+    if (!block) {
         std::cerr << "Error: Trying to deallocate unallocated pointer\n";
-        return;
+        return 0;
     }
     
-    BuddyBlock* block = it->second;
-    allocated_blocks_.erase(it);
+    if (probe.active()) probe.setClass(get_level_for_size(block->size));
+    size_t freed = block->size; // Coalescing may delete the node
+    release_block(block);
+    return freed;
+}
+
+size_t BuddyAllocator::release(void* ptr, size_t size) {
+    if (!ptr) return 0;
+    
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    std::lock_guard<ContendedMutex> lock(allocator_mutex_);
+    
+    // The block allocate(size) returned, without walking below its level
+    size_t block_size = std::max(next_power_of_2(size), min_block_size_);
+    if (probe.active()) probe.setClass(get_level_for_size(block_size));
+    BuddyBlock* block = find_block_for_size(ptr, block_size);
+    if (!block) {
+        assert(!"BuddyAllocator: deallocate of a block that is not allocated at that size");
+        block = find_block_by_address(ptr);
+        if (!block) {
+            std::cerr << "Error: Trying to deallocate unallocated pointer\n";
+            return 0;
+        }
+    }
+    assert(block->size == block_size && "BuddyAllocator: deallocate size does not match the allocation");
     
-    // Mark as free
+    size_t freed = block->size; // Coalescing may delete the node
+    release_block(block);
+    return freed;
+}
+
+void BuddyAllocator::release_block(BuddyBlock* block) {
+    // Mark as free (coalescing may delete the node, so keep its size)
     block->is_free = true;
+    size_t block_size = block->size;
     
     // Add to appropriate free list (create if needed)
     int level = get_level_for_size(block->size);
@@ -111,8 +153,7 @@ void BuddyAllocator::deallocate(void* ptr) {
     coalesce_block(block);
     
     // Update statistics
-    allocated_size_ -= block->size;
-    deallocation_count_++;
+    counters_.recordDeallocation(block_size);
 }
 
 // Helper method implementations
@@ -143,10 +184,17 @@ int BuddyAllocator::get_current_max_level() const {
         }
     }
     
-    // Also check allocated blocks for deeper levels
-    for (const auto& pair : allocated_blocks_) {
-        BuddyBlock* block = pair.second;
-        max_level = std::max(max_level, block->level);
+    // Also check allocated blocks (non-free leaves) for deeper levels
+    std::vector<BuddyBlock*> pending = {root_block_};
+    while (!pending.empty()) {
+        BuddyBlock* block = pending.back();
+        pending.pop_back();
+        if (block->left_child) {
+            pending.push_back(block->left_child);
+            pending.push_back(block->right_child);
+        } else if (!block->is_free) {
+            max_level = std::max(max_level, block->level);
+        }
     }
     
     return max_level;
@@ -172,6 +220,9 @@ BuddyAllocator::BuddyBlock* BuddyAllocator::split_block(BuddyBlock* block, size_
     while (block->size > target_size) {
         total_splits_++;
         
+        // A split block is no longer free as a whole
+        block->is_free = false;
+        
         size_t half_size = block->size / 2;
         int child_level = block->level + 1;
         
@@ -202,7 +253,8 @@ BuddyAllocator::BuddyBlock* BuddyAllocator::split_block(BuddyBlock* block, size_
 }
 
 void BuddyAllocator::coalesce_block(BuddyBlock* block) {
-    while (block->parent && block->buddy && block->buddy->is_free) {
+    // Only merge with a buddy that is free and not split itself
+    while (block->parent && block->buddy && block->buddy->is_free && !block->buddy->left_child) {
         total_coalesces_++;
         
         // Remove buddy from free list
@@ -222,6 +274,10 @@ void BuddyAllocator::coalesce_block(BuddyBlock* block) {
         // Mark parent as free and add to appropriate free list
         BuddyBlock* parent = block->parent;
         parent->is_free = true;
+        delete parent->left_child;
+        delete parent->right_child;
+        parent->left_child = nullptr;
+        parent->right_child = nullptr;
         
         // Create free list for parent level if needed
         if (free_lists_.find(parent->level) == free_lists_.end()) {
@@ -235,9 +291,30 @@ void BuddyAllocator::coalesce_block(BuddyBlock* block) {
 }
 
 BuddyAllocator::BuddyBlock* BuddyAllocator::find_block_by_address(void* addr) const {
-    // This is a simplified implementation - in practice, you'd traverse the tree
-    auto it = allocated_blocks_.find(addr);
-    return (it != allocated_blocks_.end()) ? it->second : nullptr;
+    // Allocated blocks are leaves: follow the half that contains addr down to one
+    return find_block_for_size(addr, 0);
+}
+
+BuddyAllocator::BuddyBlock* BuddyAllocator::find_block_for_size(void* addr, size_t block_size) const {
+    char* address = static_cast<char*>(addr);
+    char* base = static_cast<char*>(memory_pool_);
+    if (address < base || address >= base + max_block_size_) {
+        return nullptr;
+    }
+    
+    BuddyBlock* node = root_block_;
+    while (node->left_child && node->size > block_size) {
+        node = address < static_cast<char*>(node->right_child->address) ? node->left_child : node->right_child;
+    }
+    
+    bool allocated = !node->is_free && !node->left_child && node->address == addr;
+    return allocated ? node : nullptr;
+}
+
+size_t BuddyAllocator::get_block_size(void* ptr) const {
+    std::lock_guard<ContendedMutex> lock(allocator_mutex_);
+    BuddyBlock* block = find_block_by_address(ptr);
+    return block ? block->size : 0;
 }
 
 void BuddyAllocator::print_buddy_tree() const {
@@ -312,7 +389,7 @@ std::vector<MemoryAllocator::MemoryBlock> BuddyAllocator::getMemoryLayout() cons
     MemoryAllocator::MemoryBlock block;
     block.address = reinterpret_cast<size_t>(memory_pool_);
     block.size = total_memory_;
-    block.is_free = (allocated_size_ == 0);
+    block.is_free = (getAllocatedSize() == 0);
     block.type = "buddy";
     
     blocks.push_back(block);
@@ -320,15 +397,23 @@ std::vector<MemoryAllocator::MemoryBlock> BuddyAllocator::getMemoryLayout() cons
 }
 
 std::string BuddyAllocator::getStats() const {
+    StatsCounters::Snapshot snapshot = counters_.snapshot();
+    
     std::ostringstream oss;
     oss << "Buddy System Allocator Statistics:\n";
     oss << "  Total Memory: " << total_memory_ << " bytes\n";
-    oss << "  Allocated: " << allocated_size_ << " bytes\n";
-    oss << "  Free: " << (total_memory_ - allocated_size_) << " bytes\n";
-    oss << "  Allocations: " << allocation_count_ << "\n";
-    oss << "  Deallocations: " << deallocation_count_ << "\n";
+    oss << "  Allocated: " << snapshot.current_bytes << " bytes\n";
+    oss << "  Peak Allocated: " << snapshot.peak_bytes << " bytes\n";
+    oss << "  Free: " << (total_memory_ - snapshot.current_bytes) << " bytes\n";
+    oss << "  Allocations: " << snapshot.allocations << "\n";
+    oss << "  Deallocations: " << snapshot.deallocations << "\n";
+    oss << "  Failed Allocations: " << snapshot.failures << "\n";
     oss << "  Fragmentation: " << getFragmentation() << "%\n";
-    return oss.str();
+    
+    std::string stats = oss.str();
+    appendLatencyLine(stats, "  Allocate Latency:", latency_.summary(LatencyRecorder::Op::ALLOCATE));
+    appendLatencyLine(stats, "  Deallocate Latency:", latency_.summary(LatencyRecorder::Op::DEALLOCATE));
+    return stats;
 }
 
 size_t BuddyAllocator::getFragmentation() const {
@@ -336,23 +421,29 @@ size_t BuddyAllocator::getFragmentation() const {
     // In a real buddy allocator, this would analyze the buddy tree
     if (total_memory_ == 0) return 0;
     
-    size_t free_memory = total_memory_ - allocated_size_;
+    size_t free_memory = total_memory_ - getAllocatedSize();
     if (free_memory == 0) return 0;
     
     // Simple heuristic: fragmentation is based on number of allocations vs free space
-    if (allocation_count_ > deallocation_count_ && free_memory > 0) {
-        return static_cast<size_t>((100.0 * (allocation_count_ - deallocation_count_)) / allocation_count_);
+    size_t allocation_count = getAllocationCount();
+    size_t deallocation_count = getDeallocationCount();
+    if (allocation_count > deallocation_count && free_memory > 0) {
+        return static_cast<size_t>((100.0 * (allocation_count - deallocation_count)) / allocation_count);
     }
     
     return 0; // No fragmentation if no active allocations
 }
 
 void BuddyAllocator::reset() {
-    // Reset statistics
-    allocated_size_ = 0;
-    allocation_count_ = 0;
-    deallocation_count_ = 0;
+    std::lock_guard<ContendedMutex> lock(allocator_mutex_);
     
-    // In a real implementation, would reinitialize the buddy tree
-    // For now, just reset counters
+    // Back to a single free root over the same memory; every block is freed
+    delete root_block_;
+    root_block_ = new BuddyBlock(max_block_size_, memory_pool_, 0);
+    free_lists_.clear();
+    free_lists_[0].push_back(root_block_);
+    
+    // Reset statistics
+    counters_.reset();
+    latency_.reset();
 }
@@ -0,0 +1,119 @@
+#include "../includes/frame_allocator.h"
+#include "../includes/os_memory.h"
+#include <sstream>
+#include <stdexcept>
+
+FrameAllocator::FrameAllocator(size_t total_memory)
+    : MemoryAllocator(total_memory), memory_(nullptr), mapped_size_(os_round_to_pages(total_memory ? total_memory : 1)),
+      frame_capacity_(total_memory / 2), frames_{{0, 0, 0}, {0, 0, 0}}, current_(0), frame_number_(0) {
+    memory_ = static_cast<char*>(os_map_pages(mapped_size_));
+    if (!memory_) {
+        throw std::runtime_error("Failed to map frame allocator memory");
+    }
+}
+
+FrameAllocator::~FrameAllocator() {
+    os_unmap_pages(memory_, mapped_size_);
+}
+
+void* FrameAllocator::allocate(size_t size, size_t alignment) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || size > frame_capacity_) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Addresses, not offsets, are aligned: the second half need not be
+    char* base = memory_ + current_ * frame_capacity_;
+    Frame& frame = frames_[current_];
+    uintptr_t start = reinterpret_cast<uintptr_t>(base);
+    uintptr_t aligned = (start + frame.offset + alignment - 1) & ~(alignment - 1);
+    size_t offset = aligned - start;
+    if (offset > frame_capacity_ || size > frame_capacity_ - offset) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+
+    frame.offset = offset + size;
+    ++frame.allocations;
+    frame.bytes += size;
+    counters_.recordAllocation(size);
+    return base + offset;
+}
+
+void FrameAllocator::rewind(Frame& frame) {
+    if (frame.allocations > 0) {
+        counters_.recordDeallocation(frame.bytes, StatsCounters::kNoClass, frame.allocations);
+    }
+    frame = {0, 0, 0};
+}
+
+void FrameAllocator::nextFrame() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // The half being switched to still holds the frame before last
+    current_ ^= 1;
+    rewind(frames_[current_]);
+    ++frame_number_;
+}
+
+void FrameAllocator::reset() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    rewind(frames_[0]);
+    rewind(frames_[1]);
+}
+
+uint64_t FrameAllocator::getFrameNumber() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return frame_number_;
+}
+
+size_t FrameAllocator::getUsed(bool previous) const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return frames_[previous ? current_ ^ 1 : current_].offset;
+}
+
+size_t FrameAllocator::getFragmentation() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Alignment padding relative to what both frames consume
+    size_t consumed = frames_[0].offset + frames_[1].offset;
+    size_t requested = frames_[0].bytes + frames_[1].bytes;
+    return consumed ? (consumed - requested) * 100 / consumed : 0;
+}
+
+std::string FrameAllocator::getStats() const {
+    // Base stats call getFragmentation(), which takes the lock itself
+    std::string stats = MemoryAllocator::getStats();
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    const Frame& current = frames_[current_];
+    const Frame& previous = frames_[current_ ^ 1];
+
+    std::ostringstream oss;
+    oss << "Frame Allocator Stats:\n";
+    oss << "  Frame: " << frame_number_ << " (" << frame_capacity_ << " bytes per frame)\n";
+    oss << "  Current Frame: " << current.offset << " bytes (" << current.allocations << " allocations)\n";
+    oss << "  Previous Frame: " << previous.offset << " bytes (" << previous.allocations << " allocations)\n";
+    return stats + oss.str();
+}
+
+std::vector<MemoryAllocator::MemoryBlock> FrameAllocator::getMemoryLayout() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    std::vector<MemoryAllocator::MemoryBlock> layout;
+    for (size_t half = 0; half < 2; ++half) {
+        size_t base = half * frame_capacity_;
+        const Frame& frame = frames_[half];
+        const char* info = half == current_ ? "Current Frame" : "Previous Frame";
+        if (frame.offset > 0) {
+            layout.push_back({base, frame.offset, false, info});
+        }
+        if (frame.offset < frame_capacity_) {
+            layout.push_back({base + frame.offset, frame_capacity_ - frame.offset, true, "Frame Free"});
+        }
+    }
+    return layout;
+}
@@ -1,9 +1,52 @@
 #include "../includes/hybrid_allocator.h"
+#include "../includes/os_memory.h"
 #include <algorithm>
+#include <cassert>
 #include <cmath>
+#include <new>
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <cstring>
 
 HybridAllocator::HybridAllocator(size_t total_memory, const HybridConfig& config)
-    : MemoryAllocator(total_memory), config_(config) {
+    : MemoryAllocator(total_memory), config_(config), region_(nullptr), region_size_(0),
+      region_used_(0), page_size_(os_page_size()), tier_count_(0), page_count_(0),
+      tier_counters_(static_cast<size_t>(AllocatorType::MAPPED) + 1), huge_threshold_(0) {
+    
+    if (config.slab_object_sizes.size() != config.slab_objects_per_slab.size() ||
+        (!config.pool_class_weights.empty() && config.pool_class_weights.size() != config.pool_block_sizes.size()) ||
+        (!config.slab_class_weights.empty() && config.slab_class_weights.size() != config.slab_object_sizes.size())) {
+        throw std::invalid_argument("HybridConfig: size class lists differ in length");
+    }
+    
+    // A 100-byte class would hand out 4-aligned blocks; 0 stays 0 and is skipped
+    for (size_t& block_size : config_.pool_block_sizes) {
+        if (block_size) block_size = alignClassSize(block_size);
+    }
+    for (size_t& object_size : config_.slab_object_sizes) {
+        if (object_size) object_size = alignClassSize(object_size);
+    }
+    
+    // No explicit classes: one geometric table shared by the pool and slab tiers.
+    // Memory is split in proportion to class size, i.e. the same object count per class.
+    if (config_.pool_block_sizes.empty() && config_.slab_object_sizes.empty()) {
+        SizeClassTable table(std::max(config_.pool_max_size, config_.slab_max_size),
+                             config_.max_internal_fragmentation);
+        config_.pool_class_weights.clear();
+        config_.slab_class_weights.clear();
+        for (size_t class_size : table.getClassSizes()) {
+            if (class_size <= config_.pool_max_size) {
+                config_.pool_block_sizes.push_back(class_size);
+                config_.pool_class_weights.push_back(static_cast<double>(class_size));
+            } else if (class_size <= config_.slab_max_size) {
+                // Roughly page-sized slabs, at least 8 objects each
+                config_.slab_object_sizes.push_back(class_size);
+                config_.slab_objects_per_slab.push_back(std::min<size_t>(std::max<size_t>(4096 / class_size, 8), 64));
+                config_.slab_class_weights.push_back(static_cast<double>(class_size));
+            }
+        }
+    }
     
     // Calculate memory distribution
     size_t pool_memory = static_cast<size_t>(total_memory * config.pool_memory_ratio);
@@ -17,8 +60,35 @@ HybridAllocator::HybridAllocator(size_t total_memory, const HybridConfig& config
         pool_memory = total_memory - buddy_memory - slab_memory;
     }
     
-    // Initialize allocators
-    buddy_allocator_ = std::make_unique<BuddyAllocator>(buddy_memory);
+    // Reserve one region for every tier; pages are only committed when touched
+    size_t buddy_size = 1;
+    while (buddy_size < buddy_memory) buddy_size <<= 1;
+    // Every tier starts on a page boundary, so allow one page of padding per tier
+    size_t tier_padding = (config_.pool_block_sizes.size() + config_.slab_object_sizes.size()) * page_size_;
+    region_size_ = os_round_to_pages(os_round_to_pages(buddy_size) + pool_memory + slab_memory + tier_padding);
+    region_ = static_cast<char*>(os_map_pages(region_size_));
+    if (!region_) {
+        throw std::bad_alloc();
+    }
+    page_count_ = region_size_ / page_size_;
+    page_map_.reset(new std::atomic<uint16_t>[page_count_]);
+    tiers_.reset(new Route[kMaxTiers]);
+    mapPages(region_, region_size_, kNoTier);
+    
+    // Borrowed chunks are buddy blocks, so they must be a power of two of whole pages
+    size_t chunk_size = page_size_;
+    while (chunk_size < config_.rebalance_chunk_size) chunk_size <<= 1;
+    config_.rebalance_chunk_size = chunk_size;
+    
+    // Initialize allocators - buddy goes first so its blocks are page aligned
+    char* buddy_region = carveRegion(buddy_size);
+    buddy_allocator_ = std::make_unique<BuddyAllocator>(buddy_size, buddy_region);
+    registerTier({AllocatorType::BUDDY, buddy_allocator_.get(), 0}, buddy_region, buddy_size);
+    
+    // Anything over half of buddy needs all of it (or more), so it is mapped as well
+    if (config_.huge_threshold > 0) {
+        huge_threshold_ = std::min(config_.huge_threshold, buddy_size / 2);
+    }
     
     // Create multiple pool allocators for different block sizes
     createPoolAllocators(pool_memory);
@@ -26,6 +96,13 @@ HybridAllocator::HybridAllocator(size_t total_memory, const HybridConfig& config
     // Create multiple slab allocators for different object sizes
     createSlabAllocators(slab_memory);
     
+    // Resolve every size class to its sub-allocators once
+    buildRoutingTable();
+    for (size_t i = 0; i < classes_.size(); ++i) {
+        classes_[i]->index = i;
+    }
+    class_counters_.setClassCount(classes_.size());
+    
     // Initialize statistics
     reset();
 }
@@ -34,68 +111,364 @@ HybridAllocator::HybridAllocator(size_t total_memory)
     : HybridAllocator(total_memory, HybridConfig{}) {
 }
 
-HybridAllocator::~HybridAllocator() = default;
+HybridAllocator::~HybridAllocator() {
+    for (const auto& mapping : mapped_allocations_) {
+        os_unmap_pages(mapping.first, mapping.second);
+    }
+    
+    // Sub-allocators must go before the region they live in (classes own the chunk ones)
+    classes_.clear();
+    pool_allocators_.clear();
+    slab_allocators_.clear();
+    buddy_allocator_.reset();
+    os_unmap_pages(region_, region_size_);
+}
+
+HybridAllocator::SizeClass::SizeClass(AllocatorType type, MemoryAllocator* primary,
+                                      size_t class_size, size_t objects_per_slab)
+    : type(type), class_size(class_size), objects_per_slab(objects_per_slab), failures_seen(0) {
+    for (size_t i = 0; i < kMaxChunksPerClass; ++i) {
+        chunks[i].store(nullptr, std::memory_order_relaxed);
+        chunk_memory[i] = nullptr;
+        chunk_bytes[i] = 0;
+        chunk_tier[i] = kNoTier;
+    }
+    chunks[0].store(primary, std::memory_order_relaxed);
+}
 
 void* HybridAllocator::allocate(size_t size) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    if (huge_threshold_ > 0 && size > huge_threshold_) {
+        LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+        void* ptr = allocateMapped(size);
+        if (config_.profiling) recordProfileAllocation(size, ptr);
+        return ptr;
+    }
     
-    void* ptr = nullptr;
-    AllocatorType used_type = selectAllocator(size);
+    return allocateFromChain(routeFor(size), size);
+}
+
+void* HybridAllocator::allocateFromChain(const std::vector<SizeClass*>& chain, size_t size) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    SizeClass& wanted = *chain.front();
+    class_counters_.recordAllocation(size, wanted.index);
     
-    switch (used_type) {
-        case AllocatorType::POOL:
-            ptr = allocateFromPool(size);
-            break;
-        case AllocatorType::SLAB:
-            ptr = allocateFromSlab(size);
-            break;
-        case AllocatorType::BUDDY:
-            ptr = buddy_allocator_->allocate(size);
-            break;
+    // Walk the fallback chain for this size class; exhausted tiers return nullptr
+    for (size_t i = 0; i < chain.size(); ++i) {
+        SizeClass& size_class = *chain[i];
+        void* ptr = allocateFromClass(size_class, size);
+        
+        // The best-fitting class ran dry: borrow a chunk for it before falling back
+        if (!ptr && i == 0 && size_class.type != AllocatorType::BUDDY) {
+            class_counters_.recordFailure(size_class.index);
+            if (growClass(size_class)) {
+                ptr = allocateFromClass(size_class, size);
+            }
+        }
+        
+        if (ptr) {
+            probe.setClass(size_class.index);
+            counters_.recordAllocation(consumedSize(size_class.class_size, ptr));
+            updateStatistics(size_class.type, size, true);
+            if (config_.profiling) recordProfileAllocation(size, ptr);
+            return ptr;
+        }
+    }
+    
+    counters_.recordFailure();
+    if (config_.profiling) recordProfileAllocation(size, nullptr);
+    return nullptr;
+}
+
+void* HybridAllocator::allocateFromClass(SizeClass& size_class, size_t size) {
+    for (size_t i = 0; i < kMaxChunksPerClass; ++i) {
+        MemoryAllocator* chunk = size_class.chunks[i].load(std::memory_order_acquire);
+        if (!chunk) continue;
+        
+        void* ptr = chunk->allocate(size);
+        if (ptr) return ptr;
+    }
+    return nullptr;
+}
+
+void* HybridAllocator::reallocate(void* ptr, size_t new_size, size_t alignment) {
+    if (!ptr) return alignment > kRouteGranularity ? allocateAligned(new_size, alignment) : allocate(new_size);
+    if (new_size == 0) {
+        deallocate(ptr);
+        return nullptr;
+    }
+    
+    size_t old_size = usableSize(ptr);
+    if (old_size == 0) {
+        return nullptr; // Not ours
+    }
+    
+    size_t old_mapped = mappedSize(ptr);
+    if (old_mapped && huge_threshold_ > 0 && new_size > huge_threshold_) {
+        // Huge to huge: let the kernel move page tables instead of copying
+        size_t new_mapped = os_round_to_pages(new_size);
+        void* moved;
+        {
+            std::lock_guard<std::mutex> lock(mapped_mutex_);
+            moved = os_remap_pages(ptr, old_mapped, new_mapped);
+            if (!moved) return nullptr;
+            mapped_allocations_.erase(ptr);
+            mapped_allocations_[moved] = new_mapped;
+        }
+        
+        counters_.recordResize(old_mapped, new_mapped);
+        tier_counters_.recordResize(0, new_size, static_cast<size_t>(AllocatorType::MAPPED));
+        if (config_.profiling) {
+            recordProfileDeallocation(ptr);
+            recordProfileAllocation(new_size, moved);
+        }
+        return moved;
+    }
+    
+    // Still fits the block it already has
+    if (!old_mapped && new_size <= old_size) {
+        return ptr;
+    }
+    
+    void* moved = alignment > kRouteGranularity ? allocateAligned(new_size, alignment) : allocate(new_size);
+    if (!moved) return nullptr;
+    std::memcpy(moved, ptr, std::min(old_size, new_size));
+    deallocate(ptr);
+    return moved;
+}
+
+size_t HybridAllocator::usableSize(void* ptr) const {
+    if (!ptr) return 0;
+    
+    const Route* route = ownerOf(ptr);
+    if (route) {
+        return consumedSize(route->class_size, ptr);
+    }
+    return mappedSize(ptr);
+}
+
+void* HybridAllocator::allocateAligned(size_t size, size_t alignment) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > page_size_) {
+        return nullptr;
+    }
+    if (alignment <= kRouteGranularity) {
+        return allocate(size);
+    }
+    
+    // Every tier starts on a page (or a buddy chunk) and slab objects follow a 16-byte
+    // header, so classes that are multiples of 16 hand out 16-aligned blocks; their
+    // chains skip the other classes, fallbacks included
+    if (alignment <= kAlignedRouteGranularity) {
+        size_t rounded = (size + kAlignedRouteGranularity - 1) & ~(kAlignedRouteGranularity - 1);
+        if (huge_threshold_ > 0 && rounded > huge_threshold_) {
+            return allocate(rounded); // Page aligned
+        }
+        size_t index = rounded / kAlignedRouteGranularity;
+        return allocateFromChain(index < aligned_routes_.size() ? aligned_routes_[index] : buddy_route_, rounded);
     }
     
-    if (ptr) {
-        allocation_map_[ptr] = used_type;
-        allocated_size_ += size;
-        allocation_count_++;
-        updateStatistics(used_type, size, true);
+    // Buddy blocks sit at multiples of their own power-of-two size from the page-aligned region
+    size_t block_size = std::max(size, alignment);
+    if (huge_threshold_ == 0 || block_size <= huge_threshold_) {
+        void* ptr = buddy_allocator_->allocate(block_size);
+        if (ptr) {
+            counters_.recordAllocation(buddy_allocator_->get_block_size(ptr));
+            updateStatistics(AllocatorType::BUDDY, size, true);
+        } else {
+            counters_.recordFailure();
+        }
+        if (config_.profiling) recordProfileAllocation(size, ptr);
+        return ptr;
+    }
+    
+    void* ptr = allocateMapped(size); // Page aligned
+    if (config_.profiling) recordProfileAllocation(size, ptr);
+    return ptr;
+}
+
+bool HybridAllocator::owns(void* ptr) const {
+    return ptr && (ownerOf(ptr) != nullptr || mappedSize(ptr) != 0);
+}
+
+void* HybridAllocator::allocateMapped(size_t size) {
+    size_t mapped = os_round_to_pages(size);
+    void* ptr = os_map_pages(mapped);
+    if (!ptr) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mapped_mutex_);
+        mapped_allocations_[ptr] = mapped;
     }
     
+    counters_.recordAllocation(mapped);
+    updateStatistics(AllocatorType::MAPPED, size, true);
     return ptr;
 }
 
+size_t HybridAllocator::mappedSize(void* ptr) const {
+    std::lock_guard<std::mutex> lock(mapped_mutex_);
+    auto it = mapped_allocations_.find(ptr);
+    return it == mapped_allocations_.end() ? 0 : it->second;
+}
+
+bool HybridAllocator::deallocateMapped(void* ptr) {
+    size_t mapped;
+    {
+        std::lock_guard<std::mutex> lock(mapped_mutex_);
+        auto it = mapped_allocations_.find(ptr);
+        if (it == mapped_allocations_.end()) return false;
+        mapped = it->second;
+        mapped_allocations_.erase(it);
+    }
+    
+    os_unmap_pages(ptr, mapped);
+    counters_.recordDeallocation(mapped);
+    updateStatistics(AllocatorType::MAPPED, 0, false);
+    return true;
+}
+
+void HybridAllocator::recordProfileAllocation(size_t size, void* ptr) {
+    // Exact below a page, power-of-two buckets beyond (those always go to buddy)
+    size_t bucket = (size + kRouteGranularity - 1) / kRouteGranularity * kRouteGranularity;
+    if (bucket > 4096) {
+        bucket = 4096;
+        while (bucket < size) bucket <<= 1;
+    }
+    
+    std::lock_guard<std::mutex> lock(profile_mutex_);
+    ProfileBucket& entry = profile_[bucket];
+    entry.requests++;
+    if (!ptr) {
+        entry.failures++;
+        return;
+    }
+    
+    entry.live++;
+    entry.peak_live = std::max(entry.peak_live, entry.live);
+    profile_live_[ptr] = {bucket, profile_clock_++};
+}
+
+void HybridAllocator::recordProfileDeallocation(void* ptr) {
+    std::lock_guard<std::mutex> lock(profile_mutex_);
+    auto it = profile_live_.find(ptr);
+    if (it == profile_live_.end()) return;
+    
+    ProfileBucket& entry = profile_[it->second.first];
+    entry.live--;
+    entry.frees++;
+    entry.lifetime_sum += profile_clock_ - it->second.second;
+    profile_live_.erase(it);
+}
+
+std::string HybridAllocator::getProfile() const {
+    std::lock_guard<std::mutex> lock(profile_mutex_);
+    
+    std::ostringstream oss;
+    oss << "# hybrid-profile v1\n";
+    oss << "# size requests failures peak_live frees lifetime_sum\n";
+    for (const auto& entry : profile_) {
+        const ProfileBucket& bucket = entry.second;
+        oss << entry.first << " " << bucket.requests << " " << bucket.failures << " "
+            << bucket.peak_live << " " << bucket.frees << " " << bucket.lifetime_sum << "\n";
+    }
+    return oss.str();
+}
+
+bool HybridAllocator::saveProfile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) return false;
+    
+    file << getProfile();
+    return static_cast<bool>(file);
+}
+
 void HybridAllocator::deallocate(void* ptr) {
     if (!ptr) return;
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    const Route* route = ownerOf(ptr);
+    if (!route) {
+        // Outside the region: a huge mapping or an unknown pointer
+        if (deallocateMapped(ptr) && config_.profiling) {
+            recordProfileDeallocation(ptr);
+        }
+        return;
+    }
+    
+    size_t consumed = releaseFromTier(*route, ptr, 0);
+    if (consumed == 0) {
+        return; // Not allocated: a double free or an interior pointer
+    }
+    
+    finishDeallocation(*route, ptr, consumed);
+    if (probe.active()) probe.setClass(classIndexOf(*route));
+}
+
+void HybridAllocator::deallocate(void* ptr, size_t size) {
+    if (!ptr) return;
+    
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
     
-    auto it = allocation_map_.find(ptr);
-    if (it == allocation_map_.end()) {
-        return; // Unknown pointer
+    // Huge sizes never live in the region
+    if (huge_threshold_ > 0 && size > huge_threshold_) {
+        bool mapped = deallocateMapped(ptr);
+        assert(mapped && "HybridAllocator: deallocate size does not match the allocation");
+        if (mapped && config_.profiling) recordProfileDeallocation(ptr);
+        return;
     }
     
-    AllocatorType type = it->second;
-    allocation_map_.erase(it);
+    // The page map still decides the tier: a fallback chain may have served another class
+    const Route* route = ownerOf(ptr);
+    if (!route) {
+        deallocate(ptr); // allocateAligned() may map sizes below the threshold
+        return;
+    }
     
-    switch (type) {
-        case AllocatorType::POOL:
-            deallocateFromPool(ptr);
-            break;
+    // Bytes come from the block actually freed, so a wrong size (or an allocateAligned()
+    // buddy block larger than size implies) cannot skew the counters
+    size_t consumed = releaseFromTier(*route, ptr, size);
+    assert(size <= consumed && "HybridAllocator: deallocate size does not match the allocation");
+    if (consumed == 0) {
+        return;
+    }
+    finishDeallocation(*route, ptr, consumed);
+    if (probe.active()) probe.setClass(classIndexOf(*route));
+}
+
+size_t HybridAllocator::releaseFromTier(const Route& route, void* ptr, size_t size) {
+    // The tiers report whether they freed a block, so a bad pointer leaves the counters alone
+    switch (route.type) {
+        case AllocatorType::POOL: {
+            PoolAllocator* pool = static_cast<PoolAllocator*>(route.allocator);
+            return (size ? pool->release(ptr, size) : pool->release(ptr)) ? route.class_size : 0;
+        }
         case AllocatorType::SLAB:
-            deallocateFromSlab(ptr);
-            break;
-        case AllocatorType::BUDDY:
-            buddy_allocator_->deallocate(ptr);
-            break;
+            return static_cast<SlabAllocator*>(route.allocator)->release(ptr) ? route.class_size : 0;
+        default:
+            return size ? buddy_allocator_->release(ptr, size) : buddy_allocator_->release(ptr);
     }
+}
+
+size_t HybridAllocator::classIndexOf(const Route& route) const {
+    // Every pool or slab tier serves exactly one class size, the best fit for that size
+    return (route.class_size ? routeFor(route.class_size) : buddy_route_).front()->index;
+}
+
+void HybridAllocator::finishDeallocation(const Route& route, void* ptr, size_t consumed) {
+    if (config_.profiling) recordProfileDeallocation(ptr);
     
-    deallocation_count_++;
-    updateStatistics(type, 0, false);
+    // Buddy has room again, let exhausted classes retry growing
+    if (route.type == AllocatorType::BUDDY && buddy_exhausted_.load(std::memory_order_relaxed)) {
+        buddy_exhausted_.store(false, std::memory_order_relaxed);
+    }
+    
+    counters_.recordDeallocation(consumed);
+    updateStatistics(route.type, 0, false);
 }
 
 size_t HybridAllocator::getFragmentation() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     size_t total_memory = 0;
     size_t fragmented_memory = 0;
     
@@ -121,20 +494,60 @@ size_t HybridAllocator::getFragmentation() const {
         fragmented_memory += (slab_frag * slab_total) / 100;
     }
     
+    // Borrowed chunks are already counted as allocated in buddy; add their own slack
+    for (const auto& size_class : classes_) {
+        for (size_t i = 1; i < kMaxChunksPerClass; ++i) {
+            MemoryAllocator* chunk = size_class->chunks[i].load(std::memory_order_acquire);
+            if (chunk) {
+                fragmented_memory += (chunk->getFragmentation() * chunk->getTotalMemory()) / 100;
+            }
+        }
+    }
+    
     return total_memory > 0 ? (fragmented_memory * 100) / total_memory : 0;
 }
 
 std::string HybridAllocator::getStats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    StatsCounters::ClassSnapshot pool = tier_counters_.classSnapshot(static_cast<size_t>(AllocatorType::POOL));
+    StatsCounters::ClassSnapshot slab = tier_counters_.classSnapshot(static_cast<size_t>(AllocatorType::SLAB));
+    StatsCounters::ClassSnapshot buddy = tier_counters_.classSnapshot(static_cast<size_t>(AllocatorType::BUDDY));
+    StatsCounters::ClassSnapshot huge = tier_counters_.classSnapshot(static_cast<size_t>(AllocatorType::MAPPED));
     
     std::string stats = MemoryAllocator::getStats();
     stats += "Hybrid Allocator Stats:\n";
-    stats += "  Pool Allocations: " + std::to_string(pool_stats_.allocations) + "\n";
-    stats += "  Slab Allocations: " + std::to_string(slab_stats_.allocations) + "\n";
-    stats += "  Buddy Allocations: " + std::to_string(buddy_stats_.allocations) + "\n";
-    stats += "  Pool Memory: " + std::to_string(pool_stats_.total_allocated) + " bytes\n";
-    stats += "  Slab Memory: " + std::to_string(slab_stats_.total_allocated) + " bytes\n";
-    stats += "  Buddy Memory: " + std::to_string(buddy_stats_.total_allocated) + " bytes\n";
+    stats += "  Pool Allocations: " + std::to_string(pool.allocations) + "\n";
+    stats += "  Slab Allocations: " + std::to_string(slab.allocations) + "\n";
+    stats += "  Buddy Allocations: " + std::to_string(buddy.allocations) + "\n";
+    stats += "  Pool Memory: " + std::to_string(pool.bytes_allocated) + " bytes\n";
+    stats += "  Slab Memory: " + std::to_string(slab.bytes_allocated) + " bytes\n";
+    stats += "  Buddy Memory: " + std::to_string(buddy.bytes_allocated) + " bytes\n";
+    stats += "  Huge Allocations: " + std::to_string(huge.allocations) + "\n";
+    stats += "  Huge Memory: " + std::to_string(huge.bytes_allocated) + " bytes\n";
+    {
+        std::lock_guard<std::mutex> lock(mapped_mutex_);
+        size_t live_mapped = 0;
+        for (const auto& mapping : mapped_allocations_) live_mapped += mapping.second;
+        stats += "  Huge Mapped Now: " + std::to_string(mapped_allocations_.size()) + " mappings, " +
+                 std::to_string(live_mapped) + " bytes\n";
+    }
+    
+    // Demand histogram per class and how many chunks each currently holds
+    stats += "  Size Classes:\n";
+    for (const auto& size_class : classes_) {
+        if (size_class->type == AllocatorType::BUDDY) continue;
+        
+        size_t chunk_count = 0;
+        for (size_t i = 0; i < kMaxChunksPerClass; ++i) {
+            if (size_class->chunks[i].load(std::memory_order_acquire)) chunk_count++;
+        }
+        StatsCounters::ClassSnapshot demand = class_counters_.classSnapshot(size_class->index);
+        stats += std::string("    ") + (size_class->type == AllocatorType::POOL ? "Pool " : "Slab ") +
+                 std::to_string(size_class->class_size) + " bytes: " +
+                 std::to_string(demand.allocations) + " requests, " +
+                 std::to_string(demand.failures) + " failures, " +
+                 std::to_string(chunk_count) + " chunks\n";
+        appendLatencyLine(stats, "      allocate:", latency_.summary(LatencyRecorder::Op::ALLOCATE, size_class->index));
+    }
     
     // Add individual allocator stats
     stats += "\nBuddy Allocator:\n" + buddy_allocator_->getStats() + "\n";
@@ -152,145 +565,326 @@ std::string HybridAllocator::getStats() const {
     return stats;
 }
 
-HybridAllocator::AllocatorType HybridAllocator::selectAllocator(size_t size) {
-    // Use pool allocator for small, fixed-size allocations
-    if (size <= config_.pool_max_size) {
-        for (const auto& pool : pool_allocators_) {
-            if (pool->canAllocate(size)) {
-                return AllocatorType::POOL;
+const HybridAllocator::Route* HybridAllocator::ownerOf(void* ptr) const {
+    char* address = static_cast<char*>(ptr);
+    if (address < region_ || address >= region_ + region_used_) {
+        return nullptr;
+    }
+    
+    size_t page = static_cast<size_t>(address - region_) / page_size_;
+    uint16_t tier = page_map_[page].load(std::memory_order_acquire);
+    return tier == kNoTier ? nullptr : &tiers_[tier];
+}
+
+size_t HybridAllocator::consumedSize(size_t class_size, void* ptr) const {
+    if (class_size) {
+        return class_size;
+    }
+    return buddy_allocator_->get_block_size(ptr);
+}
+
+char* HybridAllocator::carveRegion(size_t size) {
+    size = os_round_to_pages(size);
+    if (region_used_ + size > region_size_) {
+        throw std::bad_alloc();
+    }
+    
+    char* start = region_ + region_used_;
+    region_used_ += size;
+    return start;
+}
+
+uint16_t HybridAllocator::registerTier(const Route& route, void* start, size_t size) {
+    if (tier_count_ == kMaxTiers) {
+        throw std::length_error("HybridAllocator: too many tiers");
+    }
+    
+    uint16_t tier = static_cast<uint16_t>(tier_count_++);
+    tiers_[tier] = route;
+    mapPages(start, size, tier);
+    return tier;
+}
+
+void HybridAllocator::mapPages(void* start, size_t size, uint16_t tier) {
+    size_t first_page = static_cast<size_t>(static_cast<char*>(start) - region_) / page_size_;
+    size_t last_page = first_page + os_round_to_pages(size) / page_size_;
+    for (size_t page = first_page; page < last_page; ++page) {
+        page_map_[page].store(tier, std::memory_order_release);
+    }
+}
+
+const std::vector<HybridAllocator::SizeClass*>& HybridAllocator::routeFor(size_t size) const {
+    size_t index = (size + kRouteGranularity - 1) / kRouteGranularity;
+    return index < routes_.size() ? routes_[index] : buddy_route_;
+}
+
+void HybridAllocator::buildRoutingTable() {
+    // Classes were created smallest first per tier, which is the order they are tried in
+    std::vector<SizeClass*> pool_classes;
+    std::vector<SizeClass*> slab_classes;
+    for (auto& size_class : classes_) {
+        (size_class->type == AllocatorType::POOL ? pool_classes : slab_classes).push_back(size_class.get());
+    }
+    classes_.push_back(std::make_unique<SizeClass>(AllocatorType::BUDDY, buddy_allocator_.get(), 0, 0));
+    buddy_route_ = {classes_.back().get()};
+    
+    size_t max_routed = std::max(config_.pool_max_size, config_.slab_max_size);
+    routes_.assign(max_routed / kRouteGranularity + 1, {});
+    
+    for (size_t index = 0; index < routes_.size(); ++index) {
+        size_t size = index * kRouteGranularity;
+        std::vector<SizeClass*>& chain = routes_[index];
+        
+        // Smallest fitting pool first, then slabs. Fallbacks stay within one doubling
+        // of the best fit: past that buddy wastes no more than a larger class would.
+        size_t limit = 0;
+        if (size <= config_.pool_max_size) {
+            for (SizeClass* size_class : pool_classes) {
+                if (size_class->class_size < size) continue;
+                if (limit == 0) limit = size_class->class_size * 2;
+                if (size_class->class_size <= limit) chain.push_back(size_class);
+            }
+        }
+        if (size <= config_.slab_max_size) {
+            for (SizeClass* size_class : slab_classes) {
+                if (size_class->class_size < size) continue;
+                if (limit == 0) limit = size_class->class_size * 2;
+                if (size_class->class_size <= limit) chain.push_back(size_class);
             }
         }
+        
+        // Buddy is the last resort for every class
+        chain.push_back(buddy_route_.front());
     }
     
-    // Use slab allocator for medium-sized, frequent allocations
-    if (size <= config_.slab_max_size) {
-        for (const auto& slab : slab_allocators_) {
-            if (size <= slab->getObjectSize()) {
-                return AllocatorType::SLAB;
+    // The same chains without the classes that are not multiples of 16 (buddy stays)
+    aligned_routes_.assign(max_routed / kAlignedRouteGranularity + 1, {});
+    for (size_t index = 0; index < aligned_routes_.size(); ++index) {
+        for (SizeClass* size_class : routes_[index * kAlignedRouteGranularity / kRouteGranularity]) {
+            if (size_class->class_size % kAlignedRouteGranularity == 0) {
+                aligned_routes_[index].push_back(size_class);
             }
         }
     }
-    
-    // Use buddy allocator for large or variable-size allocations
-    return AllocatorType::BUDDY;
 }
 
-void* HybridAllocator::allocateFromPool(size_t size) {
-    // Try to find suitable pool allocator
-    for (auto& pool : pool_allocators_) {
-        if (pool->canAllocate(size)) {
-            return pool->allocate(size);
-        }
+bool HybridAllocator::growClass(SizeClass& size_class) {
+    if (!config_.adaptive_rebalancing || buddy_exhausted_.load(std::memory_order_relaxed)) {
+        return false;
     }
-    return nullptr;
+    
+    // Someone else is already moving chunks; fall back instead of waiting
+    std::unique_lock<std::mutex> lock(rebalance_mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    return growClassLocked(size_class);
 }
 
-void* HybridAllocator::allocateFromSlab(size_t size) {
-    // Find smallest suitable slab allocator
-    SlabAllocator* best_slab = nullptr;
-    size_t best_size = SIZE_MAX;
+bool HybridAllocator::growClassLocked(SizeClass& size_class) {
+    size_t slot = 1;
+    while (slot < kMaxChunksPerClass && size_class.chunks[slot].load(std::memory_order_relaxed)) {
+        ++slot;
+    }
+    if (slot == kMaxChunksPerClass) {
+        return false; // Class already holds as many chunks as it may
+    }
+    if (size_class.chunk_tier[slot] == kNoTier && tier_count_ == kMaxTiers) {
+        return false;
+    }
     
-    for (auto& slab : slab_allocators_) {
-        size_t obj_size = slab->getObjectSize();
-        if (obj_size >= size && obj_size < best_size) {
-            best_slab = slab.get();
-            best_size = obj_size;
-        }
+    // Each further chunk of a class is twice the previous one, so a hot class reaches
+    // its working set in a few steps; settle for less when buddy has no such block
+    size_t chunk_size = config_.rebalance_chunk_size << (slot - 1);
+    void* memory = buddy_allocator_->allocate(chunk_size);
+    while (!memory && chunk_size > config_.rebalance_chunk_size) {
+        chunk_size >>= 1;
+        memory = buddy_allocator_->allocate(chunk_size);
+    }
+    if (!memory && reclaimIdleChunks() > 0) {
+        memory = buddy_allocator_->allocate(chunk_size);
+    }
+    if (!memory) {
+        buddy_exhausted_.store(true, std::memory_order_relaxed);
+        return false;
     }
     
-    if (best_slab) {
-        return best_slab->allocate(size);
+    PoolAllocator::PoolConfig config;
+    config.block_sizes = {size_class.class_size};
+    config.blocks_per_pool = {chunk_size / size_class.class_size};
+    config.total_memory = chunk_size;
+    config.memory = memory;
+    
+    // Publish the owner of every page before any block from the chunk can be handed out
+    std::unique_ptr<MemoryAllocator>& chunk = size_class.chunk_owner[slot];
+    if (!chunk) {
+        if (size_class.type == AllocatorType::POOL) {
+            chunk = std::make_unique<PoolAllocator>(config);
+        } else {
+            chunk = std::make_unique<SlabAllocator>(size_class.class_size, size_class.objects_per_slab,
+                                                    chunk_size, memory);
+        }
+        size_class.chunk_tier[slot] = registerTier({size_class.type, chunk.get(), size_class.class_size},
+                                                   memory, chunk_size);
+    } else {
+        // The slot's retired allocator moves to the new chunk; its tier still names it
+        mapPages(memory, chunk_size, size_class.chunk_tier[slot]);
+        if (size_class.type == AllocatorType::POOL) {
+            static_cast<PoolAllocator*>(chunk.get())->reinitialize(config);
+        } else {
+            static_cast<SlabAllocator*>(chunk.get())->reinitialize(memory, chunk_size);
+        }
     }
-    return nullptr;
+    
+    size_class.chunk_memory[slot] = memory;
+    size_class.chunk_bytes[slot] = chunk_size;
+    size_class.chunks[slot].store(chunk.get(), std::memory_order_release);
+    return true;
 }
 
-void HybridAllocator::deallocateFromPool(void* ptr) {
-    for (auto& pool : pool_allocators_) {
-        if (pool->isValidPointer(ptr)) {
-            pool->deallocate(ptr);
-            return;
+size_t HybridAllocator::reclaimIdleChunks() {
+    // Buddy owns the pages again once a chunk is returned
+    size_t reclaimed = 0;
+    for (auto& size_class : classes_) {
+        for (size_t i = 1; i < kMaxChunksPerClass; ++i) {
+            MemoryAllocator* chunk = size_class->chunks[i].load(std::memory_order_relaxed);
+            if (!chunk) continue;
+            
+            // retire() fails while anything is live and makes racing allocates fail after
+            bool idle = size_class->type == AllocatorType::POOL
+                            ? static_cast<PoolAllocator*>(chunk)->retire()
+                            : static_cast<SlabAllocator*>(chunk)->retire();
+            if (!idle) continue;
+            
+            size_class->chunks[i].store(nullptr, std::memory_order_release);
+            mapPages(size_class->chunk_memory[i], size_class->chunk_bytes[i], kBuddyTier);
+            buddy_allocator_->deallocate(size_class->chunk_memory[i]);
+            size_class->chunk_memory[i] = nullptr;
+            reclaimed++;
+            
+            // Demand for this class dropped, earlier failures no longer call for growth
+            size_class->failures_seen = class_counters_.classSnapshot(size_class->index).failures;
         }
     }
+    
+    if (reclaimed > 0) {
+        buddy_exhausted_.store(false, std::memory_order_relaxed);
+    }
+    return reclaimed;
 }
 
-void HybridAllocator::deallocateFromSlab(void* ptr) {
-    for (auto& slab : slab_allocators_) {
-        // Try to deallocate from each slab (they will check if pointer belongs to them)
-        size_t old_count = slab->getDeallocationCount();
-        slab->deallocate(ptr);
-        if (slab->getDeallocationCount() > old_count) {
-            return; // Successfully deallocated
+size_t HybridAllocator::rebalance() {
+    std::lock_guard<std::mutex> lock(rebalance_mutex_);
+    
+    // Give idle chunks back first so classes that failed since last time can use them
+    size_t moved = reclaimIdleChunks();
+    if (!config_.adaptive_rebalancing) {
+        return moved;
+    }
+    
+    for (auto& size_class : classes_) {
+        if (size_class->type == AllocatorType::BUDDY) continue;
+        
+        size_t failures = class_counters_.classSnapshot(size_class->index).failures;
+        if (failures > size_class->failures_seen && growClassLocked(*size_class)) {
+            moved++;
         }
+        size_class->failures_seen = failures;
     }
+    
+    return moved;
 }
 
 void HybridAllocator::createPoolAllocators(size_t total_memory) {
-    // Create pool allocators for common small sizes
-    std::vector<size_t> pool_sizes = {8, 16, 32, 64, 128, 256};
-    size_t memory_per_pool = total_memory / pool_sizes.size();
+    // One pool per configured block size, smallest first (routing relies on the order)
+    std::vector<std::pair<size_t, double>> pool_classes;
+    for (size_t i = 0; i < config_.pool_block_sizes.size(); ++i) {
+        double weight = config_.pool_class_weights.empty() ? 1.0 : config_.pool_class_weights[i];
+        pool_classes.push_back({config_.pool_block_sizes[i], weight});
+    }
+    std::sort(pool_classes.begin(), pool_classes.end());
+    
+    double total_weight = 0.0;
+    for (const auto& pool_class : pool_classes) total_weight += pool_class.second;
     
-    for (size_t block_size : pool_sizes) {
+    for (const auto& pool_class : pool_classes) {
+        size_t block_size = pool_class.first;
+        if (block_size == 0 || total_weight <= 0.0) continue;
+        
+        size_t memory_per_pool = static_cast<size_t>(total_memory * pool_class.second / total_weight);
         size_t num_blocks = memory_per_pool / block_size;
+        PoolAllocator* primary = nullptr;
         if (num_blocks > 0) {
             PoolAllocator::PoolConfig config;
             config.block_sizes = {block_size};
             config.blocks_per_pool = {num_blocks};
             config.total_memory = memory_per_pool;
+            config.memory = carveRegion(block_size * num_blocks);
             
             auto pool = std::make_unique<PoolAllocator>(config);
+            registerTier({AllocatorType::POOL, pool.get(), block_size}, config.memory, block_size * num_blocks);
+            primary = pool.get();
             pool_allocators_.push_back(std::move(pool));
         }
+        
+        // A class without a share of its own can still be grown from buddy
+        if (primary || config_.adaptive_rebalancing) {
+            classes_.push_back(std::make_unique<SizeClass>(AllocatorType::POOL, primary, block_size, 0));
+        }
     }
 }
 
 void HybridAllocator::createSlabAllocators(size_t total_memory) {
-    // Create slab allocators for common object sizes
-    std::vector<std::pair<size_t, size_t>> slab_configs = {
-        {64, 32},   // 64-byte objects, 32 per slab
-        {128, 24},  // 128-byte objects, 24 per slab
-        {256, 16},  // 256-byte objects, 16 per slab
-        {512, 8}    // 512-byte objects, 8 per slab
+    // (object size, objects per slab, weight), smallest object size first
+    struct SlabClass {
+        size_t object_size;
+        size_t objects_per_slab;
+        double weight;
     };
+    std::vector<SlabClass> slab_configs;
+    for (size_t i = 0; i < config_.slab_object_sizes.size(); ++i) {
+        double weight = config_.slab_class_weights.empty() ? 1.0 : config_.slab_class_weights[i];
+        slab_configs.push_back({config_.slab_object_sizes[i], config_.slab_objects_per_slab[i], weight});
+    }
+    std::sort(slab_configs.begin(), slab_configs.end(),
+              [](const SlabClass& a, const SlabClass& b) { return a.object_size < b.object_size; });
     
-    size_t memory_per_slab = total_memory / slab_configs.size();
+    double total_weight = 0.0;
+    for (const auto& config : slab_configs) total_weight += config.weight;
     
     for (const auto& config : slab_configs) {
-        size_t object_size = config.first;
-        size_t objects_per_slab = config.second;
+        size_t object_size = config.object_size;
+        size_t objects_per_slab = config.objects_per_slab;
+        if (object_size == 0 || objects_per_slab == 0 || total_weight <= 0.0) continue;
         
-        auto slab = std::make_unique<SlabAllocator>(object_size, objects_per_slab, memory_per_slab);
-        slab_allocators_.push_back(std::move(slab));
+        size_t memory_per_slab = static_cast<size_t>(total_memory * config.weight / total_weight);
+        
+        // Object sizes whose slab does not fit in the share start without memory
+        SlabAllocator* primary = nullptr;
+        if (SlabAllocator::getSlabSize(object_size, objects_per_slab) <= memory_per_slab) {
+            char* memory = carveRegion(memory_per_slab);
+            auto slab = std::make_unique<SlabAllocator>(object_size, objects_per_slab, memory_per_slab, memory);
+            registerTier({AllocatorType::SLAB, slab.get(), object_size}, memory, memory_per_slab);
+            primary = slab.get();
+            slab_allocators_.push_back(std::move(slab));
+        }
+        
+        if (primary || config_.adaptive_rebalancing) {
+            classes_.push_back(std::make_unique<SizeClass>(AllocatorType::SLAB, primary, object_size, objects_per_slab));
+        }
     }
 }
 
 void HybridAllocator::updateStatistics(AllocatorType type, size_t size, bool allocation) {
-    AllocatorStats* stats = nullptr;
-    
-    switch (type) {
-        case AllocatorType::POOL:
-            stats = &pool_stats_;
-            break;
-        case AllocatorType::SLAB:
-            stats = &slab_stats_;
-            break;
-        case AllocatorType::BUDDY:
-            stats = &buddy_stats_;
-            break;
-    }
-    
-    if (stats) {
-        if (allocation) {
-            stats->allocations++;
-            stats->total_allocated += size;
-        } else {
-            stats->deallocations++;
-        }
+    // Tier memory is the bytes requested, so frees only count
+    if (allocation) {
+        tier_counters_.recordAllocation(size, static_cast<size_t>(type));
+    } else {
+        tier_counters_.recordDeallocation(0, static_cast<size_t>(type));
     }
 }
 
 std::vector<MemoryAllocator::MemoryBlock> HybridAllocator::getMemoryLayout() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     std::vector<MemoryBlock> layout;
     size_t offset = 0;
     
@@ -329,36 +923,186 @@ std::vector<MemoryAllocator::MemoryBlock> HybridAllocator::getMemoryLayout() con
 }
 
 void HybridAllocator::reset() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     // Reset base class statistics
-    allocated_size_ = 0;
-    allocation_count_ = 0;
-    deallocation_count_ = 0;
-    
-    // Clear allocation map
-    allocation_map_.clear();
+    counters_.reset();
     
     // Reset allocator-specific statistics
-    pool_stats_ = {};
-    slab_stats_ = {};
-    buddy_stats_ = {};
+    tier_counters_.reset();
+    class_counters_.reset();
+    latency_.reset();
+    
+    {
+        std::lock_guard<std::mutex> lock(mapped_mutex_);
+        for (const auto& mapping : mapped_allocations_) {
+            os_unmap_pages(mapping.first, mapping.second);
+        }
+        mapped_allocations_.clear();
+    }
+    
+    // Borrowed chunks are freed by the buddy reset below; their pages go back to buddy.
+    // The slots' allocators stay unpublished until a grow re-initialises them.
+    std::lock_guard<std::mutex> lock(rebalance_mutex_);
+    for (auto& size_class : classes_) {
+        for (size_t i = 1; i < kMaxChunksPerClass; ++i) {
+            if (size_class->chunks[i].load(std::memory_order_relaxed)) {
+                size_class->chunks[i].store(nullptr, std::memory_order_relaxed);
+                mapPages(size_class->chunk_memory[i], size_class->chunk_bytes[i], kBuddyTier);
+                size_class->chunk_memory[i] = nullptr;
+            }
+        }
+        size_class->failures_seen = 0;
+    }
+    buddy_exhausted_ = false;
     
     // Reset individual allocators
     buddy_allocator_->reset();
     for (auto& pool : pool_allocators_) {
         pool->reset();
     }
-    // Note: Slab allocators don't have reset method in our interface
+    for (auto& slab : slab_allocators_) {
+        slab->reset();
+    }
 }
 
-double HybridAllocator::getEfficiencyScore() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+MemoryAllocator::LockStats HybridAllocator::getLockStats() const {
+    LockStats total;
+    auto add = [&total](const MemoryAllocator& tier) {
+        LockStats stats = tier.getLockStats();
+        total.acquisitions += stats.acquisitions;
+        total.contended += stats.contended;
+    };
     
+    add(*buddy_allocator_);
+    for (const auto& pool : pool_allocators_) add(*pool);
+    for (const auto& slab : slab_allocators_) add(*slab);
+    
+    std::lock_guard<std::mutex> lock(rebalance_mutex_); // Chunks are added under it
+    for (const auto& size_class : classes_) {
+        for (const auto& chunk : size_class->chunk_owner) {
+            if (chunk) add(*chunk);
+        }
+    }
+    return total;
+}
+
+double HybridAllocator::getEfficiencyScore() const {
     // Calculate efficiency based on fragmentation and utilization
     double fragmentation = static_cast<double>(getFragmentation()) / 100.0;
-    double utilization = static_cast<double>(allocated_size_) / static_cast<double>(total_memory_);
+    double utilization = static_cast<double>(getAllocatedSize()) / static_cast<double>(total_memory_);
     
     // Efficiency score: high utilization, low fragmentation
     return utilization * (1.0 - fragmentation);
 }
+
+namespace {
+
+std::string trimmed(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) return "";
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+template <typename T, typename Parse>
+std::vector<T> parseList(const std::string& value, Parse parse) {
+    std::vector<T> list;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = trimmed(item);
+        if (!item.empty()) list.push_back(parse(item));
+    }
+    return list;
+}
+
+bool parseBool(const std::string& value) {
+    if (value == "1" || value == "true") return true;
+    if (value == "0" || value == "false") return false;
+    throw std::invalid_argument("HybridConfig: expected a boolean, got '" + value + "'");
+}
+
+template <typename T>
+std::string joinList(const std::vector<T>& list) {
+    std::ostringstream oss;
+    for (size_t i = 0; i < list.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << list[i];
+    }
+    return oss.str();
+}
+
+} // namespace
+
+HybridAllocator::HybridConfig HybridAllocator::HybridConfig::fromString(const std::string& text) {
+    HybridConfig config;
+    auto to_size = [](const std::string& value) { return static_cast<size_t>(std::stoull(value)); };
+    auto to_double = [](const std::string& value) { return std::stod(value); };
+    
+    std::stringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        line = line.substr(0, line.find('#'));
+        
+        std::stringstream entries(line);
+        std::string entry;
+        while (std::getline(entries, entry, ';')) {
+            entry = trimmed(entry);
+            if (entry.empty()) continue;
+            
+            size_t equals = entry.find('=');
+            if (equals == std::string::npos) {
+                throw std::invalid_argument("HybridConfig: expected key=value, got '" + entry + "'");
+            }
+            std::string key = trimmed(entry.substr(0, equals));
+            std::string value = trimmed(entry.substr(equals + 1));
+            
+            if (key == "pool_memory_ratio") config.pool_memory_ratio = to_double(value);
+            else if (key == "slab_memory_ratio") config.slab_memory_ratio = to_double(value);
+            else if (key == "pool_max_size") config.pool_max_size = to_size(value);
+            else if (key == "slab_max_size") config.slab_max_size = to_size(value);
+            else if (key == "adaptive_rebalancing") config.adaptive_rebalancing = parseBool(value);
+            else if (key == "rebalance_chunk_size") config.rebalance_chunk_size = to_size(value);
+            else if (key == "pool_block_sizes") config.pool_block_sizes = parseList<size_t>(value, to_size);
+            else if (key == "pool_class_weights") config.pool_class_weights = parseList<double>(value, to_double);
+            else if (key == "slab_object_sizes") config.slab_object_sizes = parseList<size_t>(value, to_size);
+            else if (key == "slab_objects_per_slab") config.slab_objects_per_slab = parseList<size_t>(value, to_size);
+            else if (key == "slab_class_weights") config.slab_class_weights = parseList<double>(value, to_double);
+            else if (key == "max_internal_fragmentation") config.max_internal_fragmentation = to_double(value);
+            else if (key == "huge_threshold") config.huge_threshold = to_size(value);
+            else if (key == "profiling") config.profiling = parseBool(value);
+            else throw std::invalid_argument("HybridConfig: unknown key '" + key + "'");
+        }
+    }
+    
+    return config;
+}
+
+HybridAllocator::HybridConfig HybridAllocator::HybridConfig::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("HybridConfig: cannot open " + path);
+    }
+    
+    std::stringstream contents;
+    contents << file.rdbuf();
+    return fromString(contents.str());
+}
+
+std::string HybridAllocator::HybridConfig::toString() const {
+    std::ostringstream oss;
+    oss << "pool_memory_ratio=" << pool_memory_ratio << ";";
+    oss << "slab_memory_ratio=" << slab_memory_ratio << ";";
+    oss << "pool_max_size=" << pool_max_size << ";";
+    oss << "slab_max_size=" << slab_max_size << ";";
+    oss << "pool_block_sizes=" << joinList(pool_block_sizes) << ";";
+    if (!pool_class_weights.empty()) oss << "pool_class_weights=" << joinList(pool_class_weights) << ";";
+    oss << "slab_object_sizes=" << joinList(slab_object_sizes) << ";";
+    oss << "slab_objects_per_slab=" << joinList(slab_objects_per_slab) << ";";
+    if (!slab_class_weights.empty()) oss << "slab_class_weights=" << joinList(slab_class_weights) << ";";
+    oss << "max_internal_fragmentation=" << max_internal_fragmentation << ";";
+    oss << "adaptive_rebalancing=" << (adaptive_rebalancing ? 1 : 0) << ";";
+    oss << "rebalance_chunk_size=" << rebalance_chunk_size << ";";
+    oss << "huge_threshold=" << huge_threshold << ";";
+    oss << "profiling=" << (profiling ? 1 : 0);
+    return oss.str();
+}
@@ -0,0 +1,191 @@
+#include "../includes/latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace cycle_clock {
+
+double nanosecondsPerTick() {
+    static const double ratio = []() {
+        auto start_time = std::chrono::steady_clock::now();
+        uint64_t start_ticks = now();
+        auto end_time = start_time;
+        while (end_time - start_time < std::chrono::milliseconds(10)) {
+            end_time = std::chrono::steady_clock::now();
+        }
+        uint64_t ticks = now() - start_ticks;
+        double elapsed_ns = std::chrono::duration<double, std::nano>(end_time - start_time).count();
+        return ticks > 0 ? elapsed_ns / static_cast<double>(ticks) : 1.0;
+    }();
+    return ratio;
+}
+
+} // namespace cycle_clock
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+size_t LatencyHistogram::bucketFor(uint64_t ticks) {
+    if (ticks < kSubBuckets) {
+        return static_cast<size_t>(ticks);
+    }
+    unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(ticks));
+    if (exponent > kMaxExponent) {
+        return kBuckets - 1;
+    }
+    size_t sub_bucket = static_cast<size_t>(ticks >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + sub_bucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+    unsigned shift = static_cast<unsigned>(bucket / kSubBuckets) - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + bucket % kSubBuckets) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ticks) {
+    buckets_[bucketFor(ticks)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ticks, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (ticks > max && !max_.compare_exchange_weak(max, ticks, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        uint64_t samples = other.buckets_[bucket].load(std::memory_order_relaxed);
+        if (samples) buckets_[bucket].fetch_add(samples, std::memory_order_relaxed);
+    }
+    count_.fetch_add(other.getCount(), std::memory_order_relaxed);
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+    uint64_t other_max = other.getMax();
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (other_max > max && !max_.compare_exchange_weak(max, other_max, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double q) const {
+    uint64_t count = getCount();
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += buckets_[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(bucket), getMax());
+        }
+    }
+    return getMax(); // Records landed between the count and bucket reads
+}
+
+LatencyHistogram::Summary LatencyHistogram::summary() const {
+    Summary result;
+    result.count = getCount();
+    if (result.count == 0) return result;
+
+    double ns_per_tick = cycle_clock::nanosecondsPerTick();
+    result.mean_ns = static_cast<double>(sum_.load(std::memory_order_relaxed)) / result.count * ns_per_tick;
+    result.p50_ns = percentile(0.50) * ns_per_tick;
+    result.p99_ns = percentile(0.99) * ns_per_tick;
+    result.p999_ns = percentile(0.999) * ns_per_tick;
+    result.max_ns = getMax() * ns_per_tick;
+    return result;
+}
+
+LatencyRecorder::~LatencyRecorder() {
+    delete histograms_.load(std::memory_order_acquire);
+}
+
+void LatencyRecorder::enable(uint32_t sample_every, size_t class_count) {
+    if (!histograms_.load(std::memory_order_acquire)) {
+        Histograms* created = new Histograms;
+        created->class_count = class_count;
+        created->per_op[0].reset(new LatencyHistogram[class_count + 1]);
+        created->per_op[1].reset(new LatencyHistogram[class_count + 1]);
+
+        Histograms* expected = nullptr;
+        if (!histograms_.compare_exchange_strong(expected, created, std::memory_order_acq_rel)) {
+            delete created; // Another thread enabled it first
+        }
+    }
+    // Recorders only sample once they can see the histograms
+    sample_every_.store(std::max<uint32_t>(sample_every, 1), std::memory_order_release);
+}
+
+void LatencyRecorder::reset() {
+    Histograms* histograms = histograms_.load(std::memory_order_acquire);
+    if (!histograms) return;
+
+    for (auto& op : histograms->per_op) {
+        for (size_t i = 0; i <= histograms->class_count; ++i) {
+            op[i].reset();
+        }
+    }
+}
+
+bool LatencyRecorder::tick(Op op, uint32_t every) {
+    // Shared by every recorder on the thread; a lowered rate takes effect at once
+    thread_local uint64_t countdown[2] = {0, 0};
+    thread_local uint32_t random_state = 0x9E3779B9u;
+    
+    uint64_t& left = countdown[op == Op::ALLOCATE ? 0 : 1];
+    uint64_t longest = 2 * static_cast<uint64_t>(every) - 1;
+    if (--left > 0 && left <= longest) {
+        return false;
+    }
+    
+    // Next interval uniform in [1, 2 * every - 1], so the mean stays every
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    left = 1 + random_state % longest;
+    return true;
+}
+
+void LatencyRecorder::record(Op op, size_t size_class, uint64_t ticks) {
+    Histograms* histograms = histograms_.load(std::memory_order_acquire);
+    if (!histograms) return;
+
+    LatencyHistogram* per_op = histograms->per_op[op == Op::ALLOCATE ? 0 : 1].get();
+    per_op[0].record(ticks);
+    if (size_class < histograms->class_count) {
+        per_op[1 + size_class].record(ticks);
+    }
+}
+
+const LatencyHistogram* LatencyRecorder::histogram(Op op, size_t size_class) const {
+    Histograms* histograms = histograms_.load(std::memory_order_acquire);
+    if (!histograms) return nullptr;
+
+    const LatencyHistogram* per_op = histograms->per_op[op == Op::ALLOCATE ? 0 : 1].get();
+    if (size_class == kAllClasses) return &per_op[0];
+    return size_class < histograms->class_count ? &per_op[1 + size_class] : nullptr;
+}
+
+LatencyHistogram::Summary LatencyRecorder::summary(Op op, size_t size_class) const {
+    const LatencyHistogram* found = histogram(op, size_class);
+    return found ? found->summary() : LatencyHistogram::Summary{};
+}
+
+size_t LatencyRecorder::getClassCount() const {
+    Histograms* histograms = histograms_.load(std::memory_order_acquire);
+    return histograms ? histograms->class_count : 0;
+}
@@ -3,6 +3,11 @@
 #include "slab_allocator.h"
 #include "pool_allocator.h"
 #include "hybrid_allocator.h"
+#include "persistent_allocator.h"
+#include "arena_allocator.h"
+#include "stack_allocator.h"
+#include "frame_allocator.h"
+#include "tlsf_allocator.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -12,28 +17,96 @@
 #include <vector>
 
 MemoryAllocator::MemoryAllocator(size_t total_memory) 
-    : total_memory_(total_memory), allocated_size_(0), allocation_count_(0), deallocation_count_(0) {
+    : total_memory_(total_memory) {
 }
 
 MemoryAllocator::~MemoryAllocator() {
+#ifndef MEMORY_ALLOCATOR_QUIET
     std::cout << "Destroyed memory allocator\n";
-    std::cout << "  Total allocations: " << allocation_count_ << "\n";
-    std::cout << "  Total deallocations: " << deallocation_count_ << "\n";
-    std::cout << "  Allocated size: " << allocated_size_ << " bytes\n";
+    std::cout << "  Total allocations: " << getAllocationCount() << "\n";
+    std::cout << "  Total deallocations: " << getDeallocationCount() << "\n";
+    std::cout << "  Allocated size: " << getAllocatedSize() << " bytes\n";
+#endif
+}
+
+void MemoryAllocator::deallocate(void* ptr, size_t size) {
+    // Allocators that cannot use the size fall back to the lookup
+    (void)size;
+    deallocate(ptr);
+}
+
+size_t MemoryAllocator::allocate_batch(size_t size, size_t count, void** out) {
+    // Generic fallback - allocators with cheaper bulk paths override this
+    size_t allocated = 0;
+    while (allocated < count) {
+        void* ptr = allocate(size);
+        if (!ptr) break;
+        out[allocated++] = ptr;
+    }
+    return allocated;
+}
+
+void MemoryAllocator::deallocate_batch(void* const* ptrs, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (ptrs[i]) {
+            deallocate(ptrs[i]);
+        }
+    }
+}
+
+MemoryAllocator::AllocationStats MemoryAllocator::getAllocationStats() const {
+    StatsCounters::Snapshot snapshot = counters_.snapshot();
+    
+    AllocationStats stats;
+    stats.total_allocated = snapshot.bytes_allocated;
+    stats.total_freed = snapshot.bytes_freed;
+    stats.current_allocated = snapshot.current_bytes;
+    stats.peak_allocated = snapshot.peak_bytes;
+    stats.num_allocations = snapshot.allocations;
+    stats.num_deallocations = snapshot.deallocations;
+    stats.num_failures = snapshot.failures;
+    stats.alloc_latency = latency_.summary(LatencyRecorder::Op::ALLOCATE);
+    stats.dealloc_latency = latency_.summary(LatencyRecorder::Op::DEALLOCATE);
+    stats.avg_alloc_time_ns = stats.alloc_latency.mean_ns;
+    stats.avg_dealloc_time_ns = stats.dealloc_latency.mean_ns;
+    return stats;
+}
+
+void MemoryAllocator::enableLatencySampling(uint32_t sample_every) {
+    latency_.enable(sample_every, getLatencyClassCount());
+}
+
+void MemoryAllocator::appendLatencyLine(std::string& out, const std::string& label,
+                                        const LatencyHistogram::Summary& summary) {
+    if (summary.count == 0) return;
+    
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(0);
+    oss << label << " p50 " << summary.p50_ns << " ns, p99 " << summary.p99_ns
+        << " ns, p99.9 " << summary.p999_ns << " ns, max " << summary.max_ns
+        << " ns (" << summary.count << " samples)\n";
+    out += oss.str();
 }
 
 std::string MemoryAllocator::getStats() const {
+    StatsCounters::Snapshot snapshot = counters_.snapshot();
+    
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
     oss << "Memory Allocator Statistics:\n";
     oss << "  Total Memory: " << total_memory_ << " bytes\n";
-    oss << "  Total Allocations: " << allocation_count_ << "\n";
-    oss << "  Total Deallocations: " << deallocation_count_ << "\n";
-    oss << "  Current Allocated: " << allocated_size_ << " bytes\n";
-    oss << "  Utilization: " << (100.0 * allocated_size_ / total_memory_) << "%\n";
+    oss << "  Total Allocations: " << snapshot.allocations << "\n";
+    oss << "  Total Deallocations: " << snapshot.deallocations << "\n";
+    oss << "  Failed Allocations: " << snapshot.failures << "\n";
+    oss << "  Current Allocated: " << snapshot.current_bytes << " bytes\n";
+    oss << "  Peak Allocated: " << snapshot.peak_bytes << " bytes\n";
+    oss << "  Utilization: " << (100.0 * snapshot.current_bytes / total_memory_) << "%\n";
     oss << "  Current Fragmentation: " << getFragmentation() << " bytes\n";
     
-    return oss.str();
+    std::string stats = oss.str();
+    appendLatencyLine(stats, "  Allocate Latency:", latency_.summary(LatencyRecorder::Op::ALLOCATE));
+    appendLatencyLine(stats, "  Deallocate Latency:", latency_.summary(LatencyRecorder::Op::DEALLOCATE));
+    return stats;
 }
 
 void MemoryAllocator::benchmarkAllocation(size_t num_iterations, size_t alloc_size) {
@@ -143,8 +216,37 @@ std::unique_ptr<MemoryAllocator> AllocatorFactory::create_allocator(
             return std::make_unique<PoolAllocator>(pool_config);
         }
             
-        case AllocatorType::HYBRID:
-            return std::make_unique<HybridAllocator>(initial_size);
+        case AllocatorType::HYBRID: {
+            // config is a HybridConfig string, or "@path" to a file such as hybrid_tuner output
+            if (config.empty()) {
+                return std::make_unique<HybridAllocator>(initial_size);
+            }
+            HybridAllocator::HybridConfig hybrid_config = config[0] == '@'
+                ? HybridAllocator::HybridConfig::load(config.substr(1))
+                : HybridAllocator::HybridConfig::fromString(config);
+            return std::make_unique<HybridAllocator>(initial_size, hybrid_config);
+        }
+            
+        case AllocatorType::PERSISTENT: {
+            if (config.empty()) {
+                throw std::invalid_argument("Persistent allocator needs a file path as config");
+            }
+            return std::make_unique<PersistentAllocator>(config, initial_size);
+        }
+            
+        case AllocatorType::ARENA: {
+            size_t chunk_size = config.empty() ? 64 * 1024 : std::stoul(config);
+            return std::make_unique<ArenaAllocator>(initial_size, chunk_size);
+        }
+            
+        case AllocatorType::STACK:
+            return std::make_unique<StackAllocator>(initial_size);
+            
+        case AllocatorType::FRAME:
+            return std::make_unique<FrameAllocator>(initial_size);
+            
+        case AllocatorType::TLSF:
+            return std::make_unique<TlsfAllocator>(initial_size);
             
         default:
             throw std::invalid_argument("Unknown allocator type");
@@ -0,0 +1,334 @@
+#include "../includes/offset_heap.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Offset 0 of the region. Every link is an offset from the start of the region.
+struct OffsetHeap::Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t region_size;
+    uint64_t data_start;               // First block
+    uint64_t bump;                     // First byte never handed out
+    uint64_t root;                     // Application's entry object, 0 if none
+    uint64_t allocated_bytes;          // Live blocks, headers included
+    uint64_t live_blocks;
+    uint64_t free_bytes;               // Blocks on the free lists
+    uint32_t open;                     // Set while a process has the heap open
+    uint32_t class_count;
+    uint64_t free_lists[kMaxClasses];  // First free block of each class
+};
+
+// In front of every block; a free block keeps the next free block's offset after it
+// and the previous one's in the first word of its payload
+struct OffsetHeap::BlockHeader {
+    uint32_t tag;
+    uint32_t size_class;
+    uint64_t size;                     // Requested size while live, next free block while free
+};
+
+namespace {
+const char kHeapMagic[8] = {'M', 'A', 'H', 'E', 'A', 'P', '\0', '\0'};
+constexpr uint32_t kLiveTag = 0x4c495645;  // "LIVE"
+constexpr uint32_t kFreeTag = 0x46524545;  // "FREE"
+}
+
+size_t OffsetHeap::classFor(size_t size) {
+    size_t size_class = 0;
+    while (size_class < kMaxClasses && classSize(size_class) < size) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+void OffsetHeap::format(const std::string& name) {
+    static_assert(sizeof(BlockHeader) == 16, "payloads must stay 16-byte aligned");
+
+    size_t data_start = (sizeof(Header) + 63) & ~size_t(63);
+    if (size_ < data_start + kMinBlockSize) {
+        throw std::runtime_error("Heap " + name + " is too small");
+    }
+
+    Header* h = header();
+    std::memset(h, 0, sizeof(Header));
+    std::memcpy(h->magic, kHeapMagic, sizeof(kHeapMagic));
+    h->version = kVersion;
+    h->header_size = sizeof(Header);
+    h->region_size = size_;
+    h->data_start = data_start;
+    h->bump = data_start;
+    h->class_count = kMaxClasses;
+}
+
+void OffsetHeap::validate(const std::string& name) const {
+    const Header* h = header();
+    auto fail = [&name](const std::string& reason) {
+        throw std::runtime_error("Heap " + name + " is not usable: " + reason);
+    };
+
+    if (size_ < sizeof(Header) || std::memcmp(h->magic, kHeapMagic, sizeof(kHeapMagic)) != 0) {
+        fail("not a heap");
+    }
+    if (h->version != kVersion || h->header_size != sizeof(Header) || h->class_count != kMaxClasses) {
+        fail("written by an incompatible version");
+    }
+    if (h->region_size != size_) {
+        fail("size changed");
+    }
+    if (h->data_start < sizeof(Header) || h->data_start % 16 != 0 ||
+        h->bump < h->data_start || h->bump > h->region_size) {
+        fail("damaged header");
+    }
+    if (h->root != 0 && (h->root < h->data_start + sizeof(BlockHeader) || h->root >= h->bump)) {
+        fail("root outside the heap");
+    }
+}
+
+void OffsetHeap::recover(const std::string& name) {
+    Header* h = header();
+    std::memset(h->free_lists, 0, sizeof(h->free_lists));
+    h->allocated_bytes = 0;
+    h->live_blocks = 0;
+    h->free_bytes = 0;
+
+    // Blocks are contiguous from data_start to bump; anything that was not yet
+    // tagged live when the process stopped is free again
+    uint64_t offset = h->data_start;
+    while (offset < h->bump) {
+        BlockHeader* block = blockAt(offset);
+        if ((block->tag != kLiveTag && block->tag != kFreeTag) || block->size_class >= kMaxClasses ||
+            classSize(block->size_class) > h->bump - offset) {
+            throw std::runtime_error("Heap " + name + " is not usable: damaged block at offset " +
+                                     std::to_string(offset));
+        }
+
+        size_t block_size = classSize(block->size_class);
+        if (block->tag == kLiveTag) {
+            h->allocated_bytes += block_size;
+            ++h->live_blocks;
+        } else {
+            pushFree(offset, block->size_class);
+        }
+        offset += block_size;
+    }
+}
+
+OffsetHeap::Block OffsetHeap::allocate(size_t size) {
+    Header* h = header();
+    Block result;
+    result.size_class = classFor(size + sizeof(BlockHeader));
+    if (result.size_class >= kMaxClasses) {
+        return result;
+    }
+
+    // Own class, then the smallest larger free block split down, then fresh space
+    size_t size_class = result.size_class;
+    while (size_class < kMaxClasses && !h->free_lists[size_class]) {
+        ++size_class;
+    }
+
+    uint64_t offset = 0;
+    if (size_class < kMaxClasses) {
+        offset = h->free_lists[size_class];
+        unlinkFree(offset, size_class);
+
+        // Keep the lower half, free the upper one; tagged before the lower header shrinks over it
+        while (size_class > result.size_class) {
+            --size_class;
+            uint64_t upper = offset + classSize(size_class);
+            BlockHeader* half = blockAt(upper);
+            half->tag = kFreeTag;
+            half->size_class = static_cast<uint32_t>(size_class);
+            blockAt(offset)->size_class = static_cast<uint32_t>(size_class);
+            pushFree(upper, size_class);
+        }
+    } else {
+        size_class = result.size_class;
+        offset = carve(size_class);
+        if (!offset) {
+            return result;
+        }
+    }
+
+    BlockHeader* block = blockAt(offset);
+    block->size = size;
+    block->tag = kLiveTag;
+    h->allocated_bytes += classSize(size_class);
+    ++h->live_blocks;
+
+    result.ptr = block + 1;
+    result.block_size = classSize(size_class);
+    return result;
+}
+
+uint64_t OffsetHeap::carve(size_t size_class) {
+    // A block starts at a multiple of its size past data_start, which is what makes
+    // the buddy's offset relative ^ size; the gap below becomes free blocks
+    Header* h = header();
+    uint64_t size = classSize(size_class);
+    uint64_t used = h->bump - h->data_start;
+    uint64_t capacity = h->region_size - h->data_start;
+    uint64_t start = (used + size - 1) & ~(size - 1);
+    if (start > capacity || capacity - start < size) {
+        return 0;
+    }
+
+    while (used < start) {
+        uint64_t gap = used & (~used + 1); // Largest block that may start here
+        uint64_t offset = h->bump;
+        BlockHeader* block = blockAt(offset);
+        block->size_class = static_cast<uint32_t>(classFor(gap));
+        block->tag = kFreeTag;
+        h->bump += gap;
+        insertFree(offset, block->size_class);
+        used += gap;
+    }
+
+    uint64_t offset = h->bump;
+    BlockHeader* block = blockAt(offset);
+    block->size_class = static_cast<uint32_t>(size_class);
+    block->tag = kFreeTag; // Walkable before bump moves past it
+    h->bump += size;
+    return offset;
+}
+
+uint64_t& OffsetHeap::prevFree(uint64_t offset) const {
+    return *reinterpret_cast<uint64_t*>(base_ + offset + sizeof(BlockHeader));
+}
+
+void OffsetHeap::pushFree(uint64_t offset, size_t size_class) {
+    Header* h = header();
+    uint64_t next = h->free_lists[size_class];
+    blockAt(offset)->size = next;
+    prevFree(offset) = 0;
+    if (next) {
+        prevFree(next) = offset;
+    }
+    h->free_lists[size_class] = offset;
+    h->free_bytes += classSize(size_class);
+}
+
+void OffsetHeap::unlinkFree(uint64_t offset, size_t size_class) {
+    Header* h = header();
+    uint64_t next = blockAt(offset)->size;
+    uint64_t prev = prevFree(offset);
+    if (prev) {
+        blockAt(prev)->size = next;
+    } else {
+        h->free_lists[size_class] = next;
+    }
+    if (next) {
+        prevFree(next) = prev;
+    }
+    h->free_bytes -= classSize(size_class);
+}
+
+void OffsetHeap::insertFree(uint64_t offset, size_t size_class) {
+    Header* h = header();
+
+    // Merge while the buddy is carved, free and whole; the lower of the two is kept
+    while (size_class + 1 < kMaxClasses) {
+        uint64_t size = classSize(size_class);
+        uint64_t buddy = h->data_start + ((offset - h->data_start) ^ size);
+        if (buddy + size > h->bump) {
+            break;
+        }
+        const BlockHeader* other = blockAt(buddy);
+        if (other->tag != kFreeTag || other->size_class != size_class) {
+            break;
+        }
+        unlinkFree(buddy, size_class);
+        offset = std::min(offset, buddy);
+        ++size_class;
+        blockAt(offset)->size_class = static_cast<uint32_t>(size_class);
+    }
+    pushFree(offset, size_class);
+}
+
+OffsetHeap::BlockHeader* OffsetHeap::liveBlock(void* ptr) const {
+    const Header* h = header();
+    char* address = static_cast<char*>(ptr);
+    if (address < base_ + h->data_start + sizeof(BlockHeader) || address >= base_ + h->bump ||
+        (address - base_) % 16 != 0) {
+        return nullptr;
+    }
+
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(address) - 1;
+    return block->tag == kLiveTag && block->size_class < kMaxClasses ? block : nullptr;
+}
+
+bool OffsetHeap::isLive(void* ptr) const {
+    return liveBlock(ptr) != nullptr;
+}
+
+OffsetHeap::Block OffsetHeap::deallocate(void* ptr) {
+    Block result;
+    BlockHeader* block = liveBlock(ptr);
+    if (!block) {
+        return result;
+    }
+
+    Header* h = header();
+    size_t size_class = block->size_class;
+    uint64_t offset = toOffset(block);
+    if (h->root == offset + sizeof(BlockHeader)) {
+        h->root = 0;
+    }
+
+    block->tag = kFreeTag;
+    h->allocated_bytes -= classSize(size_class);
+    --h->live_blocks;
+    insertFree(offset, size_class);
+
+    result.ptr = ptr;
+    result.size_class = size_class;
+    result.block_size = classSize(size_class);
+    return result;
+}
+
+uint64_t OffsetHeap::getRoot() const {
+    return header()->root;
+}
+
+void OffsetHeap::setRoot(uint64_t offset) {
+    header()->root = offset;
+}
+
+bool OffsetHeap::isOpen() const {
+    return header()->open != 0;
+}
+
+void OffsetHeap::setOpen(bool open) {
+    header()->open = open ? 1 : 0;
+}
+
+OffsetHeap::Totals OffsetHeap::getTotals() const {
+    const Header* h = header();
+    Totals totals;
+    totals.region_size = h->region_size;
+    totals.used = h->bump - h->data_start;
+    totals.allocated_bytes = h->allocated_bytes;
+    totals.live_blocks = h->live_blocks;
+    totals.free_bytes = h->free_bytes;
+    return totals;
+}
+
+std::vector<MemoryAllocator::MemoryBlock> OffsetHeap::getLayout() const {
+    const Header* h = header();
+    std::vector<MemoryAllocator::MemoryBlock> layout;
+    layout.push_back({0, static_cast<size_t>(h->data_start), false, "Heap Header"});
+
+    uint64_t offset = h->data_start;
+    while (offset < h->bump) {
+        const BlockHeader* block = blockAt(offset);
+        size_t block_size = classSize(block->size_class);
+        bool is_free = block->tag != kLiveTag;
+        layout.push_back({static_cast<size_t>(offset), block_size, is_free, is_free ? "Free Block" : "Allocated Block"});
+        offset += block_size;
+    }
+    if (offset < h->region_size) {
+        layout.push_back({static_cast<size_t>(offset), static_cast<size_t>(h->region_size - offset), true, "Unused"});
+    }
+    return layout;
+}
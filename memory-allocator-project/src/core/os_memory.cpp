@@ -0,0 +1,177 @@
+#include "../includes/os_memory.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+size_t os_page_size() {
+#ifdef _WIN32
+    static const size_t page_size = [] {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwPageSize);
+    }();
+#else
+    static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    return page_size;
+}
+
+size_t os_round_to_pages(size_t size) {
+    size_t page_size = os_page_size();
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+void* os_map_pages(size_t size) {
+    size = os_round_to_pages(size);
+#ifdef _WIN32
+    return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+#endif
+}
+
+void os_unmap_pages(void* ptr, size_t size) {
+    if (!ptr) return;
+#ifdef _WIN32
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, os_round_to_pages(size));
+#endif
+}
+
+void* os_remap_pages(void* ptr, size_t old_size, size_t new_size) {
+    old_size = os_round_to_pages(old_size);
+    new_size = os_round_to_pages(new_size);
+    if (old_size == new_size) return ptr;
+#ifdef __linux__
+    void* moved = mremap(ptr, old_size, new_size, MREMAP_MAYMOVE);
+    return moved == MAP_FAILED ? nullptr : moved;
+#else
+    void* moved = os_map_pages(new_size);
+    if (!moved) return nullptr;
+    std::memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    os_unmap_pages(ptr, old_size);
+    return moved;
+#endif
+}
+
+#ifndef _WIN32
+// Sizes an empty fd to size (when allowed) and maps it shared; takes ownership of fd
+static bool map_descriptor(int fd, size_t size, bool may_size, OsFileMapping& mapping) {
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0;
+    if (ok && info.st_size == 0) {
+        // Sparse: pages get backing store only when written
+        if (!may_size) errno = EAGAIN; // Its creator has not sized it yet
+        ok = may_size && size > 0 && ftruncate(fd, static_cast<off_t>(size)) == 0;
+        mapping.created = ok;
+    } else if (ok) {
+        size = static_cast<size_t>(info.st_size);
+    }
+    
+    void* address = ok ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    if (address == MAP_FAILED) {
+        close(fd); // Also drops a lock taken on it
+        mapping = OsFileMapping();
+        return false;
+    }
+    
+    mapping.address = address;
+    mapping.size = size;
+    mapping.fd = fd;
+    return true;
+}
+#endif
+
+bool os_map_file(const char* path, size_t size, bool create, bool exclusive, OsFileMapping& mapping) {
+    mapping = OsFileMapping();
+#ifdef _WIN32
+    (void)path; (void)size; (void)create; (void)exclusive;
+    return false;
+#else
+    int fd = open(path, create ? O_RDWR | O_CREAT : O_RDWR, 0644);
+    if (fd < 0) return false;
+    if (exclusive && flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return false;
+    }
+    return map_descriptor(fd, size, create, mapping);
+#endif
+}
+
+bool os_map_shared(const char* name, size_t size, bool create, OsFileMapping& mapping) {
+    mapping = OsFileMapping();
+#if defined(_WIN32)
+    (void)name; (void)size; (void)create;
+    return false;
+#else
+    if (!name || !*name) {
+#ifdef __linux__
+        int fd = memfd_create("memory-allocator", 0);
+        return fd >= 0 && map_descriptor(fd, size, true, mapping);
+#else
+        return false;
+#endif
+    }
+    
+    // Only the process whose O_EXCL open succeeds sizes the object
+    int fd = create ? shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600) : -1;
+    bool creator = fd >= 0;
+    if (!creator) fd = shm_open(name, O_RDWR, 0600);
+    if (fd < 0) return false;
+    if (!map_descriptor(fd, size, creator, mapping)) {
+        if (creator) shm_unlink(name);
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool os_map_shared_fd(int fd, OsFileMapping& mapping) {
+    mapping = OsFileMapping();
+#ifdef _WIN32
+    (void)fd;
+    return false;
+#else
+    int copy = dup(fd);
+    return copy >= 0 && map_descriptor(copy, 0, false, mapping);
+#endif
+}
+
+bool os_unlink_shared(const char* name) {
+#ifdef _WIN32
+    (void)name;
+    return false;
+#else
+    return shm_unlink(name) == 0;
+#endif
+}
+
+bool os_flush_file(const OsFileMapping& mapping) {
+#ifdef _WIN32
+    (void)mapping;
+    return false;
+#else
+    return mapping.address && msync(mapping.address, mapping.size, MS_SYNC) == 0;
+#endif
+}
+
+void os_unmap_file(OsFileMapping& mapping) {
+#ifndef _WIN32
+    if (mapping.address) munmap(mapping.address, mapping.size);
+    if (mapping.fd >= 0) close(mapping.fd);
+#endif
+    mapping = OsFileMapping();
+}
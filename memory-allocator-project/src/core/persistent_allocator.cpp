@@ -0,0 +1,152 @@
+#include "../includes/persistent_allocator.h"
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+PersistentAllocator::PersistentAllocator(const std::string& path, size_t size, OpenMode mode)
+    : MemoryAllocator(size), path_(path) {
+    bool create = mode != OpenMode::OPEN;
+    if (!os_map_file(path.c_str(), size, create, true, mapping_)) {
+        throw std::runtime_error("Cannot map heap file " + path + ": " + std::strerror(errno) +
+                                 " (missing, in use, or not sized)");
+    }
+    created_ = mapping_.created;
+    total_memory_ = mapping_.size;
+    heap_ = OffsetHeap(mapping_.address, mapping_.size);
+    counters_.setClassCount(OffsetHeap::kMaxClasses);
+
+    try {
+        if (mode == OpenMode::CREATE && !created_) {
+            throw std::runtime_error("Heap file " + path + " already exists");
+        }
+        if (created_) {
+            heap_.format(path);
+        } else {
+            heap_.validate(path);
+            if (heap_.isOpen()) {
+                heap_.recover(path); // The last process died with the heap mapped
+                recovered_ = true;
+            }
+            // Objects from earlier runs are live allocations of this one
+            OffsetHeap::Totals totals = heap_.getTotals();
+            if (totals.live_blocks > 0) {
+                counters_.recordAllocation(totals.allocated_bytes, StatsCounters::kNoClass, totals.live_blocks);
+            }
+        }
+    } catch (...) {
+        os_unmap_file(mapping_);
+        throw;
+    }
+
+    heap_.setOpen(true);
+    os_flush_file(mapping_);
+}
+
+PersistentAllocator::~PersistentAllocator() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Everything is written back before the heap is marked closed
+    os_flush_file(mapping_);
+    heap_.setOpen(false);
+    os_flush_file(mapping_);
+    os_unmap_file(mapping_);
+}
+
+void* PersistentAllocator::allocate(size_t size) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    OffsetHeap::Block block = heap_.allocate(size);
+    if (!block.ptr) {
+        counters_.recordFailure(block.size_class < OffsetHeap::kMaxClasses ? block.size_class
+                                                                           : StatsCounters::kNoClass);
+        return nullptr;
+    }
+
+    probe.setClass(block.size_class);
+    counters_.recordAllocation(block.block_size, block.size_class);
+    return block.ptr;
+}
+
+void PersistentAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    OffsetHeap::Block block = heap_.deallocate(ptr);
+    if (!block.ptr) {
+        return; // Foreign pointer or double free
+    }
+
+    probe.setClass(block.size_class);
+    counters_.recordDeallocation(block.block_size, block.size_class);
+}
+
+void PersistentAllocator::reset() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    heap_.format(path_);
+    heap_.setOpen(true);
+    counters_.reset();
+    latency_.reset();
+}
+
+void PersistentAllocator::setRoot(void* ptr) {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    if (ptr && !heap_.isLive(ptr)) {
+        throw std::invalid_argument("Root must be an object allocated from this heap");
+    }
+    heap_.setRoot(heap_.toOffset(ptr));
+}
+
+void* PersistentAllocator::getRoot() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return heap_.fromOffset(heap_.getRoot());
+}
+
+uint64_t PersistentAllocator::toOffset(const void* ptr) const {
+    return heap_.toOffset(ptr);
+}
+
+void* PersistentAllocator::fromOffset(uint64_t offset) const {
+    return heap_.fromOffset(offset);
+}
+
+bool PersistentAllocator::flush() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return os_flush_file(mapping_);
+}
+
+size_t PersistentAllocator::getFragmentation() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Free blocks are only reused by their own class or smaller requests
+    OffsetHeap::Totals totals = heap_.getTotals();
+    return totals.used ? static_cast<size_t>(totals.free_bytes * 100 / totals.used) : 0;
+}
+
+std::string PersistentAllocator::getStats() const {
+    // Base stats call getFragmentation(), which takes the lock itself
+    std::string stats = MemoryAllocator::getStats();
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    OffsetHeap::Totals totals = heap_.getTotals();
+    uint64_t root = heap_.getRoot();
+
+    std::ostringstream oss;
+    oss << "Persistent Allocator Stats:\n";
+    oss << "  File: " << path_ << (created_ ? " (created)" : recovered_ ? " (recovered)" : " (reopened)") << "\n";
+    oss << "  Region Size: " << totals.region_size << " bytes\n";
+    oss << "  Used (bump): " << totals.used << " bytes\n";
+    oss << "  Live Blocks: " << totals.live_blocks << " (" << totals.allocated_bytes << " bytes)\n";
+    oss << "  Free Block Bytes: " << totals.free_bytes << "\n";
+    oss << "  Root: " << (root ? "offset " + std::to_string(root) : std::string("none")) << "\n";
+    return stats + oss.str();
+}
+
+std::vector<MemoryAllocator::MemoryBlock> PersistentAllocator::getMemoryLayout() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return heap_.getLayout();
+}
@@ -3,69 +3,179 @@
 #include <algorithm>
 #include <sstream>
 #include <iomanip>
+#include <cassert>
+#include <stdexcept>
 
 // MemoryPool implementation
-PoolAllocator::MemoryPool::MemoryPool(size_t block_size, size_t num_blocks)
-    : memory(nullptr), free_list(nullptr), block_size(block_size), 
-      total_blocks(num_blocks), free_blocks(0) {
+PoolAllocator::MemoryPool::MemoryPool(size_t block_size, size_t num_blocks, void* region)
+    : memory(region), free_list(nullptr), block_size(block_size), 
+      total_blocks(num_blocks), free_blocks(0), carved_blocks(0), owns_memory(region == nullptr) {
 }
 
 PoolAllocator::MemoryPool::~MemoryPool() {
-    if (memory) {
+    if (memory && owns_memory) {
         std::free(memory);
     }
 }
 
 bool PoolAllocator::MemoryPool::initialize() {
-    if (memory) {
-        std::free(memory);
-    }
-      // Allocate memory for all blocks
-    size_t total_size = block_size * total_blocks;
-    memory = std::malloc(total_size);
-    
+    // Allocate memory for all blocks once; re-initialization reuses the region
     if (!memory) {
-        return false;
+        memory = std::malloc(block_size * total_blocks);
+        if (!memory) {
+            return false;
+        }
     }
     
-    // Initialize free list - link all blocks
+    // Blocks are carved lazily from the bump pointer, so nothing is written
+    // into the region here and untouched pages stay uncommitted
+    occupancy.assign((total_blocks + 63) / 64, 0);
     free_list = nullptr;
-    char* current_block = static_cast<char*>(memory);
-    
-    for (size_t i = 0; i < total_blocks; ++i) {
-        FreeBlock* block = reinterpret_cast<FreeBlock*>(current_block);
-        block->next = free_list;
-        free_list = block;
-        current_block += block_size;
-    }
-    
+    carved_blocks = 0;
     free_blocks = total_blocks;
     return true;
 }
 
 void* PoolAllocator::MemoryPool::allocate_block() {
-    if (!free_list) {
+    void* block = nullptr;
+    
+    if (free_list) {
+        // Reuse a previously freed block
+        block = free_list;
+        free_list = free_list->next;
+    } else if (carved_blocks < total_blocks) {
+        // Carve a never-used block from the bump pointer
+        block = static_cast<char*>(memory) + carved_blocks * block_size;
+        ++carved_blocks;
+    } else {
         return nullptr;
     }
     
-    FreeBlock* block = free_list;
-    free_list = free_list->next;
+    size_t index = block_index(block);
+    occupancy[index / 64] |= (uint64_t(1) << (index % 64));
     --free_blocks;
-    
     return block;
 }
 
+size_t PoolAllocator::MemoryPool::allocate_blocks(size_t count, void** out) {
+    size_t n = std::min(count, free_blocks);
+    size_t taken = 0;
+    
+    // Detach a whole segment from the head of the free list
+    FreeBlock* block = free_list;
+    while (taken < n && block) {
+        out[taken++] = block;
+        block = block->next;
+    }
+    free_list = block;
+    
+    // Carve the rest from the bump pointer
+    char* carve = static_cast<char*>(memory) + carved_blocks * block_size;
+    while (taken < n) {
+        out[taken++] = carve;
+        carve += block_size;
+        ++carved_blocks;
+    }
+    
+    for (size_t i = 0; i < n; ++i) {
+        size_t index = block_index(out[i]);
+        occupancy[index / 64] |= (uint64_t(1) << (index % 64));
+    }
+    
+    free_blocks -= n;
+    return n;
+}
+
 void PoolAllocator::MemoryPool::deallocate_block(void* ptr) {
-    if (!ptr || !contains_address(ptr)) {
-        return;
+    if (!is_allocated(ptr)) {
+        return; // Foreign pointer or double free
     }
     
+    size_t index = block_index(ptr);
+    occupancy[index / 64] &= ~(uint64_t(1) << (index % 64));
+    
     FreeBlock* block = static_cast<FreeBlock*>(ptr);
     block->next = free_list;
     free_list = block;
     ++free_blocks;
 }
 
+size_t PoolAllocator::MemoryPool::find_free_run(size_t count) const {
+    // First fit over the bitmap, one 64-bit word at a time: free and full words
+    // are consumed whole, mixed words are split into runs with count-trailing-zeros
+    size_t run_start = 0;
+    size_t run_length = 0;
+    
+    for (size_t w = 0; w < occupancy.size() && run_length < count; ++w) {
+        uint64_t word = occupancy[w];
+        size_t base = w * 64;
+        
+        if (word == 0) {
+            if (run_length == 0) run_start = base;
+            run_length += 64;
+            continue;
+        }
+        if (word == ~uint64_t(0)) {
+            run_length = 0;
+            continue;
+        }
+        
+        size_t bit = 0;
+        while (bit < 64 && run_length < count) {
+            uint64_t rest = word >> bit;
+            size_t zeros = rest ? static_cast<size_t>(__builtin_ctzll(rest)) : 64 - bit;
+            if (zeros > 0) {
+                if (run_length == 0) run_start = base + bit;
+                run_length += zeros;
+                bit += zeros;
+                if (bit >= 64 || run_length >= count) break;
+            }
+            
+            // Skip the allocated blocks that end the run
+            bit += static_cast<size_t>(__builtin_ctzll(~(word >> bit)));
+            run_length = 0;
+        }
+    }
+    
+    // Padding bits past the last block read as free and must not complete a run
+    if (run_length < count || run_start + count > total_blocks) {
+        return static_cast<size_t>(-1);
+    }
+    return run_start;
+}
+
+void PoolAllocator::MemoryPool::claim_run(size_t start, size_t count) {
+    char* first = static_cast<char*>(memory) + start * block_size;
+    char* last = first + count * block_size;
+    
+    // Carved blocks in the run are on the free list and have to be unlinked;
+    // first fit never starts a run past the bump pointer, so nothing is skipped
+    if (start < carved_blocks) {
+        FreeBlock** link = &free_list;
+        while (*link) {
+            char* address = reinterpret_cast<char*>(*link);
+            if (address >= first && address < last) {
+                *link = (*link)->next;
+            } else {
+                link = &(*link)->next;
+            }
+        }
+    }
+    carved_blocks = std::max(carved_blocks, start + count);
+    
+    for (size_t i = start; i < start + count; ++i) {
+        occupancy[i / 64] |= (uint64_t(1) << (i % 64));
+    }
+    free_blocks -= count;
+}
+
+void PoolAllocator::MemoryPool::release_run(size_t start, size_t count) {
+    char* block = static_cast<char*>(memory) + start * block_size;
+    for (size_t i = 0; i < count; ++i, block += block_size) {
+        deallocate_block(block);
+    }
+}
+
 bool PoolAllocator::MemoryPool::contains_address(void* ptr) const {
     if (!memory || !ptr) {
         return false;
@@ -79,6 +189,19 @@ bool PoolAllocator::MemoryPool::contains_address(void* ptr) const {
            ((address - start) % block_size == 0);
 }
 
+bool PoolAllocator::MemoryPool::is_allocated(void* ptr) const {
+    if (!contains_address(ptr)) {
+        return false;
+    }
+    
+    size_t index = block_index(ptr);
+    return (occupancy[index / 64] >> (index % 64)) & 1;
+}
+
+size_t PoolAllocator::MemoryPool::block_index(void* ptr) const {
+    return static_cast<size_t>(static_cast<char*>(ptr) - static_cast<char*>(memory)) / block_size;
+}
+
 double PoolAllocator::MemoryPool::get_utilization() const {
     if (total_blocks == 0) return 0.0;
     return static_cast<double>(total_blocks - free_blocks) / total_blocks;
@@ -86,12 +209,32 @@ double PoolAllocator::MemoryPool::get_utilization() const {
 
 // PoolAllocator implementation
 PoolAllocator::PoolAllocator(const PoolConfig& config) : MemoryAllocator(config.total_memory) {
+    buildPools(config);
+    counters_.setClassCount(pools_.size());
+}
+
+void PoolAllocator::buildPools(const PoolConfig& config) {
     if (config.block_sizes.size() != config.blocks_per_pool.size()) {
         throw std::invalid_argument("block_sizes and blocks_per_pool must have same size");
     }
     
+    char* region = static_cast<char*>(config.memory);
+    size_t region_left = config.total_memory;
+    
     for (size_t i = 0; i < config.block_sizes.size(); ++i) {
-        auto pool = std::make_unique<MemoryPool>(config.block_sizes[i], config.blocks_per_pool[i]);
+        // Blocks keep kMinAlignment (and room for the free-list link); rounding up
+        // must not run past a caller's region
+        size_t block_size = std::max((config.block_sizes[i] + kMinAlignment - 1) & ~(kMinAlignment - 1), kMinAlignment);
+        size_t num_blocks = config.blocks_per_pool[i];
+        if (region) {
+            num_blocks = std::min(num_blocks, region_left / block_size);
+            region_left -= block_size * num_blocks;
+        }
+        
+        auto pool = std::make_unique<MemoryPool>(block_size, num_blocks, region);
+        if (region) {
+            region += block_size * num_blocks;
+        }
         if (!pool->initialize()) {
             throw std::runtime_error("Failed to initialize memory pool");
         }
@@ -103,6 +246,25 @@ PoolAllocator::PoolAllocator(const PoolConfig& config) : MemoryAllocator(config.
               [](const std::unique_ptr<MemoryPool>& a, const std::unique_ptr<MemoryPool>& b) {
                   return a->block_size < b->block_size;
               });
+    for (size_t i = 0; i < pools_.size(); ++i) {
+        pools_[i]->index = i;
+    }
+}
+
+PoolAllocator::PoolAllocator(size_t block_size, size_t num_blocks, size_t total_memory)
+    : PoolAllocator(singlePoolConfig(block_size, num_blocks, total_memory)) {
+}
+
+PoolAllocator::PoolConfig PoolAllocator::singlePoolConfig(size_t block_size, size_t num_blocks, size_t total_memory) {
+    if (block_size == 0) {
+        throw std::invalid_argument("block_size must be non-zero");
+    }
+    
+    PoolConfig config;
+    config.block_sizes = {block_size};
+    config.blocks_per_pool = {std::min(num_blocks, total_memory / block_size)};
+    config.total_memory = total_memory;
+    return config;
 }
 
 PoolAllocator::~PoolAllocator() {
@@ -110,49 +272,185 @@ PoolAllocator::~PoolAllocator() {
 }
 
 void* PoolAllocator::allocate(size_t size) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
     
     MemoryPool* pool = findPoolForSize(size);
-    if (!pool) {
-        stats_.failed_allocations++;
+    void* ptr = pool ? pool->allocate_block() : nullptr;
+    if (!ptr) {
+        counters_.recordFailure(statsClassFor(size));
         return nullptr;
     }
     
-    void* ptr = pool->allocate_block();
-    if (!ptr) {
-        stats_.failed_allocations++;
-        return nullptr;
+    probe.setClass(pool->index);
+    counters_.recordAllocation(pool->block_size, pool->index);
+    return ptr;
+}
+
+bool PoolAllocator::release(void* ptr) {
+    if (!ptr) return false;
+    
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    if (remote_frees_.isRemote()) {
+        if (!findPoolForAddress(ptr)) return false; // push() writes into the block
+        remote_frees_.push(ptr);
+        return true;
     }
     
-    allocation_map_[ptr] = pool;
-    stats_.total_allocations++;
-    stats_.current_allocated += pool->block_size;
-    stats_.peak_allocated = std::max(stats_.peak_allocated, stats_.current_allocated);
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    MemoryPool* pool = deallocateLocked(ptr);
+    if (pool) probe.setClass(pool->index);
+    return pool != nullptr;
+}
+
+bool PoolAllocator::release(void* ptr, size_t size) {
+    if (!ptr) return false;
+    
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    if (remote_frees_.isRemote()) {
+        if (!findPoolForAddress(ptr)) return false; // push() writes into the block
+        remote_frees_.push(ptr); // The drain finds the pool by address
+        return true;
+    }
     
-    return ptr;
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    
+    // A contiguous run spans several blocks and is freed as a unit, whatever size names
+    if (!contiguous_runs_.empty() && contiguous_runs_.count(ptr)) {
+        MemoryPool* pool = deallocateLocked(ptr);
+        if (pool) probe.setClass(pool->index);
+        return pool != nullptr;
+    }
+    
+    // The pool allocate(size) picks first; a block only lands higher when that one was full
+    MemoryPool* pool = nullptr;
+    for (size_t i = poolIndexFor(size); i < pools_.size(); ++i) {
+        if (pools_[i]->contains_address(ptr)) {
+            pool = pools_[i].get();
+            break;
+        }
+    }
+    assert(pool && pool->contains_address(ptr) && "PoolAllocator: deallocate size does not match the allocation");
+    if (!pool) {
+        pool = deallocateLocked(ptr);
+        if (pool) probe.setClass(pool->index);
+        return pool != nullptr;
+    }
+    
+    assert(pool->is_allocated(ptr) && "PoolAllocator: deallocate of a block that is not allocated");
+    if (!pool->is_allocated(ptr)) {
+        return false; // Double free
+    }
+    
+    pool->release_run(pool->block_index(ptr), 1);
+    counters_.recordDeallocation(pool->block_size, pool->index);
+    probe.setClass(pool->index);
+    return true;
 }
 
-void PoolAllocator::deallocate(void* ptr) {
-    if (!ptr) return;
+PoolAllocator::MemoryPool* PoolAllocator::deallocateLocked(void* ptr) {
+    MemoryPool* pool = findPoolForAddress(ptr);
+    if (!pool || !pool->is_allocated(ptr)) {
+        return nullptr; // Invalid pointer
+    }
+    
+    size_t count = 1;
+    if (!contiguous_runs_.empty()) {
+        auto it = contiguous_runs_.find(ptr);
+        if (it != contiguous_runs_.end()) {
+            count = it->second;
+            contiguous_runs_.erase(it);
+        }
+    }
+    
+    pool->release_run(pool->block_index(ptr), count);
+    counters_.recordDeallocation(count * pool->block_size, pool->index);
+    return pool;
+}
+
+void PoolAllocator::drainRemoteFrees() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
+}
+
+void PoolAllocator::drainRemoteFreesLocked() {
+    RemoteFreeList::Node* node = remote_frees_.takeAll();
+    
+    // A double free makes the chain loop; it is walked only up to the repeat
+    for (size_t count = RemoteFreeList::distinctLength(node); count > 0; --count) {
+        RemoteFreeList::Node* next = node->next;
+        deallocateLocked(node); // A block that is not allocated is skipped
+        node = next;
+    }
+}
+
+void* PoolAllocator::allocate_contiguous(size_t block_size, size_t count) {
+    if (count == 0) return nullptr;
+    if (count == 1) return allocate(block_size);
+    
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
+    
+    // Smallest pool with a long enough run of free blocks
+    for (auto& pool : pools_) {
+        if (pool->block_size < block_size || pool->free_blocks < count) continue;
+        
+        size_t start = pool->find_free_run(count);
+        if (start == static_cast<size_t>(-1)) continue;
+        
+        pool->claim_run(start, count);
+        void* ptr = static_cast<char*>(pool->memory) + start * pool->block_size;
+        contiguous_runs_[ptr] = count;
+        
+        counters_.recordAllocation(count * pool->block_size, pool->index);
+        return ptr;
+    }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.recordFailure(statsClassFor(block_size));
+    return nullptr;
+}
+
+size_t PoolAllocator::allocate_batch(size_t size, size_t count, void** out) {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
     
-    auto it = allocation_map_.find(ptr);
-    if (it == allocation_map_.end()) {
-        return; // Invalid pointer
+    // Fill from the smallest fitting pool, spilling into larger pools
+    size_t allocated = 0;
+    for (auto& pool : pools_) {
+        if (allocated == count) break;
+        if (pool->block_size < size || pool->free_blocks == 0) continue;
+        
+        size_t n = pool->allocate_blocks(count - allocated, out + allocated);
+        allocated += n;
+        if (n > 0) counters_.recordAllocation(n * pool->block_size, pool->index, n);
     }
     
-    MemoryPool* pool = it->second;
-    pool->deallocate_block(ptr);
+    if (allocated < count) {
+        counters_.recordFailure(statsClassFor(size), count - allocated);
+    }
+    return allocated;
+}
+
+void PoolAllocator::deallocate_batch(void* const* ptrs, size_t count) {
+    if (remote_frees_.isRemote()) {
+        for (size_t i = 0; i < count; ++i) {
+            if (ptrs[i] && findPoolForAddress(ptrs[i])) remote_frees_.push(ptrs[i]);
+        }
+        return;
+    }
     
-    stats_.total_deallocations++;
-    stats_.current_allocated -= pool->block_size;
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
-    allocation_map_.erase(it);
+    for (size_t i = 0; i < count; ++i) {
+        if (ptrs[i]) {
+            deallocateLocked(ptrs[i]);
+        }
+    }
 }
 
 size_t PoolAllocator::getFragmentation() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
     // Pool allocators have no internal fragmentation for their block sizes
     // External fragmentation occurs when we can't find a suitable pool
@@ -160,77 +458,164 @@ size_t PoolAllocator::getFragmentation() const {
 }
 
 std::string PoolAllocator::getStats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    StatsCounters::Snapshot snapshot = counters_.snapshot();
+    
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
     std::ostringstream oss;
     oss << std::fixed << std::setprecision(2);
     oss << "Pool Allocator Statistics:\n";
-    oss << "  Total Allocations: " << stats_.total_allocations << "\n";
-    oss << "  Total Deallocations: " << stats_.total_deallocations << "\n";
-    oss << "  Failed Allocations: " << stats_.failed_allocations << "\n";
-    oss << "  Current Allocated: " << stats_.current_allocated << " bytes\n";
-    oss << "  Peak Allocated: " << stats_.peak_allocated << " bytes\n";
-    oss << "  Active Allocations: " << (stats_.total_allocations - stats_.total_deallocations) << "\n";
+    oss << "  Total Allocations: " << snapshot.allocations << "\n";
+    oss << "  Total Deallocations: " << snapshot.deallocations << "\n";
+    oss << "  Failed Allocations: " << snapshot.failures << "\n";
+    oss << "  Current Allocated: " << snapshot.current_bytes << " bytes\n";
+    oss << "  Peak Allocated: " << snapshot.peak_bytes << " bytes\n";
+    oss << "  Active Allocations: " << (snapshot.allocations - snapshot.deallocations) << "\n";
     oss << "  Number of Pools: " << pools_.size() << "\n";
     oss << "  Average Utilization: " << (getAverageUtilization() * 100) << "%\n";
+    if (remote_frees_.getPushed() > 0) {
+        oss << "  Remote Frees: " << remote_frees_.getPushed() << "\n";
+    }
     
     oss << "\nPool Details:\n";
     for (size_t i = 0; i < pools_.size(); ++i) {
         const auto& pool = pools_[i];
+        StatsCounters::ClassSnapshot counts = counters_.classSnapshot(i);
         oss << "  Pool " << i << " (size " << pool->block_size << "): "
             << (pool->total_blocks - pool->free_blocks) << "/" << pool->total_blocks 
-            << " blocks used (" << (pool->get_utilization() * 100) << "%)\n";
+            << " blocks used (" << (pool->get_utilization() * 100) << "%), "
+            << counts.allocations << " allocations, " << counts.failures << " failures\n";
     }
     
-    return oss.str();
+    std::string stats = oss.str();
+    appendLatencyLine(stats, "  Allocate Latency:", latency_.summary(LatencyRecorder::Op::ALLOCATE));
+    appendLatencyLine(stats, "  Deallocate Latency:", latency_.summary(LatencyRecorder::Op::DEALLOCATE));
+    for (size_t i = 0; i < pools_.size(); ++i) {
+        appendLatencyLine(stats, "  Pool " + std::to_string(i) + " Allocate Latency:",
+                          latency_.summary(LatencyRecorder::Op::ALLOCATE, i));
+    }
+    return stats;
 }
 
-std::vector<MemoryAllocator::MemoryBlock> PoolAllocator::getMemoryLayout() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+std::vector<PoolAllocator::PoolSnapshot> PoolAllocator::snapshotPools() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
+    // Only the bitmaps are copied while holding the lock
+    std::vector<PoolSnapshot> snapshots;
+    snapshots.reserve(pools_.size());
+    for (const auto& pool : pools_) {
+        if (!pool->memory) continue;
+        snapshots.push_back({reinterpret_cast<size_t>(pool->memory), pool->block_size,
+                             pool->total_blocks, pool->occupancy});
+    }
+    return snapshots;
+}
+
+std::vector<MemoryAllocator::MemoryBlock> PoolAllocator::getMemoryLayout() const {
     std::vector<MemoryBlock> layout;
     
-    for (size_t i = 0; i < pools_.size(); ++i) {
-        const auto& pool = pools_[i];
-        if (!pool->memory) continue;
-        
-        char* start = static_cast<char*>(pool->memory);
-          for (size_t j = 0; j < pool->total_blocks; ++j) {
+    for (const auto& pool : snapshotPools()) {
+        for (size_t j = 0; j < pool.total_blocks; ++j) {
             MemoryAllocator::MemoryBlock block;
-            block.address = reinterpret_cast<size_t>(start + (j * pool->block_size));
-            block.size = pool->block_size;
+            block.address = pool.base + (j * pool.block_size);
+            block.size = pool.block_size;
+            block.is_free = !((pool.occupancy[j / 64] >> (j % 64)) & 1);
+            block.type = "Pool";
+            layout.push_back(block);
+        }
+    }
+    
+    return layout;
+}
+
+std::vector<MemoryAllocator::MemoryBlock> PoolAllocator::getMemoryLayoutRuns() const {
+    std::vector<MemoryBlock> runs;
+    
+    for (const auto& pool : snapshotPools()) {
+        size_t j = 0;
+        while (j < pool.total_blocks) {
+            bool allocated = (pool.occupancy[j / 64] >> (j % 64)) & 1;
+            size_t run_start = j;
             
-            // Check if this block is allocated
-            bool is_allocated = false;
-            void* block_addr = reinterpret_cast<void*>(block.address);
-            for (const auto& pair : allocation_map_) {
-                if (pair.first == block_addr && pair.second == pool.get()) {
-                    is_allocated = true;
+            // Extend the run, skipping whole words that match it
+            while (j < pool.total_blocks) {
+                uint64_t word = pool.occupancy[j / 64];
+                if (j % 64 == 0 && word == (allocated ? ~uint64_t(0) : 0)) {
+                    j += 64;
+                } else if (((word >> (j % 64)) & 1) == allocated) {
+                    ++j;
+                } else {
                     break;
                 }
             }
+            j = std::min(j, pool.total_blocks);
             
-            block.is_free = !is_allocated;
+            MemoryAllocator::MemoryBlock block;
+            block.address = pool.base + run_start * pool.block_size;
+            block.size = (j - run_start) * pool.block_size;
+            block.is_free = !allocated;
             block.type = "Pool";
-            layout.push_back(block);
+            runs.push_back(block);
         }
     }
     
-    return layout;
+    return runs;
 }
 
 void PoolAllocator::reset() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
-    // Reinitialize all pools
+    // Reinitialize all pools (O(1) each, the regions are kept); queued frees are moot
+    remote_frees_.takeAll();
     for (auto& pool : pools_) {
         pool->initialize();
     }
     
-    allocation_map_.clear();
+    contiguous_runs_.clear();
     
     // Reset statistics
-    stats_ = AllocatorStats{};
+    counters_.reset();
+    latency_.reset();
+}
+
+bool PoolAllocator::retire() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
+    
+    if (getAllocatedSize() != 0) {
+        return false;
+    }
+    
+    // Without pools every allocate fails, so the caller may hand the region elsewhere
+    pools_.clear();
+    contiguous_runs_.clear();
+    return true;
+}
+
+void PoolAllocator::reinitialize(const PoolConfig& config) {
+    if (config.block_sizes.size() != counters_.getClassCount()) {
+        throw std::invalid_argument("reinitialize must keep the number of pools");
+    }
+    
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    
+    // Blocks still live in the old region are forgotten along with their counts
+    remote_frees_.takeAll();
+    pools_.clear();
+    contiguous_runs_.clear();
+    total_memory_ = config.total_memory;
+    buildPools(config);
+    counters_.reset();
+    latency_.reset();
+}
+
+size_t PoolAllocator::getAvailableBlocks() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    size_t available = 0;
+    for (const auto& pool : pools_) {
+        available += pool->free_blocks;
+    }
+    return available;
 }
 
 double PoolAllocator::getAverageUtilization() const {
@@ -244,16 +629,32 @@ double PoolAllocator::getAverageUtilization() const {
     return total_utilization / pools_.size();
 }
 
+size_t PoolAllocator::poolIndexFor(size_t size) const {
+    // pools_ is sorted by block size
+    auto it = std::lower_bound(pools_.begin(), pools_.end(), size,
+                               [](const std::unique_ptr<MemoryPool>& pool, size_t wanted) {
+                                   return pool->block_size < wanted;
+                               });
+    return static_cast<size_t>(it - pools_.begin());
+}
+
 PoolAllocator::MemoryPool* PoolAllocator::findPoolForSize(size_t size) {
     // Find the smallest pool that can accommodate the size
-    for (auto& pool : pools_) {
-        if (pool->block_size >= size && pool->free_blocks > 0) {
-            return pool.get();
+    for (size_t i = poolIndexFor(size); i < pools_.size(); ++i) {
+        if (pools_[i]->free_blocks > 0) {
+            return pools_[i].get();
         }
     }
     return nullptr;
 }
 
+size_t PoolAllocator::statsClassFor(size_t size) const {
+    size_t index = poolIndexFor(size);
+    return index < pools_.size() ? pools_[index]->index : StatsCounters::kNoClass;
+}
+
+// Also called without the lock on the remote path: pools_ only changes in retire()
+// and reinitialize(), which must not race with frees
 PoolAllocator::MemoryPool* PoolAllocator::findPoolForAddress(void* ptr) {
     for (auto& pool : pools_) {
         if (pool->contains_address(ptr)) {
@@ -264,7 +665,7 @@ PoolAllocator::MemoryPool* PoolAllocator::findPoolForAddress(void* ptr) {
 }
 
 bool PoolAllocator::canAllocate(size_t size) const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
     // Check if any pool can handle this size and has free blocks
     for (const auto& pool : pools_) {
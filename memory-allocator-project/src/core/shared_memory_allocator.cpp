@@ -0,0 +1,246 @@
+#include "../includes/shared_memory_allocator.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <pthread.h>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// Offset 0 of the region; the OffsetHeap starts at kHeapOffset
+struct SharedMemoryAllocator::Control {
+    std::atomic<uint32_t> ready;       // kReady once the creator has set up the mutex and heap
+    uint32_t version;
+    pthread_mutex_t mutex;             // Process-shared, robust on Linux
+};
+
+namespace {
+constexpr uint32_t kReady = 0x53484d52;  // "SHMR"
+constexpr uint32_t kControlVersion = 1;
+constexpr size_t kHeapOffset = 256;
+constexpr auto kReadyTimeout = std::chrono::seconds(2);
+}
+
+// Holds the region's mutex. When the previous holder died mid-update the heap is
+// rebuilt from its block tags; if even that fails, locked() is false from then on.
+class SharedMemoryAllocator::Lock {
+public:
+    explicit Lock(const SharedMemoryAllocator& owner) : mutex_(&owner.control()->mutex) {
+        int result = pthread_mutex_trylock(mutex_);
+        if (result == EBUSY) {
+            owner.lock_contended_.fetch_add(1, std::memory_order_relaxed);
+            result = pthread_mutex_lock(mutex_);
+        }
+#ifdef __linux__
+        if (result == EOWNERDEAD) {
+            try {
+                // Recovery writes the region, not the object
+                const_cast<OffsetHeap&>(owner.heap_).recover(owner.name_);
+                pthread_mutex_consistent(mutex_);
+                result = 0;
+            } catch (const std::runtime_error&) {
+                pthread_mutex_unlock(mutex_); // Unrecoverable for every process from now on
+            }
+        }
+#endif
+        locked_ = result == 0;
+        if (locked_) owner.lock_acquisitions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    ~Lock() {
+        if (locked_) pthread_mutex_unlock(mutex_);
+    }
+    Lock(const Lock&) = delete;
+    Lock& operator=(const Lock&) = delete;
+
+    bool locked() const { return locked_; }
+
+private:
+    pthread_mutex_t* mutex_;
+    bool locked_ = false;
+};
+
+SharedMemoryAllocator::SharedMemoryAllocator(const std::string& name, size_t size, OpenMode mode)
+    : MemoryAllocator(size), name_(name) {
+    static_assert(sizeof(Control) <= kHeapOffset, "control block overlaps the heap");
+    if (name.empty()) {
+        throw std::invalid_argument("Shared memory name must not be empty");
+    }
+
+    // An opener can get in between the creator's shm_open and its sizing
+    auto deadline = std::chrono::steady_clock::now() + kReadyTimeout;
+    bool mapped = os_map_shared(name.c_str(), size + kHeapOffset, mode != OpenMode::OPEN, mapping_);
+    while (!mapped && errno == EAGAIN && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        mapped = os_map_shared(name.c_str(), size + kHeapOffset, mode != OpenMode::OPEN, mapping_);
+    }
+    if (!mapped) {
+        throw std::runtime_error("Cannot map shared memory " + name + ": " + std::strerror(errno));
+    }
+    if (mode == OpenMode::CREATE && !mapping_.created) {
+        os_unmap_file(mapping_);
+        throw std::runtime_error("Shared memory " + name + " already exists");
+    }
+    initialize();
+}
+
+SharedMemoryAllocator::SharedMemoryAllocator(size_t size) : MemoryAllocator(size) {
+    if (!os_map_shared(nullptr, size + kHeapOffset, true, mapping_)) {
+        throw std::runtime_error(std::string("Cannot create anonymous shared memory: ") + std::strerror(errno));
+    }
+    initialize();
+}
+
+SharedMemoryAllocator::SharedMemoryAllocator(const OsFileMapping& mapping) : MemoryAllocator(0) {
+    mapping_ = mapping;
+    initialize();
+}
+
+std::unique_ptr<SharedMemoryAllocator> SharedMemoryAllocator::attach(int fd) {
+    OsFileMapping mapping;
+    if (!os_map_shared_fd(fd, mapping)) {
+        throw std::runtime_error(std::string("Cannot map shared memory fd: ") + std::strerror(errno));
+    }
+    return std::unique_ptr<SharedMemoryAllocator>(new SharedMemoryAllocator(mapping));
+}
+
+void SharedMemoryAllocator::initialize() {
+    created_ = mapping_.created;
+    total_memory_ = mapping_.size > kHeapOffset ? mapping_.size - kHeapOffset : 0;
+    counters_.setClassCount(OffsetHeap::kMaxClasses);
+    std::string label = name_.empty() ? std::string("(anonymous shared memory)") : name_;
+
+    try {
+        if (mapping_.size <= kHeapOffset) {
+            throw std::runtime_error("Shared memory " + label + " is too small");
+        }
+        heap_ = OffsetHeap(static_cast<char*>(mapping_.address) + kHeapOffset, total_memory_);
+        Control* c = control();
+
+        if (created_) {
+            pthread_mutexattr_t attributes;
+            pthread_mutexattr_init(&attributes);
+            pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+#ifdef __linux__
+            pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+#endif
+            int result = pthread_mutex_init(&c->mutex, &attributes);
+            pthread_mutexattr_destroy(&attributes);
+            if (result != 0) {
+                throw std::runtime_error("Cannot initialize the lock of " + label);
+            }
+
+            c->version = kControlVersion;
+            heap_.format(label);
+            c->ready.store(kReady, std::memory_order_release);
+            return;
+        }
+
+        // Wait for the creator to finish setting the region up
+        auto deadline = std::chrono::steady_clock::now() + kReadyTimeout;
+        while (c->ready.load(std::memory_order_acquire) != kReady) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                throw std::runtime_error("Shared memory " + label + " was never initialized");
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if (c->version != kControlVersion) {
+            throw std::runtime_error("Shared memory " + label + " was set up by an incompatible version");
+        }
+
+        Lock lock(*this);
+        if (!lock.locked()) {
+            throw std::runtime_error("Shared memory " + label + " is damaged");
+        }
+        heap_.validate(label);
+    } catch (...) {
+        os_unmap_file(mapping_);
+        throw;
+    }
+}
+
+SharedMemoryAllocator::~SharedMemoryAllocator() {
+    os_unmap_file(mapping_);
+}
+
+bool SharedMemoryAllocator::unlink(const std::string& name) {
+    return os_unlink_shared(name.c_str());
+}
+
+void* SharedMemoryAllocator::allocate(size_t size) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    Lock lock(*this);
+
+    OffsetHeap::Block block = lock.locked() ? heap_.allocate(size) : OffsetHeap::Block();
+    if (!block.ptr) {
+        counters_.recordFailure(block.size_class < OffsetHeap::kMaxClasses ? block.size_class
+                                                                           : StatsCounters::kNoClass);
+        return nullptr;
+    }
+
+    probe.setClass(block.size_class);
+    counters_.recordAllocation(block.block_size, block.size_class);
+    return block.ptr;
+}
+
+void SharedMemoryAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    Lock lock(*this);
+    if (!lock.locked()) return;
+
+    OffsetHeap::Block block = heap_.deallocate(ptr);
+    if (!block.ptr) {
+        return; // Foreign pointer or double free
+    }
+
+    probe.setClass(block.size_class);
+    counters_.recordDeallocation(block.block_size, block.size_class);
+}
+
+void SharedMemoryAllocator::setRoot(void* ptr) {
+    Lock lock(*this);
+    if (!lock.locked() || (ptr && !heap_.isLive(ptr))) {
+        throw std::invalid_argument("Root must be an object allocated from this heap");
+    }
+    heap_.setRoot(heap_.toOffset(ptr));
+}
+
+void* SharedMemoryAllocator::getRoot() const {
+    Lock lock(*this);
+    return lock.locked() ? heap_.fromOffset(heap_.getRoot()) : nullptr;
+}
+
+OffsetHeap::Totals SharedMemoryAllocator::getHeapTotals() const {
+    Lock lock(*this);
+    return lock.locked() ? heap_.getTotals() : OffsetHeap::Totals();
+}
+
+MemoryAllocator::LockStats SharedMemoryAllocator::getLockStats() const {
+    return {lock_acquisitions_.load(std::memory_order_relaxed), lock_contended_.load(std::memory_order_relaxed)};
+}
+
+size_t SharedMemoryAllocator::getFragmentation() const {
+    OffsetHeap::Totals totals = getHeapTotals();
+    return totals.used ? static_cast<size_t>(totals.free_bytes * 100 / totals.used) : 0;
+}
+
+std::string SharedMemoryAllocator::getStats() const {
+    std::string stats = MemoryAllocator::getStats();
+    OffsetHeap::Totals totals = getHeapTotals();
+
+    std::ostringstream oss;
+    oss << "Shared Memory Allocator Stats (whole heap):\n";
+    oss << "  Region: " << (name_.empty() ? std::string("anonymous, fd ") + std::to_string(mapping_.fd) : name_)
+        << (created_ ? " (created here)" : " (attached)") << "\n";
+    oss << "  Region Size: " << totals.region_size << " bytes\n";
+    oss << "  Used (bump): " << totals.used << " bytes\n";
+    oss << "  Live Blocks: " << totals.live_blocks << " (" << totals.allocated_bytes << " bytes)\n";
+    oss << "  Free Block Bytes: " << totals.free_bytes << "\n";
+    return stats + oss.str();
+}
+
+std::vector<MemoryAllocator::MemoryBlock> SharedMemoryAllocator::getMemoryLayout() const {
+    Lock lock(*this);
+    return lock.locked() ? heap_.getLayout() : std::vector<MemoryAllocator::MemoryBlock>();
+}
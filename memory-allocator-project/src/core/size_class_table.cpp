@@ -0,0 +1,43 @@
+#include "../includes/size_class_table.h"
+#include <stdexcept>
+
+SizeClassTable::SizeClassTable(size_t max_size, double max_fragmentation) {
+    if (max_fragmentation <= 0.0 || max_fragmentation >= 1.0) {
+        throw std::invalid_argument("SizeClassTable: max_fragmentation must be in (0, 1)");
+    }
+    
+    // Smallest power of two of classes per doubling that meets the bound:
+    // a request above class c wastes less than the spacing 2^k / n <= size / n
+    classes_per_doubling_ = 1;
+    while (1.0 / classes_per_doubling_ > max_fragmentation) {
+        classes_per_doubling_ <<= 1;
+    }
+    
+    // Quantum steps until the geometric spacing catches up with them
+    size_t size = kQuantum;
+    do {
+        class_sizes_.push_back(size);
+        
+        size_t doubling = 1;
+        while (doubling * 2 <= size) doubling <<= 1;
+        size_t spacing = doubling / classes_per_doubling_;
+        size += spacing < kQuantum ? kQuantum : spacing;
+    } while (class_sizes_.back() < max_size);
+    
+    lookup_.resize(class_sizes_.back() / kQuantum + 1);
+    size_t index = 0;
+    for (size_t slot = 0; slot < lookup_.size(); ++slot) {
+        while (class_sizes_[index] < slot * kQuantum) ++index;
+        lookup_[slot] = static_cast<uint16_t>(index);
+    }
+}
+
+size_t SizeClassTable::classIndex(size_t size) const {
+    size_t slot = (size + kQuantum - 1) / kQuantum;
+    return slot < lookup_.size() ? lookup_[slot] : class_sizes_.size();
+}
+
+size_t SizeClassTable::roundUp(size_t size) const {
+    size_t index = classIndex(size);
+    return index < class_sizes_.size() ? class_sizes_[index] : 0;
+}
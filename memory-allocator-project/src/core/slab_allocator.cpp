@@ -1,32 +1,38 @@
 #include "../includes/slab_allocator.h"
 #include <cstring>
 #include <algorithm>
+#include <cassert>
+#include <stdexcept>
 
-SlabAllocator::SlabAllocator(size_t object_size, size_t objects_per_slab, size_t total_memory) 
-    : MemoryAllocator(total_memory), object_size_(object_size), objects_per_slab_(objects_per_slab) {
+SlabAllocator::SlabAllocator(size_t object_size, size_t objects_per_slab, size_t total_memory, void* memory) 
+    : MemoryAllocator(total_memory), object_size_(alignObjectSize(object_size)), objects_per_slab_(objects_per_slab),
+      owns_memory_(memory == nullptr) {
     // Calculate slab size (object size * objects per slab + metadata)
-    slab_size_ = object_size * objects_per_slab + sizeof(SlabHeader);
+    slab_size_ = getSlabSize(object_size, objects_per_slab);
     
-    // Calculate how many slabs we can fit in total memory
+    // Calculate how many slabs we can fit in total memory (zero if not even one fits)
     max_slabs_ = total_memory / slab_size_;
-    if (max_slabs_ == 0) max_slabs_ = 1;
     
-    // Initialize memory
-    memory_pool_ = new char[total_memory];
-    std::memset(memory_pool_, 0, total_memory);
+    // Reserve memory; slabs are initialized lazily so untouched pages stay uncommitted
+    memory_pool_ = owns_memory_ ? new char[total_memory] : static_cast<char*>(memory);
     
     // Create initial slab
     createSlab();
 }
 
 SlabAllocator::~SlabAllocator() {
-    delete[] memory_pool_;
+    if (owns_memory_) {
+        delete[] memory_pool_;
+    }
 }
 
 void* SlabAllocator::allocate(size_t size) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
     
     if (size > object_size_) {
+        counters_.recordFailure();
         return nullptr; // Size too large for this slab allocator
     }
     
@@ -35,8 +41,7 @@ void* SlabAllocator::allocate(size_t size) {
         if (slab.free_objects > 0) {
             void* ptr = allocateFromSlab(slab);
             if (ptr) {
-                allocated_size_ += object_size_;
-                allocation_count_++;
+                counters_.recordAllocation(object_size_);
                 return ptr;
             }
         }
@@ -48,37 +53,145 @@ void* SlabAllocator::allocate(size_t size) {
         if (!slabs_.empty()) {
             void* ptr = allocateFromSlab(slabs_.back());
             if (ptr) {
-                allocated_size_ += object_size_;
-                allocation_count_++;
+                counters_.recordAllocation(object_size_);
                 return ptr;
             }
         }
     }
     
+    counters_.recordFailure();
     return nullptr; // Out of memory
 }
 
-void SlabAllocator::deallocate(void* ptr) {
-    if (!ptr) return;
+bool SlabAllocator::release(void* ptr) {
+    if (!ptr) return false;
+    
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    if (remote_frees_.isRemote()) {
+        if (!isObjectAddress(ptr)) return false; // push() writes into the object
+        remote_frees_.push(ptr);
+        return true;
+    }
     
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
-    // Find which slab this pointer belongs to
-    for (auto& slab : slabs_) {
-        char* slab_start = memory_pool_ + slab.offset + sizeof(SlabHeader);
-        char* slab_end = slab_start + (object_size_ * objects_per_slab_);
+    SlabInfo* slab = findSlabForAddress(ptr);
+    if (!slab || !deallocateFromSlab(*slab, ptr)) {
+        return false; // Foreign pointer or double free
+    }
+    counters_.recordDeallocation(object_size_);
+    return true;
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size) {
+    (void)size;
+    assert(size <= object_size_ && "SlabAllocator: deallocate size does not match the allocation");
+    release(ptr);
+}
+
+size_t SlabAllocator::allocate_batch(size_t size, size_t count, void** out) {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
+    
+    if (size > object_size_) {
+        counters_.recordFailure(StatsCounters::kNoClass, count);
+        return 0;
+    }
+    
+    size_t allocated = 0;
+    size_t slab_index = 0;
+    while (allocated < count) {
+        // Drain existing slabs first, then grow
+        while (slab_index < slabs_.size() && slabs_[slab_index].free_objects == 0) {
+            ++slab_index;
+        }
+        if (slab_index == slabs_.size()) {
+            if (slabs_.size() >= max_slabs_) break;
+            createSlab();
+        }
         
-        if (ptr >= slab_start && ptr < slab_end) {
-            deallocateFromSlab(slab, ptr);
-            allocated_size_ -= object_size_;
-            deallocation_count_++;
-            return;
+        SlabInfo& slab = slabs_[slab_index];
+        while (allocated < count && slab.free_objects > 0) {
+            out[allocated++] = allocateFromSlab(slab);
         }
     }
+    
+    counters_.recordAllocation(allocated * object_size_, StatsCounters::kNoClass, allocated);
+    if (allocated < count) counters_.recordFailure(StatsCounters::kNoClass, count - allocated);
+    return allocated;
+}
+
+void SlabAllocator::deallocate_batch(void* const* ptrs, size_t count) {
+    if (remote_frees_.isRemote()) {
+        for (size_t i = 0; i < count; ++i) {
+            if (ptrs[i] && isObjectAddress(ptrs[i])) remote_frees_.push(ptrs[i]);
+        }
+        return;
+    }
+    
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    
+    for (size_t i = 0; i < count; ++i) {
+        if (!ptrs[i]) continue;
+        
+        SlabInfo* slab = findSlabForAddress(ptrs[i]);
+        if (slab && deallocateFromSlab(*slab, ptrs[i])) {
+            counters_.recordDeallocation(object_size_);
+        }
+    }
+}
+
+void SlabAllocator::drainRemoteFrees() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
+}
+
+void SlabAllocator::drainRemoteFreesLocked() {
+    RemoteFreeList::Node* node = remote_frees_.takeAll();
+    
+    // A double free makes the chain loop; it is walked only up to the repeat
+    for (size_t count = RemoteFreeList::distinctLength(node); count > 0; --count) {
+        RemoteFreeList::Node* next = node->next;
+        SlabInfo* slab = findSlabForAddress(node);
+        if (slab && deallocateFromSlab(*slab, node)) {
+            counters_.recordDeallocation(object_size_);
+        }
+        node = next; // A double free, or an object of a slab not carved yet, is skipped
+    }
+}
+
+bool SlabAllocator::isObjectAddress(void* ptr) const {
+    // Read without the lock; the region only changes in reset(), retire() and reinitialize()
+    char* address = static_cast<char*>(ptr);
+    if (address < memory_pool_) return false;
+    
+    size_t offset = static_cast<size_t>(address - memory_pool_);
+    if (offset >= max_slabs_ * slab_size_) return false;
+    
+    size_t object_offset = offset % slab_size_;
+    return object_offset >= sizeof(SlabHeader) && (object_offset - sizeof(SlabHeader)) % object_size_ == 0;
+}
+
+SlabAllocator::SlabInfo* SlabAllocator::findSlabForAddress(void* ptr) {
+    // Slabs are laid out back to back, so the owning slab follows from the offset
+    char* address = static_cast<char*>(ptr);
+    if (address < memory_pool_) return nullptr;
+    
+    size_t offset = static_cast<size_t>(address - memory_pool_);
+    size_t index = offset / slab_size_;
+    if (index >= slabs_.size()) return nullptr;
+    
+    size_t object_offset = offset - index * slab_size_;
+    if (object_offset < sizeof(SlabHeader) ||
+        (object_offset - sizeof(SlabHeader)) % object_size_ != 0) {
+        return nullptr;
+    }
+    
+    return &slabs_[index];
 }
 
 size_t SlabAllocator::getFragmentation() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
     if (slabs_.empty()) return 0;
     
@@ -97,9 +210,11 @@ size_t SlabAllocator::getFragmentation() const {
 }
 
 std::string SlabAllocator::getStats() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
+    // Base stats call getFragmentation(), which takes the lock itself
     std::string stats = MemoryAllocator::getStats();
+    
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    
     stats += "Slab Allocator Stats:\n";
     stats += "  Object Size: " + std::to_string(object_size_) + " bytes\n";
     stats += "  Objects per Slab: " + std::to_string(objects_per_slab_) + "\n";
@@ -112,6 +227,9 @@ std::string SlabAllocator::getStats() const {
         total_free_objects += slab.free_objects;
     }
     stats += "  Free Objects: " + std::to_string(total_free_objects) + "\n";
+    if (remote_frees_.getPushed() > 0) {
+        stats += "  Remote Frees: " + std::to_string(remote_frees_.getPushed()) + "\n";
+    }
     
     return stats;
 }
@@ -122,24 +240,22 @@ void SlabAllocator::createSlab() {
     SlabInfo slab;
     slab.offset = slabs_.size() * slab_size_;
     slab.free_objects = objects_per_slab_;
+    slab.carved_objects = 0;
     
-    // Initialize slab header
+    // Initialize slab header - the free list only holds freed objects,
+    // never-used objects are carved from the bump index on demand
     SlabHeader* header = reinterpret_cast<SlabHeader*>(memory_pool_ + slab.offset);
     header->free_count = objects_per_slab_;
-    header->first_free = 0;
-    
-    // Initialize free list - each object contains index to next free object
-    char* objects_start = memory_pool_ + slab.offset + sizeof(SlabHeader);
-    for (size_t i = 0; i < objects_per_slab_ - 1; ++i) {
-        size_t* next_ptr = reinterpret_cast<size_t*>(objects_start + i * object_size_);
-        *next_ptr = i + 1;
-    }
-    
-    // Last object points to invalid index
-    size_t* last_ptr = reinterpret_cast<size_t*>(objects_start + (objects_per_slab_ - 1) * object_size_);
-    *last_ptr = static_cast<size_t>(-1);
+    header->first_free = static_cast<size_t>(-1);
     
     slabs_.push_back(slab);
+    occupancy_.resize((slabs_.size() * objects_per_slab_ + 63) / 64, 0);
+}
+
+size_t SlabAllocator::objectIndex(const SlabInfo& slab, void* ptr) const {
+    const char* objects_start = memory_pool_ + slab.offset + sizeof(SlabHeader);
+    size_t slab_index = slab.offset / slab_size_;
+    return slab_index * objects_per_slab_ + static_cast<size_t>(static_cast<char*>(ptr) - objects_start) / object_size_;
 }
 
 void* SlabAllocator::allocateFromSlab(SlabInfo& slab) {
@@ -148,16 +264,26 @@ void* SlabAllocator::allocateFromSlab(SlabInfo& slab) {
     SlabHeader* header = reinterpret_cast<SlabHeader*>(memory_pool_ + slab.offset);
     if (header->free_count == 0) return nullptr;
     
-    // Get first free object
-    size_t free_index = header->first_free;
     char* objects_start = memory_pool_ + slab.offset + sizeof(SlabHeader);
-    void* ptr = objects_start + free_index * object_size_;
+    void* ptr = nullptr;
+    
+    if (header->first_free != static_cast<size_t>(-1)) {
+        // Reuse first freed object
+        ptr = objects_start + header->first_free * object_size_;
+        size_t* next_ptr = reinterpret_cast<size_t*>(ptr);
+        header->first_free = *next_ptr;
+    } else if (slab.carved_objects < objects_per_slab_) {
+        // Carve a never-used object
+        ptr = objects_start + slab.carved_objects * object_size_;
+        slab.carved_objects++;
+    } else {
+        return nullptr;
+    }
     
-    // Update free list
-    size_t* next_ptr = reinterpret_cast<size_t*>(ptr);
-    header->first_free = *next_ptr;
     header->free_count--;
     slab.free_objects--;
+    size_t index = objectIndex(slab, ptr);
+    occupancy_[index / 64] |= uint64_t(1) << (index % 64);
     
     // Clear the allocated memory
     std::memset(ptr, 0, object_size_);
@@ -165,12 +291,17 @@ void* SlabAllocator::allocateFromSlab(SlabInfo& slab) {
     return ptr;
 }
 
-void SlabAllocator::deallocateFromSlab(SlabInfo& slab, void* ptr) {
+bool SlabAllocator::deallocateFromSlab(SlabInfo& slab, void* ptr) {
     SlabHeader* header = reinterpret_cast<SlabHeader*>(memory_pool_ + slab.offset);
     char* objects_start = memory_pool_ + slab.offset + sizeof(SlabHeader);
     
     // Calculate object index
     size_t index = (static_cast<char*>(ptr) - objects_start) / object_size_;
+    size_t bit = objectIndex(slab, ptr);
+    if (!((occupancy_[bit / 64] >> (bit % 64)) & 1)) {
+        return false; // Not allocated: a double free would corrupt the free list
+    }
+    occupancy_[bit / 64] &= ~(uint64_t(1) << (bit % 64));
     
     // Add to free list
     size_t* next_ptr = reinterpret_cast<size_t*>(ptr);
@@ -178,10 +309,58 @@ void SlabAllocator::deallocateFromSlab(SlabInfo& slab, void* ptr) {
     header->first_free = index;
     header->free_count++;
     slab.free_objects++;
+    return true;
+}
+
+void SlabAllocator::reset() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    
+    // Slabs are re-carved from the start of the region; queued frees are moot
+    remote_frees_.takeAll();
+    slabs_.clear();
+    occupancy_.clear();
+    max_slabs_ = total_memory_ / slab_size_;
+    createSlab();
+    
+    // Reset statistics
+    counters_.reset();
+    latency_.reset();
+}
+
+void SlabAllocator::reinitialize(void* memory, size_t total_memory) {
+    if (owns_memory_ || !memory) {
+        throw std::invalid_argument("reinitialize needs a caller-owned region");
+    }
+    
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    remote_frees_.takeAll();
+    slabs_.clear();
+    occupancy_.clear();
+    memory_pool_ = static_cast<char*>(memory);
+    total_memory_ = total_memory;
+    max_slabs_ = total_memory / slab_size_;
+    createSlab();
+    counters_.reset();
+    latency_.reset();
+}
+
+bool SlabAllocator::retire() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    drainRemoteFreesLocked();
+    
+    if (getAllocatedSize() != 0) {
+        return false;
+    }
+    
+    // No slabs and no room for new ones: the region is no longer touched
+    slabs_.clear();
+    occupancy_.clear();
+    max_slabs_ = 0;
+    return true;
 }
 
 std::vector<MemoryAllocator::MemoryBlock> SlabAllocator::getMemoryLayout() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::lock_guard<ContendedMutex> lock(mutex_);
     
     std::vector<MemoryAllocator::MemoryBlock> layout;
     
@@ -213,7 +392,7 @@ std::vector<MemoryAllocator::MemoryBlock> SlabAllocator::getMemoryLayout() const
             MemoryBlock object_block;
             object_block.address = slab.offset + sizeof(SlabHeader) + j * object_size_;
             object_block.size = object_size_;
-            object_block.is_free = free_indices.count(j) > 0;
+            object_block.is_free = j >= slab.carved_objects || free_indices.count(j) > 0;
             object_block.type = object_block.is_free ? "Free Object" : "Allocated Object";
             layout.push_back(object_block);
         }
@@ -0,0 +1,142 @@
+#include "../includes/stack_allocator.h"
+#include "../includes/os_memory.h"
+#include <sstream>
+#include <stdexcept>
+
+StackAllocator::StackAllocator(size_t total_memory)
+    : MemoryAllocator(total_memory), memory_(nullptr), mapped_size_(os_round_to_pages(total_memory ? total_memory : 1)),
+      bottom_{0, 0, 0}, top_{total_memory, 0, 0} {
+    memory_ = static_cast<char*>(os_map_pages(mapped_size_));
+    if (!memory_) {
+        throw std::runtime_error("Failed to map stack allocator memory");
+    }
+}
+
+StackAllocator::~StackAllocator() {
+    os_unmap_pages(memory_, mapped_size_);
+}
+
+void* StackAllocator::allocate(size_t size, End end, size_t alignment) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || size > total_memory_) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Alignment is of the address, the region itself is page aligned
+    size_t offset;
+    if (end == End::BOTTOM) {
+        offset = (bottom_.offset + alignment - 1) & ~(alignment - 1);
+        if (offset > top_.offset || size > top_.offset - offset) {
+            counters_.recordFailure();
+            return nullptr;
+        }
+        bottom_.offset = offset + size;
+    } else {
+        if (size > top_.offset - bottom_.offset) {
+            counters_.recordFailure();
+            return nullptr;
+        }
+        offset = (top_.offset - size) & ~(alignment - 1);
+        if (offset < bottom_.offset) {
+            counters_.recordFailure();
+            return nullptr;
+        }
+        top_.offset = offset;
+    }
+
+    Stack& s = stack(end);
+    ++s.allocations;
+    s.bytes += size;
+    counters_.recordAllocation(size);
+    return memory_ + offset;
+}
+
+StackAllocator::Marker StackAllocator::getMarker(End end) const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    const Stack& s = stack(end);
+    return {end, s.offset, s.allocations, s.bytes};
+}
+
+void StackAllocator::popTo(End end, const Stack& target) {
+    Stack& s = stack(end);
+    size_t allocations = s.allocations - target.allocations;
+    if (allocations > 0) {
+        counters_.recordDeallocation(s.bytes - target.bytes, StatsCounters::kNoClass, allocations);
+    }
+    s = target;
+}
+
+void StackAllocator::freeToMarker(const Marker& marker) {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // A marker taken before a pop or reset below it no longer describes this stack
+    const Stack& s = stack(marker.end);
+    bool above = marker.end == End::BOTTOM ? marker.offset > s.offset : marker.offset < s.offset;
+    if (above || marker.allocations > s.allocations || marker.bytes > s.bytes) {
+        throw std::invalid_argument("Marker is above the current top of the stack");
+    }
+    popTo(marker.end, {marker.offset, marker.allocations, marker.bytes});
+}
+
+void StackAllocator::clear(End end) {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    popTo(end, {end == End::BOTTOM ? 0 : total_memory_, 0, 0});
+}
+
+void StackAllocator::reset() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    popTo(End::BOTTOM, {0, 0, 0});
+    popTo(End::TOP, {total_memory_, 0, 0});
+}
+
+size_t StackAllocator::getUsed(End end) const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return end == End::BOTTOM ? bottom_.offset : total_memory_ - top_.offset;
+}
+
+size_t StackAllocator::getRemaining() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return top_.offset - bottom_.offset;
+}
+
+size_t StackAllocator::getFragmentation() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Alignment padding relative to what both ends consume
+    size_t consumed = bottom_.offset + (total_memory_ - top_.offset);
+    size_t requested = bottom_.bytes + top_.bytes;
+    return consumed ? (consumed - requested) * 100 / consumed : 0;
+}
+
+std::string StackAllocator::getStats() const {
+    // Base stats call getFragmentation(), which takes the lock itself
+    std::string stats = MemoryAllocator::getStats();
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    std::ostringstream oss;
+    oss << "Stack Allocator Stats:\n";
+    oss << "  Bottom: " << bottom_.offset << " bytes (" << bottom_.allocations << " allocations)\n";
+    oss << "  Top: " << total_memory_ - top_.offset << " bytes (" << top_.allocations << " allocations)\n";
+    oss << "  Remaining: " << top_.offset - bottom_.offset << " bytes\n";
+    return stats + oss.str();
+}
+
+std::vector<MemoryAllocator::MemoryBlock> StackAllocator::getMemoryLayout() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    std::vector<MemoryAllocator::MemoryBlock> layout;
+    if (bottom_.offset > 0) {
+        layout.push_back({0, bottom_.offset, false, "Stack Bottom"});
+    }
+    if (top_.offset > bottom_.offset) {
+        layout.push_back({bottom_.offset, top_.offset - bottom_.offset, true, "Stack Free"});
+    }
+    if (top_.offset < total_memory_) {
+        layout.push_back({top_.offset, total_memory_ - top_.offset, false, "Stack Top"});
+    }
+    return layout;
+}
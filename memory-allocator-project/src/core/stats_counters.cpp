@@ -0,0 +1,226 @@
+#include "../includes/stats_counters.h"
+#include <algorithm>
+
+namespace {
+
+static_assert(StatsCounters::kShards <= 64, "shard ownership is one bit per shard");
+
+constexpr size_t kUnassigned = StatsCounters::kShards;
+
+// Bit i set: shard i belongs to a live thread. The last shard is never handed out.
+std::atomic<uint64_t> owned_shards{0};
+
+// Trivially destructible, so it is still readable after the lease below is gone
+thread_local size_t thread_shard = kUnassigned;
+
+struct ShardLease {
+    size_t shard = kUnassigned;
+
+    ~ShardLease() {
+        if (shard != kUnassigned) {
+            owned_shards.fetch_and(~(uint64_t(1) << shard), std::memory_order_release);
+        }
+        // Frees made by later thread-exit destructors go to the shared shard
+        thread_shard = StatsCounters::kShards - 1;
+    }
+};
+
+thread_local ShardLease lease;
+
+size_t acquireShard() {
+    uint64_t owned = owned_shards.load(std::memory_order_relaxed);
+    for (;;) {
+        size_t shard = 0;
+        while (shard < StatsCounters::kShards - 1 && (owned & (uint64_t(1) << shard))) ++shard;
+        if (shard == StatsCounters::kShards - 1) {
+            return shard; // All taken: share the last one
+        }
+        if (owned_shards.compare_exchange_weak(owned, owned | (uint64_t(1) << shard),
+                                               std::memory_order_acquire, std::memory_order_relaxed)) {
+            lease.shard = shard;
+            return shard;
+        }
+    }
+}
+
+// The owner is the only writer of an exclusive shard, so load + store cannot lose updates
+template<typename T>
+T add(std::atomic<T>& counter, T value, bool exclusive) {
+    if (exclusive) {
+        T next = counter.load(std::memory_order_relaxed) + value;
+        counter.store(next, std::memory_order_relaxed);
+        return next;
+    }
+    return counter.fetch_add(value, std::memory_order_relaxed) + value;
+}
+
+} // namespace
+
+StatsCounters::StatsCounters(size_t class_count)
+    : shards_(new Shard[kShards]), class_count_(0), lines_per_shard_(0) {
+    setClassCount(class_count);
+}
+
+void StatsCounters::setClassCount(size_t class_count) {
+    class_count_ = class_count;
+    lines_per_shard_ = (class_count + 1) / 2;
+    class_lines_.reset(lines_per_shard_ ? new ClassLine[kShards * lines_per_shard_] : nullptr);
+}
+
+void StatsCounters::reset() {
+    for (size_t s = 0; s < kShards; ++s) {
+        Shard& shard = shards_[s];
+        shard.bytes_allocated = 0;
+        shard.bytes_freed = 0;
+        shard.allocations = 0;
+        shard.deallocations = 0;
+        shard.failures = 0;
+        shard.pending = 0;
+        shard.pending_peak = 0;
+    }
+    published_ = 0;
+    peak_ = 0;
+    setClassCount(class_count_);
+}
+
+size_t StatsCounters::shardIndex() {
+    if (thread_shard == kUnassigned) {
+        thread_shard = acquireShard();
+    }
+    return thread_shard;
+}
+
+StatsCounters::ClassCounters* StatsCounters::classCounters(size_t shard, size_t size_class) const {
+    if (size_class >= class_count_) return nullptr;
+    return &class_lines_[shard * lines_per_shard_ + size_class / 2].counters[size_class % 2];
+}
+
+void StatsCounters::recordAllocation(size_t bytes, size_t size_class, size_t count) {
+    size_t index = shardIndex();
+    bool exclusive = index != kSharedShard;
+    Shard& shard = shards_[index];
+    add(shard.bytes_allocated, bytes, exclusive);
+    add(shard.allocations, count, exclusive);
+    addPending(shard, static_cast<int64_t>(bytes), exclusive);
+
+    if (ClassCounters* counters = classCounters(index, size_class)) {
+        add(counters->bytes_allocated, bytes, exclusive);
+        add(counters->allocations, count, exclusive);
+    }
+}
+
+void StatsCounters::recordDeallocation(size_t bytes, size_t size_class, size_t count) {
+    size_t index = shardIndex();
+    bool exclusive = index != kSharedShard;
+    Shard& shard = shards_[index];
+    add(shard.bytes_freed, bytes, exclusive);
+    add(shard.deallocations, count, exclusive);
+    addPending(shard, -static_cast<int64_t>(bytes), exclusive);
+
+    if (ClassCounters* counters = classCounters(index, size_class)) {
+        add(counters->deallocations, count, exclusive);
+    }
+}
+
+void StatsCounters::recordFailure(size_t size_class, size_t count) {
+    size_t index = shardIndex();
+    bool exclusive = index != kSharedShard;
+    add(shards_[index].failures, count, exclusive);
+
+    if (ClassCounters* counters = classCounters(index, size_class)) {
+        add(counters->failures, count, exclusive);
+    }
+}
+
+void StatsCounters::recordResize(size_t old_bytes, size_t new_bytes, size_t size_class) {
+    size_t index = shardIndex();
+    bool exclusive = index != kSharedShard;
+    Shard& shard = shards_[index];
+    add(shard.bytes_allocated, new_bytes, exclusive);
+    add(shard.bytes_freed, old_bytes, exclusive);
+    addPending(shard, static_cast<int64_t>(new_bytes) - static_cast<int64_t>(old_bytes), exclusive);
+
+    if (ClassCounters* counters = classCounters(index, size_class)) {
+        add(counters->bytes_allocated, new_bytes, exclusive);
+    }
+}
+
+void StatsCounters::addPending(Shard& shard, int64_t bytes, bool exclusive) {
+    int64_t pending = add(shard.pending, bytes, exclusive);
+    if (pending > shard.pending_peak.load(std::memory_order_relaxed)) {
+        shard.pending_peak.store(pending, std::memory_order_relaxed);
+    }
+    if (pending >= kPeakBatch || pending <= -kPeakBatch) {
+        publish(shard);
+    }
+}
+
+void StatsCounters::publish(Shard& shard) {
+    int64_t pending_peak = shard.pending_peak.exchange(0, std::memory_order_relaxed);
+    int64_t pending = shard.pending.exchange(0, std::memory_order_relaxed);
+    int64_t before = published_.fetch_add(pending, std::memory_order_relaxed);
+
+    int64_t candidate = before + std::max(pending_peak, pending);
+    int64_t peak = peak_.load(std::memory_order_relaxed);
+    while (candidate > peak && !peak_.compare_exchange_weak(peak, candidate, std::memory_order_relaxed)) {
+    }
+}
+
+StatsCounters::Snapshot StatsCounters::snapshot() const {
+    Snapshot result;
+    int64_t peak_candidate = published_.load(std::memory_order_relaxed);
+
+    for (size_t s = 0; s < kShards; ++s) {
+        const Shard& shard = shards_[s];
+        result.bytes_allocated += shard.bytes_allocated.load(std::memory_order_relaxed);
+        result.bytes_freed += shard.bytes_freed.load(std::memory_order_relaxed);
+        result.allocations += shard.allocations.load(std::memory_order_relaxed);
+        result.deallocations += shard.deallocations.load(std::memory_order_relaxed);
+        result.failures += shard.failures.load(std::memory_order_relaxed);
+        peak_candidate += std::max<int64_t>(shard.pending_peak.load(std::memory_order_relaxed), 0);
+    }
+
+    // A free can be counted before its allocation when threads race the read
+    result.current_bytes = result.bytes_allocated > result.bytes_freed ? result.bytes_allocated - result.bytes_freed : 0;
+    int64_t peak = std::max(peak_.load(std::memory_order_relaxed), peak_candidate);
+    result.peak_bytes = std::max(static_cast<size_t>(std::max<int64_t>(peak, 0)), result.current_bytes);
+    return result;
+}
+
+StatsCounters::ClassSnapshot StatsCounters::classSnapshot(size_t size_class) const {
+    ClassSnapshot result;
+    for (size_t s = 0; s < kShards; ++s) {
+        const ClassCounters* counters = classCounters(s, size_class);
+        if (!counters) break;
+        result.bytes_allocated += counters->bytes_allocated.load(std::memory_order_relaxed);
+        result.allocations += counters->allocations.load(std::memory_order_relaxed);
+        result.deallocations += counters->deallocations.load(std::memory_order_relaxed);
+        result.failures += counters->failures.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+size_t StatsCounters::currentBytes() const {
+    size_t allocated = 0, freed = 0;
+    for (size_t s = 0; s < kShards; ++s) {
+        allocated += shards_[s].bytes_allocated.load(std::memory_order_relaxed);
+        freed += shards_[s].bytes_freed.load(std::memory_order_relaxed);
+    }
+    return allocated > freed ? allocated - freed : 0;
+}
+
+size_t StatsCounters::allocations() const {
+    size_t total = 0;
+    for (size_t s = 0; s < kShards; ++s) {
+        total += shards_[s].allocations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t StatsCounters::deallocations() const {
+    size_t total = 0;
+    for (size_t s = 0; s < kShards; ++s) {
+        total += shards_[s].deallocations.load(std::memory_order_relaxed);
+    }
+    return total;
+}
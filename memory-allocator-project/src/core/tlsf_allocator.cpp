@@ -0,0 +1,347 @@
+#include "../includes/tlsf_allocator.h"
+#include "../includes/os_memory.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// Index of the highest set bit; value must not be 0
+inline size_t highestBit(size_t value) {
+    return 63 - static_cast<size_t>(__builtin_clzll(value));
+}
+}
+
+TlsfAllocator::TlsfAllocator(size_t total_memory)
+    : MemoryAllocator(total_memory), memory_(nullptr), mapped_size_(0), usable_size_(0), sentinel_(nullptr),
+      fl_bitmap_(0), free_blocks_(0), free_bytes_(0), splits_(0), merges_(0) {
+    if (total_memory < 2 * kHeaderSize + kMinBlockSize + kAlignment || total_memory > kMaxBlockSize) {
+        throw std::invalid_argument("TLSF region size out of range");
+    }
+
+    mapped_size_ = os_round_to_pages(total_memory);
+    memory_ = static_cast<char*>(os_map_pages(mapped_size_));
+    if (!memory_) {
+        throw std::runtime_error("Failed to map TLSF memory");
+    }
+    usable_size_ = (total_memory & ~(kAlignment - 1)) - kHeaderSize;
+    format();
+}
+
+TlsfAllocator::~TlsfAllocator() {
+    os_unmap_pages(memory_, mapped_size_);
+}
+
+TlsfAllocator::Block* TlsfAllocator::nextPhys(const Block* block) {
+    return reinterpret_cast<Block*>(static_cast<char*>(payload(block)) + blockSize(block));
+}
+
+void* TlsfAllocator::payload(const Block* block) {
+    return const_cast<char*>(reinterpret_cast<const char*>(block)) + kHeaderSize;
+}
+
+void TlsfAllocator::mappingInsert(size_t size, size_t& fl, size_t& sl) {
+    if (size < kSmallBlockSize) {
+        // Linear below 512 bytes: one list per 16-byte size
+        fl = 0;
+        sl = size / (kSmallBlockSize / kSlIndexCount);
+    } else {
+        size_t bit = highestBit(size);
+        sl = (size >> (bit - kSlIndexCountLog2)) ^ kSlIndexCount;
+        fl = bit - (kFlIndexShift - 1);
+    }
+}
+
+void TlsfAllocator::format() {
+    // One free block spanning the region, then the sentinel
+    std::memset(sl_bitmap_, 0, sizeof(sl_bitmap_));
+    std::memset(free_lists_, 0, sizeof(free_lists_));
+    fl_bitmap_ = 0;
+    free_blocks_ = 0;
+    free_bytes_ = 0;
+
+    Block* first = reinterpret_cast<Block*>(memory_);
+    first->prev_phys = nullptr;
+    first->size = (usable_size_ - kHeaderSize) | kFreeBit;
+
+    sentinel_ = nextPhys(first);
+    sentinel_->prev_phys = first;
+    sentinel_->size = 0;
+
+    insertFree(first);
+}
+
+void TlsfAllocator::insertFree(Block* block) {
+    size_t fl, sl;
+    mappingInsert(blockSize(block), fl, sl);
+
+    Block* head = free_lists_[fl][sl];
+    block->next_free = head;
+    block->prev_free = nullptr;
+    if (head) head->prev_free = block;
+    free_lists_[fl][sl] = block;
+
+    fl_bitmap_ |= uint32_t(1) << fl;
+    sl_bitmap_[fl] |= uint32_t(1) << sl;
+    ++free_blocks_;
+    free_bytes_ += blockSize(block);
+}
+
+void TlsfAllocator::removeFree(Block* block) {
+    size_t fl, sl;
+    mappingInsert(blockSize(block), fl, sl);
+
+    if (block->prev_free) block->prev_free->next_free = block->next_free;
+    else free_lists_[fl][sl] = block->next_free;
+    if (block->next_free) block->next_free->prev_free = block->prev_free;
+
+    if (!free_lists_[fl][sl]) {
+        sl_bitmap_[fl] &= ~(uint32_t(1) << sl);
+        if (!sl_bitmap_[fl]) fl_bitmap_ &= ~(uint32_t(1) << fl);
+    }
+    --free_blocks_;
+    free_bytes_ -= blockSize(block);
+}
+
+TlsfAllocator::Block* TlsfAllocator::findFree(size_t size, size_t& fl) {
+    size_t request = size, exact_fl, exact_sl;
+    mappingInsert(request, exact_fl, exact_sl);
+
+    // Round up to the next list boundary, so any block in the list found fits
+    if (size >= kSmallBlockSize) {
+        size += (size_t(1) << (highestBit(size) - kSlIndexCountLog2)) - 1;
+    }
+    size_t sl;
+    mappingInsert(size, fl, sl);
+
+    // Same first level, this second-level list or a larger one
+    uint32_t sl_map = fl < kFlIndexCount ? sl_bitmap_[fl] & (~uint32_t(0) << sl) : 0;
+    if (!sl_map) {
+        // Otherwise the smallest non-empty larger first level
+        uint32_t fl_map = fl + 1 < kFlIndexCount ? fl_bitmap_ & (~uint32_t(0) << (fl + 1)) : 0;
+        if (!fl_map) {
+            // Last resort, still O(1): the first block of the request's own list may fit
+            fl = exact_fl;
+            Block* head = free_lists_[exact_fl][exact_sl];
+            return head && blockSize(head) >= request ? head : nullptr;
+        }
+        fl = static_cast<size_t>(__builtin_ctz(fl_map));
+        sl_map = sl_bitmap_[fl];
+    }
+    sl = static_cast<size_t>(__builtin_ctz(sl_map));
+    return free_lists_[fl][sl];
+}
+
+TlsfAllocator::Block* TlsfAllocator::blockFromPointer(void* ptr) const {
+    char* p = static_cast<char*>(ptr);
+    if (p < memory_ + kHeaderSize || p >= reinterpret_cast<char*>(sentinel_) ||
+        (p - memory_) % kAlignment != 0) {
+        return nullptr;
+    }
+
+    // The boundary tags must agree: rejects double frees and most interior pointers
+    Block* block = reinterpret_cast<Block*>(p - kHeaderSize);
+    if (isFree(block) || blockSize(block) > static_cast<size_t>(reinterpret_cast<char*>(sentinel_) - p)) {
+        return nullptr;
+    }
+    Block* prev = block->prev_phys;
+    if (prev ? (reinterpret_cast<char*>(prev) < memory_ || prev >= block || nextPhys(prev) != block)
+             : block != reinterpret_cast<Block*>(memory_)) {
+        return nullptr;
+    }
+    return nextPhys(block)->prev_phys == block ? block : nullptr;
+}
+
+void* TlsfAllocator::allocate(size_t size) {
+    LatencyProbe probe(latency_, LatencyRecorder::Op::ALLOCATE);
+    if (size == 0 || size > usable_size_) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+    size = std::max((size + kAlignment - 1) & ~(kAlignment - 1), kMinBlockSize);
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    size_t fl;
+    Block* block = findFree(size, fl);
+    if (probe.active()) probe.setClass(std::min(fl, kFlIndexCount - 1));
+    if (!block) {
+        counters_.recordFailure();
+        return nullptr;
+    }
+    removeFree(block);
+
+    // Split off the tail when it can hold a block of its own
+    size_t remaining = blockSize(block) - size;
+    if (remaining >= kHeaderSize + kMinBlockSize) {
+        Block* rest = reinterpret_cast<Block*>(static_cast<char*>(payload(block)) + size);
+        rest->prev_phys = block;
+        rest->size = (remaining - kHeaderSize) | kFreeBit;
+        nextPhys(rest)->prev_phys = rest;
+        block->size = size;
+        insertFree(rest);
+        ++splits_;
+    } else {
+        block->size = blockSize(block);
+    }
+
+    counters_.recordAllocation(blockSize(block));
+    return payload(block);
+}
+
+void TlsfAllocator::deallocate(void* ptr) {
+    if (!ptr) return;
+
+    LatencyProbe probe(latency_, LatencyRecorder::Op::DEALLOCATE);
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    Block* block = blockFromPointer(ptr);
+    if (!block) {
+        return; // Foreign pointer or double free
+    }
+    size_t size = blockSize(block);
+    if (probe.active()) {
+        size_t fl, sl;
+        mappingInsert(size, fl, sl);
+        probe.setClass(fl);
+    }
+    counters_.recordDeallocation(size);
+    block->size |= kFreeBit;
+
+    // Immediate coalescing with both physical neighbours
+    Block* prev = block->prev_phys;
+    if (prev && isFree(prev)) {
+        removeFree(prev);
+        prev->size += kHeaderSize + blockSize(block);
+        block = prev;
+        nextPhys(block)->prev_phys = block;
+        ++merges_;
+    }
+    Block* next = nextPhys(block);
+    if (isFree(next)) {
+        removeFree(next);
+        block->size += kHeaderSize + blockSize(next);
+        nextPhys(block)->prev_phys = block;
+        ++merges_;
+    }
+    insertFree(block);
+}
+
+void TlsfAllocator::reset() {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    format();
+    splits_ = 0;
+    merges_ = 0;
+    counters_.reset();
+    latency_.reset();
+}
+
+size_t TlsfAllocator::getLargestFreeBlock() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    if (!fl_bitmap_) return 0;
+
+    // Only the highest non-empty list can hold it; its blocks differ within one step
+    size_t fl = highestBit(fl_bitmap_);
+    size_t sl = highestBit(sl_bitmap_[fl]);
+    size_t largest = 0;
+    for (const Block* block = free_lists_[fl][sl]; block; block = block->next_free) {
+        largest = std::max(largest, blockSize(block));
+    }
+    return largest;
+}
+
+size_t TlsfAllocator::getFreeBlockCount() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return free_blocks_;
+}
+
+size_t TlsfAllocator::getBlockSize(void* ptr) const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    Block* block = blockFromPointer(ptr);
+    return block ? blockSize(block) : 0;
+}
+
+bool TlsfAllocator::checkHeap() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Physical walk: links, no two free neighbours, totals
+    size_t free_blocks = 0, free_bytes = 0;
+    const Block* prev = nullptr;
+    const Block* block = reinterpret_cast<const Block*>(memory_);
+    while (block != sentinel_) {
+        if (block > sentinel_ || block->prev_phys != prev || blockSize(block) < kMinBlockSize ||
+            blockSize(block) % kAlignment != 0) {
+            return false;
+        }
+        if (isFree(block)) {
+            if (prev && isFree(prev)) return false;
+            ++free_blocks;
+            free_bytes += blockSize(block);
+        }
+        prev = block;
+        block = nextPhys(block);
+    }
+    if (sentinel_->prev_phys != prev || sentinel_->size != 0) {
+        return false;
+    }
+    if (free_blocks != free_blocks_ || free_bytes != free_bytes_) return false;
+
+    // Lists: bitmaps match, every block free and filed under its own size
+    size_t listed = 0;
+    for (size_t fl = 0; fl < kFlIndexCount; ++fl) {
+        if (((fl_bitmap_ >> fl) & 1) != (sl_bitmap_[fl] != 0)) return false;
+        for (size_t sl = 0; sl < kSlIndexCount; ++sl) {
+            if (((sl_bitmap_[fl] >> sl) & 1) != (free_lists_[fl][sl] != nullptr)) return false;
+            const Block* previous_free = nullptr;
+            for (const Block* entry = free_lists_[fl][sl]; entry; entry = entry->next_free) {
+                size_t entry_fl, entry_sl;
+                mappingInsert(blockSize(entry), entry_fl, entry_sl);
+                if (!isFree(entry) || entry->prev_free != previous_free || entry_fl != fl || entry_sl != sl ||
+                    ++listed > free_blocks_) {
+                    return false;
+                }
+                previous_free = entry;
+            }
+        }
+    }
+    return listed == free_blocks_;
+}
+
+size_t TlsfAllocator::getFragmentation() const {
+    // Free bytes that are not in the largest free block
+    size_t largest = getLargestFreeBlock();
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+    return free_bytes_ ? (free_bytes_ - std::min(largest, free_bytes_)) * 100 / free_bytes_ : 0;
+}
+
+std::string TlsfAllocator::getStats() const {
+    // Base stats call getFragmentation(), which takes the lock itself
+    std::string stats = MemoryAllocator::getStats();
+    size_t largest = getLargestFreeBlock();
+
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    std::ostringstream oss;
+    oss << "TLSF Allocator Stats:\n";
+    oss << "  Region: " << usable_size_ << " bytes\n";
+    oss << "  Free Blocks: " << free_blocks_ << " (" << free_bytes_ << " bytes, largest " << largest << ")\n";
+    oss << "  Splits: " << splits_ << "\n";
+    oss << "  Merges: " << merges_ << "\n";
+    return stats + oss.str();
+}
+
+std::vector<MemoryAllocator::MemoryBlock> TlsfAllocator::getMemoryLayout() const {
+    std::lock_guard<ContendedMutex> lock(mutex_);
+
+    // Sizes include the boundary tag
+    std::vector<MemoryAllocator::MemoryBlock> layout;
+    for (const Block* block = reinterpret_cast<const Block*>(memory_); block != sentinel_;
+         block = nextPhys(block)) {
+        size_t offset = static_cast<size_t>(reinterpret_cast<const char*>(block) - memory_);
+        layout.push_back({offset, kHeaderSize + blockSize(block), isFree(block),
+                          isFree(block) ? "TLSF Free" : "TLSF Used"});
+    }
+    return layout;
+}
@@ -0,0 +1,145 @@
+#ifndef ALLOCATION_TRACE_H
+#define ALLOCATION_TRACE_H
+
+#include "memory_allocator.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Binary allocation traces
+ *
+ * File layout (host byte order):
+ *   TraceFileHeader
+ *   chunks of { TraceChunkHeader, count x TraceRecord }, each from one thread in program order
+ *
+ * Timestamps are cycle_clock ticks since the trace started (the header has the
+ * tick length). Object ids are the addresses the traced allocator returned, so
+ * an id comes back once its object is freed; frees are recorded before the
+ * block is released and allocations after it is obtained, which keeps the
+ * timestamps of one address in causal order across threads.
+ */
+enum class TraceOp : uint8_t {
+    ALLOCATE = 1,
+    DEALLOCATE = 2
+};
+
+struct TraceRecord {
+    uint64_t timestamp;
+    uint64_t object_id;
+    uint64_t size;            // Requested bytes; 0 for an unsized free
+    uint32_t thread;          // Dense per trace, from 0
+    uint8_t op;               // TraceOp
+    uint8_t alignment_log2;   // 0 = the allocator's natural alignment
+    uint16_t reserved;
+};
+static_assert(sizeof(TraceRecord) == 32, "trace records are written as-is");
+
+struct TraceFileHeader {
+    char magic[8];            // kTraceMagic
+    uint32_t version;
+    uint32_t record_size;
+    double ns_per_tick;
+    uint64_t reserved;
+};
+
+struct TraceChunkHeader {
+    uint32_t thread;
+    uint32_t count;
+};
+
+constexpr char kTraceMagic[8] = {'M', 'A', 'T', 'R', 'A', 'C', 'E', '\0'};
+constexpr uint32_t kTraceVersion = 1;
+
+/**
+ * @brief Records allocator calls from any number of threads
+ *
+ * Each thread appends to its own buffer without locks; a full buffer is written
+ * out as one chunk under the file lock, once per kChunkRecords records.
+ */
+class TraceWriter {
+public:
+    static constexpr size_t kChunkRecords = 4096;
+
+    explicit TraceWriter(const std::string& path); // Throws std::runtime_error
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // alignment 0 (or up to 8) = natural; ignored after finish()
+    void recordAllocation(void* ptr, size_t size, size_t alignment = 0);
+    void recordDeallocation(void* ptr, size_t size = 0);
+
+    // Writes out every thread's buffer and closes the file. Traced threads must
+    // be stopped (or no longer calling the traced allocator) first.
+    void finish();
+    uint64_t getRecordCount() const { return recorded_.load(std::memory_order_relaxed); }
+
+private:
+    struct ThreadBuffer {
+        uint64_t owner;         // Thread token
+        uint32_t thread;
+        size_t count;
+        ThreadBuffer* next;
+        TraceRecord records[kChunkRecords];
+    };
+
+    void record(TraceOp op, void* ptr, size_t size, uint8_t alignment_log2);
+    ThreadBuffer* threadBuffer();
+    ThreadBuffer* attachThread();
+    void writeChunk(ThreadBuffer& buffer);
+
+    FILE* file_;
+    std::mutex file_mutex_;
+    std::atomic<bool> active_;
+    std::atomic<ThreadBuffer*> buffers_;   // Push-only list, freed by the destructor
+    std::atomic<uint32_t> next_thread_;
+    std::atomic<uint64_t> recorded_;
+    uint64_t serial_;                      // Tells this writer's buffers apart in thread caches
+    uint64_t start_ticks_;
+};
+
+/**
+ * @brief A whole trace in memory, sorted by timestamp
+ *
+ * Records with equal timestamps keep their per-thread program order.
+ */
+struct AllocationTrace {
+    double ns_per_tick = 1.0;
+    uint32_t thread_count = 0;
+    std::vector<TraceRecord> records;
+
+    static AllocationTrace load(const std::string& path); // Throws std::runtime_error
+};
+
+/**
+ * @brief Records every call made through it, then forwards it to another allocator
+ *
+ * Batch calls go through the base class, one recorded call per object. Statistics
+ * and layout are the wrapped allocator's; the wrapper keeps no counters of its own.
+ */
+class TracingAllocator : public MemoryAllocator {
+public:
+    TracingAllocator(MemoryAllocator& inner, TraceWriter& writer);
+
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    void deallocate(void* ptr, size_t size) override;
+
+    void reset() override { inner_.reset(); }
+    size_t getFragmentation() const override { return inner_.getFragmentation(); }
+    std::string getStats() const override { return inner_.getStats(); }
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override { return inner_.getMemoryLayout(); }
+
+    MemoryAllocator& getInner() const { return inner_; }
+
+private:
+    MemoryAllocator& inner_;
+    TraceWriter& writer_;
+};
+
+#endif // ALLOCATION_TRACE_H
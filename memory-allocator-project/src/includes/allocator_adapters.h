@@ -0,0 +1,90 @@
+#ifndef ALLOCATOR_ADAPTERS_H
+#define ALLOCATOR_ADAPTERS_H
+
+#include "memory_allocator.h"
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+
+/**
+ * @brief Standard library adapters for MemoryAllocator
+ * 
+ * - MemoryResourceAdapter: std::pmr::memory_resource, for std::pmr containers
+ * - StlAllocator<T>: stateful allocator for containers taking an Allocator parameter
+ * 
+ * Every allocator guarantees kNaturalAlignment; stricter alignments are met by
+ * over-allocating and keeping the original pointer just below the aligned block.
+ * The adapter does not own the allocator, which must outlive the containers.
+ */
+namespace allocator_adapters {
+
+constexpr size_t kNaturalAlignment = MemoryAllocator::kMinAlignment; // Pool and slab round their sizes to it
+
+// nullptr when the allocator is out of memory
+void* allocateAligned(MemoryAllocator& allocator, size_t bytes, size_t alignment);
+void deallocateAligned(MemoryAllocator& allocator, void* ptr, size_t bytes, size_t alignment);
+
+} // namespace allocator_adapters
+
+class MemoryResourceAdapter : public std::pmr::memory_resource {
+public:
+    explicit MemoryResourceAdapter(MemoryAllocator& allocator) : allocator_(&allocator) {}
+
+    MemoryAllocator* getAllocator() const { return allocator_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;     // Throws std::bad_alloc
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+private:
+    MemoryAllocator* allocator_;
+};
+
+template <typename T>
+class StlAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    explicit StlAllocator(MemoryAllocator& allocator) noexcept : allocator_(&allocator) {}
+
+    template <typename U>
+    StlAllocator(const StlAllocator<U>& other) noexcept : allocator_(other.getAllocator()) {}
+
+    T* allocate(size_t n) {
+        if (n > static_cast<size_t>(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        void* ptr = allocator_adapters::allocateAligned(*allocator_, n * sizeof(T), alignof(T));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        allocator_adapters::deallocateAligned(*allocator_, ptr, n * sizeof(T), alignof(T));
+    }
+
+    MemoryAllocator* getAllocator() const noexcept { return allocator_; }
+
+private:
+    MemoryAllocator* allocator_;
+};
+
+template <typename T, typename U>
+bool operator==(const StlAllocator<T>& a, const StlAllocator<U>& b) noexcept {
+    return a.getAllocator() == b.getAllocator();
+}
+
+template <typename T, typename U>
+bool operator!=(const StlAllocator<T>& a, const StlAllocator<U>& b) noexcept {
+    return !(a == b);
+}
+
+#endif // ALLOCATOR_ADAPTERS_H
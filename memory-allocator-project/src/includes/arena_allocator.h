@@ -0,0 +1,69 @@
+#ifndef ARENA_ALLOCATOR_H
+#define ARENA_ALLOCATOR_H
+
+#include "memory_allocator.h"
+#include "contended_mutex.h"
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Monotonic (bump pointer) arena for data that dies as a group
+ *
+ * Allocation moves a pointer through the current chunk; when it runs out a new
+ * chunk is mapped and chained in front. Requests larger than a chunk get a chunk
+ * of their own. deallocate() does nothing: everything goes at once with reset(),
+ * which unmaps every chunk but the first in O(chunks) and rewinds that one, so a
+ * per-request arena reuses its memory without touching the OS.
+ */
+class ArenaAllocator : public MemoryAllocator {
+public:
+    static constexpr size_t kDefaultAlignment = 16;
+
+    // total_memory caps the bytes mapped for chunks; chunk_size is rounded up to pages
+    explicit ArenaAllocator(size_t total_memory = 1024 * 1024, size_t chunk_size = 64 * 1024);
+    ~ArenaAllocator() override;
+
+    // Core allocation methods
+    void* allocate(size_t size) override { return allocate(size, kDefaultAlignment); }
+    void* allocate(size_t size, size_t alignment); // alignment: a power of two
+    void deallocate(void* ptr) override { (void)ptr; } // Freed by reset()
+    void deallocate(void* ptr, size_t size) override { (void)ptr; (void)size; }
+    void deallocate_batch(void* const* ptrs, size_t count) override { (void)ptrs; (void)count; }
+
+    // Statistics and info
+    size_t getFragmentation() const override;
+    std::string getStats() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
+
+    // Releases every allocation; keeps the first chunk mapped
+    void reset() override;
+
+    // Arena-specific methods
+    size_t getChunkCount() const;
+    size_t getMappedBytes() const;
+    size_t getChunkSize() const { return chunk_size_; }
+
+private:
+    // At the start of every chunk
+    struct Chunk {
+        Chunk* next;                  // Older chunk
+        size_t size;                  // Mapped bytes, this header included
+    };
+
+    Chunk* mapChunk(size_t min_payload);
+    void releaseChunks(Chunk* stop);   // Unmaps the newest chunks down to stop
+
+    size_t chunk_size_;
+    Chunk* chunks_;                   // Newest first; allocations bump through chunks_
+    char* cursor_;
+    char* limit_;
+    size_t chunk_count_;
+    size_t mapped_bytes_;
+    size_t used_bytes_;               // Requested bytes since the last reset
+    size_t live_allocations_;         // Allocations since the last reset
+    size_t resets_;
+    mutable ContendedMutex mutex_;
+};
+
+#endif // ARENA_ALLOCATOR_H
@@ -4,6 +4,7 @@
 #include "memory_allocator.h"
 #include <map>
 #include <list>
+#include "contended_mutex.h"
 #include <mutex>
 
 /**
@@ -30,18 +31,31 @@ private:
         BuddyBlock(size_t s, void* addr, int lvl) 
             : size(s), is_free(true), address(addr), buddy(nullptr), 
               parent(nullptr), left_child(nullptr), right_child(nullptr), level(lvl) {}
+        ~BuddyBlock() {
+            delete left_child;
+            delete right_child;
+        }
     };
 
 public:
-    explicit BuddyAllocator(size_t initial_size = 1024 * 1024);
+    // memory: optional caller-owned region; the allocator then uses the largest
+    // power of two that fits in initial_size instead of rounding up
+    explicit BuddyAllocator(size_t initial_size = 1024 * 1024, void* memory = nullptr);
     ~BuddyAllocator() override;    // Core allocation methods
     void* allocate(size_t size) override;
-    void deallocate(void* ptr) override;
+    void deallocate(void* ptr) override { release(ptr); }
+    void deallocate(void* ptr, size_t size) override { release(ptr, size); } // Descends straight to the block's level
+    // deallocate() that reports the bytes of the block it freed (0 if ptr is not allocated)
+    size_t release(void* ptr);
+    size_t release(void* ptr, size_t size);
 
     // Statistics and info
     size_t getFragmentation() const override;
     std::string getStats() const override;
     std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override {
+        return {allocator_mutex_.getAcquisitions(), allocator_mutex_.getContended()};
+    }
     
     // Memory management
     void reset() override;
@@ -55,8 +69,12 @@ public:
     void print_buddy_tree() const;
     std::vector<std::pair<void*, size_t>> get_free_blocks() const;
     std::vector<std::pair<void*, size_t>> get_allocated_blocks() const;
+    size_t get_block_size(void* ptr) const;  // 0 if ptr is not allocated
 
 private:
+    // One latency histogram per level (level 0 = the whole region)
+    size_t getLatencyClassCount() const override { return get_level_for_size(min_block_size_) + 1; }
+    
     // Helper methods
     size_t next_power_of_2(size_t size) const;
     int get_level_for_size(size_t size) const;
@@ -65,6 +83,8 @@ private:
     void coalesce_block(BuddyBlock* block);
     BuddyBlock* get_buddy(BuddyBlock* block) const;
     BuddyBlock* find_block_by_address(void* addr) const;
+    BuddyBlock* find_block_for_size(void* addr, size_t block_size) const;
+    void release_block(BuddyBlock* block);
     
     // Tree traversal helpers
     void print_tree_recursive(BuddyBlock* node, int depth) const;
@@ -74,17 +94,16 @@ private:
 private:
     BuddyBlock* root_block_;           // Root của buddy tree
     void* memory_pool_;                // Memory pool pointer
+    bool owns_memory_;                 // False when the pool is caller-owned
     size_t min_block_size_;            // Kích thước block nhỏ nhất (thường là 32 bytes)
     size_t max_block_size_;            // Kích thước block lớn nhất (= total_size)
     
     // Free lists for different block sizes (dynamic based on splits)
+    // Allocated blocks are the non-free leaves of the tree, found by address
     std::map<int, std::list<BuddyBlock*>> free_lists_;
     
-    // Map để track allocated blocks
-    std::map<void*, BuddyBlock*> allocated_blocks_;
-    
     // Thread safety
-    mutable std::mutex allocator_mutex_;
+    mutable ContendedMutex allocator_mutex_;
     
     // Statistics
     size_t total_splits_;              // Số lần split block
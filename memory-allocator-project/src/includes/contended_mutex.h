@@ -0,0 +1,45 @@
+#ifndef CONTENDED_MUTEX_H
+#define CONTENDED_MUTEX_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief std::mutex that counts how often lock() had to wait
+ *
+ * lock() tries the lock first (the same single CAS std::mutex::lock starts
+ * with) and only blocks when that fails. Both counters are updated while the
+ * lock is held, so they need no read-modify-write; readers see relaxed values.
+ */
+class ContendedMutex {
+public:
+    void lock() {
+        bool contended = !mutex_.try_lock();
+        if (contended) mutex_.lock();
+        bump(acquisitions_);
+        if (contended) bump(contended_);
+    }
+
+    bool try_lock() {
+        if (!mutex_.try_lock()) return false;
+        bump(acquisitions_);
+        return true;
+    }
+
+    void unlock() { mutex_.unlock(); }
+
+    uint64_t getAcquisitions() const { return acquisitions_.load(std::memory_order_relaxed); }
+    uint64_t getContended() const { return contended_.load(std::memory_order_relaxed); }
+
+private:
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::mutex mutex_;
+    std::atomic<uint64_t> acquisitions_{0};
+    std::atomic<uint64_t> contended_{0};
+};
+
+#endif // CONTENDED_MUTEX_H
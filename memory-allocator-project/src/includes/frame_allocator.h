@@ -0,0 +1,65 @@
+#ifndef FRAME_ALLOCATOR_H
+#define FRAME_ALLOCATOR_H
+
+#include "memory_allocator.h"
+#include "contended_mutex.h"
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Double-buffered frame allocator: data lives exactly two frames
+ *
+ * The region is split into two halves used in turn. Allocations made during
+ * frame N come from one half and stay valid through frame N+1 (the previous
+ * frame's results, data in flight to the GPU); nextFrame() switches halves and
+ * rewinds the one it switches to, freeing frame N-1's data with one pointer reset.
+ */
+class FrameAllocator : public MemoryAllocator {
+public:
+    static constexpr size_t kDefaultAlignment = 16;
+
+    // total_memory is split evenly between the two frames
+    explicit FrameAllocator(size_t total_memory = 1024 * 1024);
+    ~FrameAllocator() override;
+
+    // Core allocation methods
+    void* allocate(size_t size) override { return allocate(size, kDefaultAlignment); }
+    void* allocate(size_t size, size_t alignment); // alignment: a power of two
+    void deallocate(void* ptr) override { (void)ptr; } // Freed two frames later
+    void deallocate(void* ptr, size_t size) override { (void)ptr; (void)size; }
+    void deallocate_batch(void* const* ptrs, size_t count) override { (void)ptrs; (void)count; }
+
+    // Statistics and info
+    size_t getFragmentation() const override;
+    std::string getStats() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
+
+    // Empties both frames
+    void reset() override;
+
+    // Frame-specific methods
+    void nextFrame();               // Call once per frame, before its allocations
+    uint64_t getFrameNumber() const;
+    size_t getFrameCapacity() const { return frame_capacity_; }
+    size_t getUsed(bool previous = false) const; // Current frame's bytes, or the previous one's
+
+private:
+    struct Frame {
+        size_t offset;              // Bump position within the half
+        size_t allocations;
+        size_t bytes;               // Requested bytes
+    };
+
+    void rewind(Frame& frame);
+
+    char* memory_;
+    size_t mapped_size_;
+    size_t frame_capacity_;
+    Frame frames_[2];
+    size_t current_;
+    uint64_t frame_number_;
+    mutable ContendedMutex mutex_;
+};
+
+#endif // FRAME_ALLOCATOR_H
@@ -5,9 +5,14 @@
 #include "buddy_allocator.h"
 #include "slab_allocator.h"
 #include "pool_allocator.h"
+#include "size_class_table.h"
 #include <memory>
-#include <unordered_map>
+#include <cstdint>
+#include <atomic>
 #include <mutex>
+#include <map>
+#include <unordered_map>
+#include <string>
 
 /**
  * @brief Hybrid Memory Allocator
@@ -16,6 +21,18 @@
  * - Pool allocator for small, frequent allocations
  * - Slab allocator for medium-sized objects
  * - Buddy allocator for large or variable-size allocations
+ * 
+ * All tiers are carved from one contiguous reservation; a page map records
+ * which sub-allocator owns each page, so frees are routed by address alone.
+ * The front end takes no lock: routing state is immutable after construction
+ * and each sub-allocator synchronizes itself.
+ * 
+ * Requests above huge_threshold (or half the buddy region) bypass the tiers
+ * and are mapped straight from the OS.
+ * 
+ * When a pool or slab class runs dry it borrows a chunk from buddy and grows
+ * a new sub-allocator there; chunks that go idle are handed back, so memory
+ * follows the size histogram instead of the construction-time ratios.
  */
 class HybridAllocator : public MemoryAllocator {
 public:
@@ -23,58 +40,192 @@ public:
         double pool_memory_ratio = 0.3;
         double slab_memory_ratio = 0.3;
         size_t pool_max_size = 256;
-        size_t slab_max_size = 1024;
+        size_t slab_max_size = 4096;
+        bool adaptive_rebalancing = true;        // Grow exhausted classes from buddy
+        size_t rebalance_chunk_size = 64 * 1024; // First chunk a class borrows, later ones double
+        
+        // Explicit size classes; weights split each tier's memory (empty = evenly).
+        // Sizes are rounded up by alignClassSize(). With both class lists empty the
+        // classes come from a SizeClassTable up to slab_max_size: pools up to
+        // pool_max_size, slabs above, no overlap.
+        std::vector<size_t> pool_block_sizes;
+        std::vector<double> pool_class_weights;
+        std::vector<size_t> slab_object_sizes;
+        std::vector<size_t> slab_objects_per_slab;
+        std::vector<double> slab_class_weights;
+        double max_internal_fragmentation = 0.25; // Bound for the generated table
+        
+        size_t huge_threshold = 256 * 1024; // Larger requests are mapped from the OS, 0 disables
+        
+        bool profiling = false; // Record request sizes and lifetimes, see saveProfile()
+        
+        // "key=value" pairs separated by ';' or newlines, lists comma separated,
+        // keys are the field names above; '#' starts a comment
+        static HybridConfig fromString(const std::string& text);
+        static HybridConfig load(const std::string& path);
+        std::string toString() const;
     };
 
     enum class AllocatorType {
         POOL,
         SLAB,
-        BUDDY
+        BUDDY,
+        MAPPED   // Huge requests, one OS mapping each
     };
 
     HybridAllocator(size_t total_memory, const HybridConfig& config);
     HybridAllocator(size_t total_memory); // Constructor with default config
+    
+    // Nearest class size at or above size that keeps blocks aligned like malloc's:
+    // 8 bytes for the smallest class, otherwise a multiple of 16
+    static size_t alignClassSize(size_t size) {
+        return size <= kRouteGranularity ? kRouteGranularity
+                                         : (size + kAlignedRouteGranularity - 1) & ~(kAlignedRouteGranularity - 1);
+    }
     ~HybridAllocator() override;
 
     // Core allocation methods
     void* allocate(size_t size) override;
     void deallocate(void* ptr) override;
+    void deallocate(void* ptr, size_t size) override; // Not for allocateAligned() blocks (asserts; counters stay right)
+    // realloc semantics; huge blocks grow with mremap. A moved block gets the alignment
+    // allocateAligned() would give (the block in place already has it)
+    void* reallocate(void* ptr, size_t new_size, size_t alignment = kMinAlignment);
+    size_t usableSize(void* ptr) const;           // 0 for pointers this allocator does not own
+    void* allocateAligned(size_t size, size_t alignment); // Power-of-two alignment up to a page
+    bool owns(void* ptr) const;
     
     // Statistics and info
     size_t getFragmentation() const override;
     std::string getStats() const override;
     std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override; // Summed over every tier and chunk allocator
       // Hybrid-specific methods
-    void reset() override;
+    void reset() override; // Must not run concurrently with allocation
     double getEfficiencyScore() const;
+    size_t rebalance(); // Returns idle chunks to buddy, grows classes that failed; returns chunks moved
+    
+    // Profiling mode only: one line per request size, read by tools/hybrid_tuner
+    std::string getProfile() const;
+    bool saveProfile(const std::string& path) const;
 
 private:
-    struct AllocatorStats {
-        size_t allocations = 0;
-        size_t deallocations = 0;
-        size_t total_allocated = 0;
+    // Concrete sub-allocator a request is routed to
+    struct Route {
+        AllocatorType type;
+        MemoryAllocator* allocator;
+        size_t class_size;       // Bytes consumed per allocation, 0 = variable (buddy)
+    };
+    
+    static constexpr size_t kRouteGranularity = 8; // Bytes per routing table entry
+    static constexpr size_t kAlignedRouteGranularity = 16; // Per aligned_routes_ entry
+    static constexpr size_t kMaxChunksPerClass = 8;
+    static constexpr size_t kMaxTiers = 1024;
+    
+    // One object size served by pools or slabs (or the buddy tier itself).
+    // chunks[0] is carved at construction, the other slots hold chunks
+    // borrowed from buddy; an empty slot is nullptr. A slot's allocator is
+    // built on its first grow and re-initialised over each later chunk, so a
+    // racing allocate that still holds it after a reclaim never sees it freed.
+    struct alignas(64) SizeClass {
+        AllocatorType type;
+        size_t class_size;
+        size_t objects_per_slab;
+        std::atomic<MemoryAllocator*> chunks[kMaxChunksPerClass];
+        
+        // Guarded by rebalance_mutex_
+        void* chunk_memory[kMaxChunksPerClass];
+        size_t chunk_bytes[kMaxChunksPerClass];
+        uint16_t chunk_tier[kMaxChunksPerClass];
+        std::unique_ptr<MemoryAllocator> chunk_owner[kMaxChunksPerClass];
+        size_t failures_seen;
+        size_t index = 0;        // Position in classes_, also its class in class_counters_
+        
+        SizeClass(AllocatorType type, MemoryAllocator* primary, size_t class_size, size_t objects_per_slab);
     };
 
-    AllocatorType selectAllocator(size_t size);
-    void* allocateFromPool(size_t size);
-    void* allocateFromSlab(size_t size);
-    void deallocateFromPool(void* ptr);
-    void deallocateFromSlab(void* ptr);
-    void createPoolAllocators(size_t total_memory);    void createSlabAllocators(size_t total_memory);
+    const std::vector<SizeClass*>& routeFor(size_t size) const;
+    void* allocateFromChain(const std::vector<SizeClass*>& chain, size_t size);
+    void* allocateFromClass(SizeClass& size_class, size_t size);
+    const Route* ownerOf(void* ptr) const;
+    size_t classIndexOf(const Route& route) const;
+    size_t getLatencyClassCount() const override { return classes_.size(); }
+    size_t consumedSize(size_t class_size, void* ptr) const;
+    char* carveRegion(size_t size);
+    uint16_t registerTier(const Route& route, void* start, size_t size);
+    void mapPages(void* start, size_t size, uint16_t tier);
+    void createPoolAllocators(size_t total_memory);
+    void createSlabAllocators(size_t total_memory);
+    void buildRoutingTable();
+    bool growClass(SizeClass& size_class);
+    bool growClassLocked(SizeClass& size_class);
+    size_t reclaimIdleChunks();
     void updateStatistics(AllocatorType type, size_t size, bool allocation);
+    void* allocateMapped(size_t size);
+    size_t mappedSize(void* ptr) const;
+    bool deallocateMapped(void* ptr);
+    size_t releaseFromTier(const Route& route, void* ptr, size_t size); // Bytes freed; size 0: unsized free
+    void finishDeallocation(const Route& route, void* ptr, size_t consumed);
+    void recordProfileAllocation(size_t size, void* ptr);
+    void recordProfileDeallocation(void* ptr);
     
     HybridConfig config_;
     std::unique_ptr<BuddyAllocator> buddy_allocator_;
     std::vector<std::unique_ptr<PoolAllocator>> pool_allocators_;
     std::vector<std::unique_ptr<SlabAllocator>> slab_allocators_;
     
-    std::unordered_map<void*, AllocatorType> allocation_map_;
+    // routes_[ceil(size / kRouteGranularity)] is the fallback chain for that size class,
+    // tried in order; sizes past the table go straight to buddy
+    std::vector<std::unique_ptr<SizeClass>> classes_;
+    std::vector<std::vector<SizeClass*>> routes_;
+    std::vector<SizeClass*> buddy_route_;
+    // aligned_routes_[ceil(size / 16)]: the chain for 16-aligned requests of that size,
+    // keeping only classes that are multiples of 16
+    std::vector<std::vector<SizeClass*>> aligned_routes_;
+    
+    mutable std::mutex rebalance_mutex_;
+    std::atomic<bool> buddy_exhausted_{false}; // Skip growth until buddy frees something
+    
+    // Single reservation shared by all tiers
+    char* region_;
+    size_t region_size_;
+    size_t region_used_;
+    size_t page_size_;
     
-    AllocatorStats pool_stats_;
-    AllocatorStats slab_stats_;
-    AllocatorStats buddy_stats_;
+    // page_map_[page number] indexes tiers_ (kNoTier for unused pages).
+    // Entries change when chunks move; a tier is written before any page maps to it.
+    static constexpr uint16_t kNoTier = 0xFFFF;
+    static constexpr uint16_t kBuddyTier = 0; // Registered first
+    std::unique_ptr<Route[]> tiers_;
+    size_t tier_count_;
+    std::unique_ptr<std::atomic<uint16_t>[]> page_map_;
+    size_t page_count_;
+    
+    // Per tier (indexed by AllocatorType): allocations and requested bytes
+    StatsCounters tier_counters_;
+    // Demand histogram per size class: allocations count requests made to the
+    // best-fitting class, failures count the times it ran dry
+    StatsCounters class_counters_;
+    
+    // Huge tier: mapping start -> mapped bytes
+    size_t huge_threshold_;              // Effective threshold, at most half the buddy size
+    std::unordered_map<void*, size_t> mapped_allocations_;
+    mutable std::mutex mapped_mutex_;
+    
+    // Profiling mode: lifetimes are measured in allocations made since construction
+    struct ProfileBucket {
+        size_t requests = 0;
+        size_t failures = 0;
+        size_t live = 0;
+        size_t peak_live = 0;
+        size_t frees = 0;
+        uint64_t lifetime_sum = 0;
+    };
     
-    mutable std::mutex mutex_;
+    std::map<size_t, ProfileBucket> profile_;                          // Keyed by rounded request size
+    std::unordered_map<void*, std::pair<size_t, uint64_t>> profile_live_; // ptr -> (bucket, birth)
+    uint64_t profile_clock_ = 0;
+    mutable std::mutex profile_mutex_;
 };
 
 #endif // HYBRID_ALLOCATOR_H
@@ -0,0 +1,166 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Cheapest monotonic tick counter the CPU offers
+ *
+ * TSC on x86, the virtual counter on AArch64, steady_clock elsewhere. Ticks are
+ * only converted to nanoseconds when a histogram is read.
+ */
+namespace cycle_clock {
+
+inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// Measured against steady_clock on first use (takes ~10 ms once)
+double nanosecondsPerTick();
+
+} // namespace cycle_clock
+
+/**
+ * @brief Log-linear (HDR-style) histogram of tick counts
+ *
+ * Values below 2^kSubBucketBits get a bucket each; above that every power of two
+ * is split into 2^kSubBucketBits buckets, so a reported percentile is at most
+ * 1/16 (6.25%) above the true value. The maximum is kept exactly.
+ * Buckets are relaxed atomics: recording is safe from any thread.
+ */
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 4;
+    static constexpr unsigned kMaxExponent = 40;  // Larger values share the last bucket
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kBuckets = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean_ns = 0.0;
+        double p50_ns = 0.0;
+        double p99_ns = 0.0;
+        double p999_ns = 0.0;
+        double max_ns = 0.0;
+    };
+
+    LatencyHistogram();
+
+    void record(uint64_t ticks);
+    void reset();
+    void merge(const LatencyHistogram& other); // Adds other's samples; both may be in use
+    Summary summary() const;
+
+    // Tick value below which a fraction q of the samples fall (rounded up to its bucket)
+    uint64_t percentile(double q) const;
+    uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return max_.load(std::memory_order_relaxed); }
+
+    static size_t bucketFor(uint64_t ticks);
+    static uint64_t bucketUpperBound(size_t bucket);
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};
+
+/**
+ * @brief Sampled allocate/deallocate latency for one allocator
+ *
+ * Off by default: the hot path then costs one relaxed load. When enabled, one
+ * call in sample_every on average is timed and recorded in the allocator-wide
+ * histogram and, if the allocator reports one, in the histogram of its size
+ * class. Each thread counts down per op to a random interval, so periodic
+ * request patterns cannot line up with the sampling. Histograms are created
+ * by the first enable() and kept until destruction, so enable/disable are safe
+ * while other threads allocate.
+ */
+class LatencyRecorder {
+public:
+    enum class Op { ALLOCATE, DEALLOCATE };
+    static constexpr size_t kAllClasses = static_cast<size_t>(-1);
+
+    LatencyRecorder() = default;
+    ~LatencyRecorder();
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator=(const LatencyRecorder&) = delete;
+
+    // class_count is only used by the first call
+    void enable(uint32_t sample_every, size_t class_count);
+    void disable() { sample_every_.store(0, std::memory_order_relaxed); }
+    uint32_t getSampleRate() const { return sample_every_.load(std::memory_order_relaxed); }
+    void reset();
+
+    bool shouldSample(Op op) {
+        uint32_t every = sample_every_.load(std::memory_order_relaxed);
+        return every != 0 && tick(op, every);
+    }
+    void record(Op op, size_t size_class, uint64_t ticks);
+
+    // Zero count when nothing was sampled (or the class does not exist)
+    LatencyHistogram::Summary summary(Op op, size_t size_class = kAllClasses) const;
+    size_t getClassCount() const;
+
+private:
+    // Per op: [0] all classes, [1 + c] class c
+    struct Histograms {
+        size_t class_count;
+        std::unique_ptr<LatencyHistogram[]> per_op[2];
+    };
+
+    static bool tick(Op op, uint32_t every);
+    const LatencyHistogram* histogram(Op op, size_t size_class) const;
+
+    std::atomic<uint32_t> sample_every_{0};
+    std::atomic<Histograms*> histograms_{nullptr};
+};
+
+/**
+ * @brief Times one allocator call when the recorder picks it for sampling
+ *
+ * Construct before taking locks so the wait is part of the latency; call
+ * setClass() once the size class is known.
+ */
+class LatencyProbe {
+public:
+    LatencyProbe(LatencyRecorder& recorder, LatencyRecorder::Op op)
+        : recorder_(recorder.shouldSample(op) ? &recorder : nullptr), op_(op),
+          size_class_(LatencyRecorder::kAllClasses), start_(recorder_ ? cycle_clock::now() : 0) {}
+
+    ~LatencyProbe() {
+        if (recorder_) recorder_->record(op_, size_class_, cycle_clock::now() - start_);
+    }
+
+    LatencyProbe(const LatencyProbe&) = delete;
+    LatencyProbe& operator=(const LatencyProbe&) = delete;
+
+    bool active() const { return recorder_ != nullptr; }
+    void setClass(size_t size_class) { size_class_ = size_class; }
+
+private:
+    LatencyRecorder* recorder_;
+    LatencyRecorder::Op op_;
+    size_t size_class_;
+    uint64_t start_;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -2,10 +2,13 @@
 #define MEMORY_ALLOCATOR_H
 
 #include <cstddef>
+#include <atomic>
 #include <memory>
 #include <chrono>
 #include <string>
 #include <vector>
+#include "stats_counters.h"
+#include "latency_histogram.h"
 
 /**
  * @brief Base interface for all memory allocators
@@ -22,9 +25,16 @@ public:
         size_t peak_allocated = 0;       // Peak memory usage
         size_t num_allocations = 0;      // Số lần allocation
         size_t num_deallocations = 0;    // Số lần deallocation
+        size_t num_failures = 0;         // Allocations that returned nullptr
         double avg_alloc_time_ns = 0.0;  // Thời gian allocation trung bình (nanoseconds)
         double avg_dealloc_time_ns = 0.0; // Thời gian deallocation trung bình
         double fragmentation_ratio = 0.0; // Tỷ lệ phân mảnh (0.0 = no fragmentation, 1.0 = high fragmentation)
+        LatencyHistogram::Summary alloc_latency;   // Sampled; empty unless latency sampling is on
+        LatencyHistogram::Summary dealloc_latency;
+    };
+    struct LockStats {
+        uint64_t acquisitions = 0;       // Times the allocator's locks were taken
+        uint64_t contended = 0;          // Of those, how many had to wait for another thread
     };    struct MemoryBlock {
         size_t address;
         size_t size;
@@ -32,12 +42,23 @@ public:
         std::string type;
     };
 
+    // Every block an allocator hands out is at least this aligned; fixed-size
+    // allocators round their block sizes up to a multiple of it
+    static constexpr size_t kMinAlignment = 8;
+
 public:    MemoryAllocator(size_t total_memory); // Updated constructor
     virtual ~MemoryAllocator();
 
     // Core allocation methods
     virtual void* allocate(size_t size) = 0;
     virtual void deallocate(void* ptr) = 0;
+    // Sized deallocation: size is what was passed to allocate(), so the block can be found
+    // from its size class instead of being looked up; debug builds verify it
+    virtual void deallocate(void* ptr, size_t size);
+
+    // Batch allocation: fills out[0..n) and returns n (n < count when memory runs out)
+    virtual size_t allocate_batch(size_t size, size_t count, void** out);
+    virtual void deallocate_batch(void* const* ptrs, size_t count);
 
     // Memory management
     virtual void reset() {}
@@ -53,17 +74,37 @@ public:    MemoryAllocator(size_t total_memory); // Updated constructor
     void stressTest(size_t duration_seconds);    // Utility methods
     bool isValidPointer(void* ptr) const;
     
-    // Statistics helpers
-    size_t getAllocationCount() const { return allocation_count_; }
-    size_t getDeallocationCount() const { return deallocation_count_; }
-    size_t getAllocatedSize() const { return allocated_size_; }
+    // Statistics helpers (summed over per-thread shards on each call)
+    size_t getAllocationCount() const { return counters_.allocations(); }
+    size_t getDeallocationCount() const { return counters_.deallocations(); }
+    size_t getAllocatedSize() const { return counters_.currentBytes(); }
+    size_t getPeakAllocatedSize() const { return counters_.snapshot().peak_bytes; }
+    size_t getFailedAllocationCount() const { return counters_.snapshot().failures; }
+    AllocationStats getAllocationStats() const;
+    const StatsCounters& getCounters() const { return counters_; }
+    // Main allocation locks, summed over tiers; zero for allocators without them
+    virtual LockStats getLockStats() const { return {}; }
+    
+    // Latency sampling: times one in sample_every allocate/deallocate calls per thread
+    // (batch calls are not timed). Off by default; when off it costs one load per call.
+    void enableLatencySampling(uint32_t sample_every = 64);
+    void disableLatencySampling() { latency_.disable(); }
+    // size_class as numbered by the allocator (pool index, buddy level, hybrid class)
+    LatencyHistogram::Summary getLatencySummary(LatencyRecorder::Op op,
+                                                size_t size_class = LatencyRecorder::kAllClasses) const {
+        return latency_.summary(op, size_class);
+    }
 
 protected:
     size_t total_memory_;
-    size_t allocated_size_;
-    size_t allocation_count_;
-    size_t deallocation_count_;
+    // Bytes and counts, updated without locks from any thread
+    StatsCounters counters_;
+    LatencyRecorder latency_;
     std::chrono::steady_clock::time_point start_time_;
+    
+    // Size classes that get their own latency histogram
+    virtual size_t getLatencyClassCount() const { return 0; }
+    static void appendLatencyLine(std::string& out, const std::string& label, const LatencyHistogram::Summary& summary);
 };
 
 // Factory pattern for creating allocators
@@ -73,7 +114,12 @@ public:
         BUDDY_SYSTEM,
         SLAB,
         MEMORY_POOL,
-        HYBRID
+        HYBRID,
+        PERSISTENT,     // config is the heap file's path
+        ARENA,          // config is the chunk size in bytes, empty for 64 KB
+        STACK,
+        FRAME,          // Double-buffered, initial_size covers both frames
+        TLSF
     };
 
     static std::unique_ptr<MemoryAllocator> create_allocator(
@@ -0,0 +1,94 @@
+#ifndef OFFSET_HEAP_H
+#define OFFSET_HEAP_H
+
+#include "memory_allocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Heap whose metadata lives entirely inside its region, as offsets
+ *
+ * A header at offset 0, then blocks laid out back to back. Free lists, the
+ * root object and the bump pointer are offsets from the start of the region,
+ * so the region can be mapped at any address, by a later process (a file) or
+ * by several at once (shared memory).
+ *
+ * Blocks are binary buddies: power-of-two size classes (16-byte header included),
+ * each at a multiple of its size past the first block, so a block's buddy is
+ * at relative offset ^ size. Fresh blocks come from a bump pointer, a larger
+ * free block is split down to the requested class, and a freed block merges
+ * with its free buddy. Free lists are doubly linked through the blocks, so a
+ * buddy is taken off its list in constant time. Every header is written before
+ * the block it describes becomes reachable from a walk, and every block is
+ * tagged live or free before the lists are touched, which lets recover()
+ * rebuild the lists and totals after a process died halfway through an update.
+ *
+ * Nothing here locks: PersistentAllocator and SharedMemoryAllocator wrap it.
+ */
+class OffsetHeap {
+public:
+    static constexpr size_t kMaxClasses = 48;
+
+    struct Block {
+        void* ptr = nullptr;          // Payload, nullptr on failure
+        size_t size_class = 0;
+        size_t block_size = 0;        // Header included
+    };
+
+    struct Totals {
+        uint64_t region_size = 0;
+        uint64_t used = 0;            // Carved from the bump pointer
+        uint64_t allocated_bytes = 0; // Live blocks, headers included
+        uint64_t live_blocks = 0;
+        uint64_t free_bytes = 0;      // Blocks on the free lists
+    };
+
+    OffsetHeap() = default;
+    OffsetHeap(void* region, size_t size) : base_(static_cast<char*>(region)), size_(size) {}
+
+    // The three below throw std::runtime_error naming the heap as name
+    void format(const std::string& name);         // Empties the region
+    void validate(const std::string& name) const; // Header matches this region and version
+    void recover(const std::string& name);        // Rebuilds free lists and totals from block tags
+
+    Block allocate(size_t size);  // size_class is the requested class even on failure
+    Block deallocate(void* ptr);  // ptr is nullptr unless ptr was a live block (double free, foreign)
+    bool isLive(void* ptr) const;
+
+    uint64_t getRoot() const;
+    void setRoot(uint64_t offset);
+    uint64_t toOffset(const void* ptr) const { return ptr ? static_cast<uint64_t>(static_cast<const char*>(ptr) - base_) : 0; }
+    void* fromOffset(uint64_t offset) const { return offset ? base_ + offset : nullptr; }
+
+    // Set while some process has the heap open; left set by a crash
+    bool isOpen() const;
+    void setOpen(bool open);
+
+    Totals getTotals() const;
+    std::vector<MemoryAllocator::MemoryBlock> getLayout() const;
+    static size_t classSize(size_t size_class) { return kMinBlockSize << size_class; }
+
+private:
+    struct Header;
+    struct BlockHeader;
+
+    static constexpr uint32_t kVersion = 2; // 1 carved blocks at any multiple of 32
+    static constexpr size_t kMinBlockSize = 32;
+
+    Header* header() const { return reinterpret_cast<Header*>(base_); }
+    BlockHeader* blockAt(uint64_t offset) const { return reinterpret_cast<BlockHeader*>(base_ + offset); }
+    static size_t classFor(size_t size);
+    BlockHeader* liveBlock(void* ptr) const;
+    uint64_t carve(size_t size_class);               // Offset of a new block past bump, 0 if it does not fit
+    uint64_t& prevFree(uint64_t offset) const;       // In the payload of a free block
+    void pushFree(uint64_t offset, size_t size_class);
+    void unlinkFree(uint64_t offset, size_t size_class);
+    void insertFree(uint64_t offset, size_t size_class); // Block already tagged free; merges with its buddies
+
+    char* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+#endif // OFFSET_HEAP_H
@@ -0,0 +1,47 @@
+#ifndef OS_MEMORY_H
+#define OS_MEMORY_H
+
+#include <cstddef>
+
+/**
+ * @brief Thin wrappers over the OS virtual memory API
+ * 
+ * Mapped pages are zero-filled and only committed when first touched.
+ * Sizes passed in are rounded up to whole pages.
+ */
+size_t os_page_size();
+size_t os_round_to_pages(size_t size);
+
+void* os_map_pages(size_t size);              // nullptr on failure
+void os_unmap_pages(void* ptr, size_t size);
+
+// Resizes a mapping, moving it if needed (mremap on Linux, map + copy elsewhere).
+// Returns the new address, or nullptr with the old mapping left intact.
+void* os_remap_pages(void* ptr, size_t old_size, size_t new_size);
+
+// Shared read-write mapping of a whole file
+struct OsFileMapping {
+    void* address = nullptr;
+    size_t size = 0;
+    int fd = -1;
+    bool created = false;       // The file was missing or empty and has been sized by os_map_file
+};
+
+// Maps path shared and read-write. A missing or empty file is created (when create
+// is set) and sized to size; an existing file is mapped at its own size. With
+// exclusive set, a second mapping of the same file fails until this one is unmapped.
+// Returns false on failure (always on Windows, which is not supported yet).
+bool os_map_file(const char* path, size_t size, bool create, bool exclusive, OsFileMapping& mapping);
+bool os_flush_file(const OsFileMapping& mapping); // Writes dirty pages back and waits
+void os_unmap_file(OsFileMapping& mapping);
+
+// Shared memory object for several processes, unmapped with os_unmap_file. A name
+// ("/name") opens or creates it with shm_open, sized as in os_map_file; created is
+// only set for the process that created it. Without a name it is anonymous
+// (memfd_create, Linux only) and reached by other processes through fork or by
+// passing mapping.fd. Returns false on failure.
+bool os_map_shared(const char* name, size_t size, bool create, OsFileMapping& mapping);
+bool os_map_shared_fd(int fd, OsFileMapping& mapping); // Maps a duplicate of fd at its size
+bool os_unlink_shared(const char* name);               // Existing mappings stay valid
+
+#endif // OS_MEMORY_H
@@ -0,0 +1,106 @@
+#ifndef PERSISTENT_ALLOCATOR_H
+#define PERSISTENT_ALLOCATOR_H
+
+#include "memory_allocator.h"
+#include "contended_mutex.h"
+#include "offset_heap.h"
+#include "os_memory.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Heap in a memory-mapped file that survives restarts
+ *
+ * The file is an OffsetHeap: header, free lists and root are offsets inside it,
+ * so it can be mapped at any address, and reopening it gives back every live
+ * object. When a heap was not closed cleanly, opening it rebuilds the free lists
+ * and totals from the block tags.
+ *
+ * Objects that point at each other must not store raw pointers, which change
+ * with the mapping address: use OffsetPtr, or toOffset()/fromOffset().
+ */
+class PersistentAllocator : public MemoryAllocator {
+public:
+    enum class OpenMode {
+        CREATE,         // Fail if the file already holds data
+        OPEN,           // Fail if the file is missing or empty
+        OPEN_OR_CREATE
+    };
+
+    // size is only used when the file is created; an existing heap keeps its size.
+    // Throws std::runtime_error when the file cannot be mapped, is in use by another
+    // PersistentAllocator, or does not hold a valid heap.
+    PersistentAllocator(const std::string& path, size_t size, OpenMode mode = OpenMode::OPEN_OR_CREATE);
+    ~PersistentAllocator() override; // Flushes and marks the heap cleanly closed
+
+    // Core allocation methods
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    using MemoryAllocator::deallocate; // Sized overload, falls back to deallocate(ptr)
+
+    // Statistics and info
+    size_t getFragmentation() const override;
+    std::string getStats() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
+
+    // Frees every object in the file
+    void reset() override;
+
+    // Persistent-specific methods
+    void setRoot(void* ptr);     // Entry point the next process starts from (nullptr clears it)
+    void* getRoot() const;
+    uint64_t toOffset(const void* ptr) const;  // 0 for nullptr
+    void* fromOffset(uint64_t offset) const;   // nullptr for 0
+    bool flush();                // Writes the heap back to the file and waits
+    bool wasCreated() const { return created_; }
+    bool wasRecovered() const { return recovered_; } // Opened after an unclean close
+    const std::string& getPath() const { return path_; }
+
+private:
+    size_t getLatencyClassCount() const override { return OffsetHeap::kMaxClasses; }
+
+    std::string path_;
+    OsFileMapping mapping_;
+    OffsetHeap heap_;
+    bool created_ = false;
+    bool recovered_ = false;
+    mutable ContendedMutex mutex_;
+};
+
+/**
+ * @brief Pointer stored as its distance from itself
+ *
+ * Stays valid wherever the region holding both it and its target is mapped, so
+ * objects in a PersistentAllocator or SharedMemoryAllocator heap can link to
+ * each other with it.
+ */
+template<typename T>
+class OffsetPtr {
+public:
+    OffsetPtr(T* ptr = nullptr) { set(ptr); }
+    OffsetPtr(const OffsetPtr& other) { set(other.get()); }
+    OffsetPtr& operator=(const OffsetPtr& other) { set(other.get()); return *this; }
+    OffsetPtr& operator=(T* ptr) { set(ptr); return *this; }
+
+    T* get() const {
+        return distance_ == kNull ? nullptr
+                                  : reinterpret_cast<T*>(reinterpret_cast<intptr_t>(this) + distance_);
+    }
+    T* operator->() const { return get(); }
+    T& operator*() const { return *get(); }
+    explicit operator bool() const { return distance_ != kNull; }
+
+private:
+    // 0 is a pointer to itself; a target at distance 1 would sit inside the pointer
+    static constexpr intptr_t kNull = 1;
+
+    void set(T* ptr) {
+        distance_ = ptr ? reinterpret_cast<intptr_t>(ptr) - reinterpret_cast<intptr_t>(this) : kNull;
+    }
+
+    intptr_t distance_;
+};
+
+#endif // PERSISTENT_ALLOCATOR_H
@@ -3,7 +3,10 @@
 
 #include "memory_allocator.h"
 #include <vector>
+#include <cstdint>
 #include <unordered_map>
+#include "contended_mutex.h"
+#include "remote_free_list.h"
 #include <mutex>
 
 /**
@@ -20,6 +23,7 @@ public:    struct PoolConfig {
         std::vector<size_t> block_sizes;      // Available block sizes
         std::vector<size_t> blocks_per_pool;  // Number of blocks per size
         size_t total_memory;                  // Total memory to allocate
+        void* memory = nullptr;               // Optional caller-owned region, pools are laid out back to back
     };
 
     struct FreeBlock {
@@ -28,55 +32,101 @@ public:    struct PoolConfig {
 
     struct MemoryPool {
         void* memory;                    // Pool memory region
-        FreeBlock* free_list;           // Free block list
+        FreeBlock* free_list;           // Free block list (only blocks that were freed)
         size_t block_size;              // Size of each block
         size_t total_blocks;            // Total blocks in pool
         size_t free_blocks;             // Available blocks
+        size_t carved_blocks;           // Blocks handed out at least once (bump pointer)
+        std::vector<uint64_t> occupancy; // One bit per block, set = allocated
+        bool owns_memory;               // False when the region is caller-owned
+        size_t index = 0;               // Position in pools_, also its stats class
         
-        MemoryPool(size_t block_size, size_t num_blocks);
+        MemoryPool(size_t block_size, size_t num_blocks, void* region = nullptr);
         ~MemoryPool();
         
         bool initialize();
         void* allocate_block();
+        size_t allocate_blocks(size_t count, void** out);
         void deallocate_block(void* ptr);
+        size_t find_free_run(size_t count) const;
+        void claim_run(size_t start, size_t count);
+        void release_run(size_t start, size_t count);
         bool contains_address(void* ptr) const;
+        bool is_allocated(void* ptr) const;
+        size_t block_index(void* ptr) const;
         double get_utilization() const;
     };
 
     explicit PoolAllocator(const PoolConfig& config);
+    // One pool of block_size blocks: num_blocks of them, or as many as total_memory holds if fewer
+    PoolAllocator(size_t block_size, size_t num_blocks, size_t total_memory);
     ~PoolAllocator() override;
 
     // Core allocation methods
     void* allocate(size_t size) override;
-    void deallocate(void* ptr) override;
+    void deallocate(void* ptr) override { release(ptr); }
+    void deallocate(void* ptr, size_t size) override { release(ptr, size); } // Searches only pools that fit size
+    // deallocate() that reports whether a block was freed: false for double frees and
+    // pointers that are not a block start. A queued remote free counts as freed.
+    bool release(void* ptr);
+    bool release(void* ptr, size_t size);
+    size_t allocate_batch(size_t size, size_t count, void** out) override;
+    void deallocate_batch(void* const* ptrs, size_t count) override;
     
     // Statistics and info
     size_t getFragmentation() const override;
     std::string getStats() const override;
     std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayoutRuns() const; // Run-length summary
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
     
     // Pool-specific methods
+    void* allocate_contiguous(size_t block_size, size_t count); // Freed as a unit by deallocate()
     void reset() override;
+    bool retire(); // Drops every pool once nothing is live; later requests fail
+    // Rebuilds the pools over a new region, dropping every block; config must have
+    // as many pools as the one the allocator was built with
+    void reinitialize(const PoolConfig& config);
     bool canAllocate(size_t size) const;
     size_t getPoolCount() const { return pools_.size(); }
+    size_t getMaxBlockSize() const { return pools_.empty() ? 0 : pools_.back()->block_size; }
+    size_t getAvailableBlocks() const; // Free blocks over all pools
     double getAverageUtilization() const;
+    
+    // Cross-thread frees: once bound, frees from other threads skip the lock and are
+    // queued (see RemoteFreeList); the next allocation on any thread returns them.
+    // Until then they still count as allocated.
+    void bindOwnerThread() { remote_frees_.bindOwner(); }
+    void unbindOwnerThread() { remote_frees_.unbindOwner(); }
+    void drainRemoteFrees();
+    uint64_t getRemoteFreeCount() const { return remote_frees_.getPushed(); }
 
-private:    struct AllocatorStats {
-        size_t total_allocations = 0;
-        size_t total_deallocations = 0;
-        size_t failed_allocations = 0;
-        size_t current_allocated = 0;
-        size_t peak_allocated = 0;
+private:
+    // Copy of a pool's occupancy taken under the lock so layouts can be built without it
+    struct PoolSnapshot {
+        size_t base;
+        size_t block_size;
+        size_t total_blocks;
+        std::vector<uint64_t> occupancy;
     };
     
+    static PoolConfig singlePoolConfig(size_t block_size, size_t num_blocks, size_t total_memory);
+    void buildPools(const PoolConfig& config);
+    
+    size_t poolIndexFor(size_t size) const; // Smallest pool with block_size >= size, or pools_.size()
     MemoryPool* findPoolForSize(size_t size);
     MemoryPool* findPoolForAddress(void* ptr);
+    size_t statsClassFor(size_t size) const; // Pool a failed request of size belonged to
+    size_t getLatencyClassCount() const override { return pools_.size(); }
+    MemoryPool* deallocateLocked(void* ptr); // Pool the block went back to, nullptr if none
+    void drainRemoteFreesLocked();
+    std::vector<PoolSnapshot> snapshotPools() const;
     
     std::vector<std::unique_ptr<MemoryPool>> pools_;
-    std::unordered_map<void*, MemoryPool*> allocation_map_;
-    AllocatorStats stats_;
+    std::unordered_map<void*, size_t> contiguous_runs_; // Run start -> block count
     
-    mutable std::mutex mutex_;
+    mutable ContendedMutex mutex_;
+    RemoteFreeList remote_frees_;
 };
 
 #endif // POOL_ALLOCATOR_H
@@ -0,0 +1,100 @@
+#ifndef REMOTE_FREE_LIST_H
+#define REMOTE_FREE_LIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+/**
+ * @brief Lock-free list of blocks freed by threads other than the allocator's owner
+ *
+ * A non-owning thread links the freed block into the list through its first
+ * word with one CAS and never touches the allocator's lock. The owner takes the
+ * whole list with one exchange and returns the blocks under its lock in a
+ * single batch. Blocks are only ever pushed one by one and taken all at once,
+ * so there is no ABA problem.
+ *
+ * Without an owner (the default) isRemote() is false everywhere and every free
+ * takes the usual locked path.
+ */
+class RemoteFreeList {
+public:
+    struct Node {
+        Node* next;
+    };
+
+    // Frees from any other thread go through push() from now on
+    void bindOwner(std::thread::id owner = std::this_thread::get_id()) {
+        owner_.store(owner, std::memory_order_relaxed);
+    }
+    void unbindOwner() { owner_.store(std::thread::id(), std::memory_order_relaxed); }
+
+    bool isRemote() const {
+        std::thread::id owner = owner_.load(std::memory_order_relaxed);
+        return owner != std::thread::id() && owner != std::this_thread::get_id();
+    }
+
+    // ptr must be at least pointer sized; its contents are overwritten
+    void push(void* ptr) {
+        Node* node = static_cast<Node*>(ptr);
+        node->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+        pushed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Cheap check before taking the list
+    bool hasPending() const { return head_.load(std::memory_order_relaxed) != nullptr; }
+
+    // Detaches every pending block, most recently freed first
+    Node* takeAll() {
+        if (!hasPending()) return nullptr;
+        return head_.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    // Nodes of a taken chain before it repeats. A block pushed twice links back to
+    // itself, and once freed its next word is the allocator's again, so the chain
+    // is measured before anything is returned (Brent's cycle detection)
+    static size_t distinctLength(const Node* head) {
+        if (!head) return 0;
+        
+        const Node* tortoise = head;
+        const Node* hare = head->next;
+        size_t power = 1;
+        size_t cycle = 1;
+        size_t steps = 1;
+        while (hare && hare != tortoise) {
+            if (cycle == power) {
+                tortoise = hare;
+                power *= 2;
+                cycle = 0;
+            }
+            hare = hare->next;
+            ++cycle;
+            ++steps;
+        }
+        if (!hare) return steps;
+        
+        // Cycle of length cycle; its first node is where two walkers cycle apart meet
+        size_t prefix = 0;
+        tortoise = hare = head;
+        for (size_t i = 0; i < cycle; ++i) hare = hare->next;
+        while (tortoise != hare) {
+            tortoise = tortoise->next;
+            hare = hare->next;
+            ++prefix;
+        }
+        return prefix + cycle;
+    }
+
+    uint64_t getPushed() const { return pushed_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<Node*> head_{nullptr};
+    std::atomic<std::thread::id> owner_{std::thread::id()};
+    std::atomic<uint64_t> pushed_{0};
+};
+
+#endif // REMOTE_FREE_LIST_H
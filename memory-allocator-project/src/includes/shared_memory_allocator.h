@@ -0,0 +1,87 @@
+#ifndef SHARED_MEMORY_ALLOCATOR_H
+#define SHARED_MEMORY_ALLOCATOR_H
+
+#include "memory_allocator.h"
+#include "offset_heap.h"
+#include "os_memory.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Heap in shared memory that several processes allocate from and free to
+ *
+ * The region is a POSIX shared memory object (shm_open) or an anonymous memfd
+ * shared through fork or fd passing. It holds a control block with a
+ * process-shared mutex, followed by an OffsetHeap, so all metadata is offsets
+ * and every process may map it at a different address. One process can allocate
+ * a message, pass toOffset(ptr) to another (socket, pipe, a queue in the heap),
+ * and the other reads it with fromOffset() and frees it: no copy.
+ *
+ * On Linux the mutex is robust: if a process dies holding it, the next locker
+ * rebuilds the free lists from the block tags and carries on. Objects the dead
+ * process had allocated stay allocated.
+ *
+ * The statistics counters cover this process's calls only (a process that frees
+ * other processes' blocks sees its current bytes stay at zero); getHeapTotals()
+ * gives the heap-wide numbers.
+ */
+class SharedMemoryAllocator : public MemoryAllocator {
+public:
+    enum class OpenMode {
+        CREATE,         // Fail if the name exists
+        OPEN,           // Fail if it does not
+        OPEN_OR_CREATE
+    };
+
+    // Named region such as "/frontend-messages"; size only matters when creating.
+    // Throws std::runtime_error if the region cannot be mapped or is not a heap.
+    SharedMemoryAllocator(const std::string& name, size_t size, OpenMode mode = OpenMode::OPEN_OR_CREATE);
+    // Anonymous region (Linux): children forked afterwards share it, others attach with getFd()
+    explicit SharedMemoryAllocator(size_t size);
+    // Attaches to a region received as a file descriptor (fd is duplicated, not taken)
+    static std::unique_ptr<SharedMemoryAllocator> attach(int fd);
+    ~SharedMemoryAllocator() override; // Unmaps; the region lives until unlinked and unmapped everywhere
+
+    // Core allocation methods
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override; // Any process may free any block
+    using MemoryAllocator::deallocate; // Sized overload, falls back to deallocate(ptr)
+
+    // Statistics and info
+    size_t getFragmentation() const override;
+    std::string getStats() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override;
+
+    // Shared-memory specific methods
+    uint64_t toOffset(const void* ptr) const { return heap_.toOffset(ptr); }  // The same in every process
+    void* fromOffset(uint64_t offset) const { return heap_.fromOffset(offset); }
+    void setRoot(void* ptr);   // A rendezvous object every attached process can find
+    void* getRoot() const;
+    OffsetHeap::Totals getHeapTotals() const;
+    int getFd() const { return mapping_.fd; }
+    const std::string& getName() const { return name_; } // Empty when anonymous
+    bool wasCreated() const { return created_; }
+    static bool unlink(const std::string& name);
+
+private:
+    struct Control;
+    class Lock;
+
+    explicit SharedMemoryAllocator(const OsFileMapping& mapping);
+    Control* control() const { return static_cast<Control*>(mapping_.address); }
+    void initialize();  // Throws std::runtime_error, unmapping first
+    size_t getLatencyClassCount() const override { return OffsetHeap::kMaxClasses; }
+
+    std::string name_;
+    OsFileMapping mapping_;
+    OffsetHeap heap_;
+    bool created_ = false;
+    // This process's lock counts
+    mutable std::atomic<uint64_t> lock_acquisitions_{0};
+    mutable std::atomic<uint64_t> lock_contended_{0};
+};
+
+#endif // SHARED_MEMORY_ALLOCATOR_H
@@ -0,0 +1,38 @@
+#ifndef SIZE_CLASS_TABLE_H
+#define SIZE_CLASS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Geometric size-class table
+ * 
+ * Each power-of-two range [2^k, 2^(k+1)) is split into the same number of
+ * evenly spaced classes (four for the default 25% bound), so rounding a
+ * request up to its class wastes less than max_fragmentation of the request.
+ * Spacing never drops below the 8-byte quantum, so the bound only holds from
+ * quantum * classes-per-doubling bytes up; smaller classes are 8 bytes apart.
+ */
+class SizeClassTable {
+public:
+    static constexpr size_t kQuantum = 8;
+
+    SizeClassTable(size_t max_size, double max_fragmentation = 0.25);
+
+    size_t getClassCount() const { return class_sizes_.size(); }
+    size_t getClassSize(size_t index) const { return class_sizes_[index]; }
+    const std::vector<size_t>& getClassSizes() const { return class_sizes_; }
+    size_t getClassesPerDoubling() const { return classes_per_doubling_; }
+    size_t getMaxSize() const { return class_sizes_.empty() ? 0 : class_sizes_.back(); }
+
+    size_t classIndex(size_t size) const; // getClassCount() when size > getMaxSize()
+    size_t roundUp(size_t size) const;    // 0 when size > getMaxSize()
+
+private:
+    std::vector<size_t> class_sizes_;
+    std::vector<uint16_t> lookup_;        // ceil(size / kQuantum) -> class index
+    size_t classes_per_doubling_;
+};
+
+#endif // SIZE_CLASS_TABLE_H
@@ -4,6 +4,8 @@
 #include "memory_allocator.h"
 #include <vector>
 #include <set>
+#include "contended_mutex.h"
+#include "remote_free_list.h"
 #include <mutex>
 
 /**
@@ -24,28 +26,62 @@ private:
     struct SlabInfo {
         size_t offset;
         size_t free_objects;
+        size_t carved_objects;  // Objects handed out at least once (bump pointer)
     };
 
 public:
-    SlabAllocator(size_t object_size, size_t objects_per_slab, size_t total_memory);
+    // memory: optional caller-owned region of total_memory bytes
+    SlabAllocator(size_t object_size, size_t objects_per_slab, size_t total_memory, void* memory = nullptr);
     ~SlabAllocator() override;
 
     // Core allocation methods
     void* allocate(size_t size) override;
-    void deallocate(void* ptr) override;
+    void deallocate(void* ptr) override { release(ptr); }
+    void deallocate(void* ptr, size_t size) override; // The slab already follows from the address
+    // deallocate() that reports whether an object was freed: false for double frees and
+    // pointers that are not an object start. A queued remote free counts as freed.
+    bool release(void* ptr);
+    size_t allocate_batch(size_t size, size_t count, void** out) override;
+    void deallocate_batch(void* const* ptrs, size_t count) override;
     
     // Statistics and info
     size_t getFragmentation() const override;
     std::string getStats() const override;
     std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
+    
+    // Frees every object, back to a single empty slab (also undoes retire())
+    void reset() override;
     
     // Slab-specific methods
     size_t getObjectSize() const { return object_size_; }
+    size_t getObjectsPerSlab() const { return objects_per_slab_; }
+    bool retire(); // Drops every slab once nothing is live; later requests fail
+    // Moves a caller-owned allocator to a new region of total_memory bytes, dropping every object
+    void reinitialize(void* memory, size_t total_memory);
+    
+    // Cross-thread frees, as in PoolAllocator: once bound, frees from other threads
+    // are queued without the lock and returned by the next allocation
+    void bindOwnerThread() { remote_frees_.bindOwner(); }
+    void unbindOwnerThread() { remote_frees_.unbindOwner(); }
+    void drainRemoteFrees();
+    uint64_t getRemoteFreeCount() const { return remote_frees_.getPushed(); }
+    static size_t getSlabSize(size_t object_size, size_t objects_per_slab) {
+        return alignObjectSize(object_size) * objects_per_slab + sizeof(SlabHeader);
+    }
+    // Objects keep kMinAlignment and have room for the free-list index
+    static size_t alignObjectSize(size_t object_size) {
+        return object_size <= kMinAlignment ? kMinAlignment : (object_size + kMinAlignment - 1) & ~(kMinAlignment - 1);
+    }
 
 private:
     void createSlab();
     void* allocateFromSlab(SlabInfo& slab);
-    void deallocateFromSlab(SlabInfo& slab, void* ptr);
+    bool deallocateFromSlab(SlabInfo& slab, void* ptr); // false unless ptr was allocated
+    size_t objectIndex(const SlabInfo& slab, void* ptr) const; // Over all slabs
+    SlabInfo* findSlabForAddress(void* ptr);
+    bool isObjectAddress(void* ptr) const; // Object slot in the region, carved or not; no lock needed
+    void drainRemoteFreesLocked();
 
 private:
     size_t object_size_;
@@ -53,8 +89,11 @@ private:
     size_t slab_size_;
     size_t max_slabs_;
     std::vector<SlabInfo> slabs_;
+    std::vector<uint64_t> occupancy_;   // One bit per object of every slab, set = allocated
     char* memory_pool_;
-    mutable std::mutex mutex_;
+    bool owns_memory_;
+    mutable ContendedMutex mutex_;
+    RemoteFreeList remote_frees_;
 };
 
 #endif // SLAB_ALLOCATOR_H
@@ -0,0 +1,81 @@
+#ifndef STACK_ALLOCATOR_H
+#define STACK_ALLOCATOR_H
+
+#include "memory_allocator.h"
+#include "contended_mutex.h"
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Double-ended stack allocator freed back to markers
+ *
+ * One mapped region with a stack growing up from the bottom and another growing
+ * down from the top; they fail when they meet. The usual split is long-lived data
+ * (level, assets) from the bottom and per-frame scratch from the top. Nothing is
+ * freed one object at a time: take a marker with getMarker(), allocate, then
+ * freeToMarker() pops everything allocated on that end since, in O(1).
+ */
+class StackAllocator : public MemoryAllocator {
+public:
+    static constexpr size_t kDefaultAlignment = 16;
+
+    enum class End {
+        BOTTOM,         // Grows up; what allocate(size) uses
+        TOP             // Grows down
+    };
+
+    // Position of one end plus its running totals, so a pop can update the stats
+    struct Marker {
+        End end;
+        size_t offset;
+        size_t allocations;
+        size_t bytes;
+    };
+
+    explicit StackAllocator(size_t total_memory = 1024 * 1024);
+    ~StackAllocator() override;
+
+    // Core allocation methods
+    void* allocate(size_t size) override { return allocate(size, End::BOTTOM); }
+    void* allocate(size_t size, End end, size_t alignment = kDefaultAlignment); // alignment: a power of two
+    void deallocate(void* ptr) override { (void)ptr; } // Freed by freeToMarker() or reset()
+    void deallocate(void* ptr, size_t size) override { (void)ptr; (void)size; }
+    void deallocate_batch(void* const* ptrs, size_t count) override { (void)ptrs; (void)count; }
+
+    // Statistics and info
+    size_t getFragmentation() const override;
+    std::string getStats() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
+
+    // Empties both ends
+    void reset() override;
+
+    // Stack-specific methods
+    Marker getMarker(End end = End::BOTTOM) const;
+    // Throws std::invalid_argument for a marker above the end's current position
+    void freeToMarker(const Marker& marker);
+    void clear(End end);
+    size_t getUsed(End end) const;  // Bytes consumed by one end, padding included
+    size_t getRemaining() const;    // Gap between the two ends
+
+private:
+    // Per end: offsets are from the bottom of the region for both
+    struct Stack {
+        size_t offset;
+        size_t allocations;         // Since the region was last empty
+        size_t bytes;               // Requested bytes since then
+    };
+
+    Stack& stack(End end) { return end == End::BOTTOM ? bottom_ : top_; }
+    const Stack& stack(End end) const { return end == End::BOTTOM ? bottom_ : top_; }
+    void popTo(End end, const Stack& target);
+
+    char* memory_;
+    size_t mapped_size_;
+    Stack bottom_;
+    Stack top_;
+    mutable ContendedMutex mutex_;
+};
+
+#endif // STACK_ALLOCATOR_H
@@ -0,0 +1,109 @@
+#ifndef STATS_COUNTERS_H
+#define STATS_COUNTERS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Sharded allocation statistics
+ *
+ * Every thread owns a shard (one cache line) and updates it with relaxed
+ * loads and stores, no read-modify-write; readers sum the shards, so the
+ * allocation path never writes a line another core is writing. A thread
+ * keeps its shard index for every StatsCounters and gives it back on exit.
+ * While more than kShards - 1 threads are alive, the extra ones share the
+ * last shard and fall back to atomic increments there.
+ *
+ * Counts and bytes are exact. The peak is exact for a single thread; each shard
+ * folds its net bytes into a shared total only after they move by kPeakBatch,
+ * so with several threads the reported peak may overshoot by at most
+ * (kShards - 1) * kPeakBatch.
+ *
+ * Optional per-class counters (size classes, tiers...) follow the same layout.
+ */
+class StatsCounters {
+public:
+    static constexpr size_t kShards = 32;
+    static constexpr int64_t kPeakBatch = 64 * 1024;
+    static constexpr size_t kNoClass = static_cast<size_t>(-1);
+
+    struct Snapshot {
+        size_t bytes_allocated = 0;   // Cumulative
+        size_t bytes_freed = 0;       // Cumulative
+        size_t current_bytes = 0;
+        size_t peak_bytes = 0;
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t failures = 0;
+    };
+
+    struct ClassSnapshot {
+        size_t bytes_allocated = 0;
+        size_t allocations = 0;
+        size_t deallocations = 0;
+        size_t failures = 0;
+    };
+
+    explicit StatsCounters(size_t class_count = 0);
+
+    // Must not run concurrently with updates
+    void setClassCount(size_t class_count);
+    size_t getClassCount() const { return class_count_; }
+    void reset();
+
+    // Hot path: relaxed updates to the calling thread's shard
+    void recordAllocation(size_t bytes, size_t size_class = kNoClass, size_t count = 1);
+    void recordDeallocation(size_t bytes, size_t size_class = kNoClass, size_t count = 1);
+    void recordFailure(size_t size_class = kNoClass, size_t count = 1);
+    void recordResize(size_t old_bytes, size_t new_bytes, size_t size_class = kNoClass); // Bytes only, no counts
+
+    // Aggregated on read
+    Snapshot snapshot() const;
+    ClassSnapshot classSnapshot(size_t size_class) const;
+    size_t currentBytes() const;
+    size_t allocations() const;
+    size_t deallocations() const;
+
+private:
+    static constexpr size_t kSharedShard = kShards - 1; // Threads without a shard of their own
+
+    struct alignas(64) Shard {
+        std::atomic<size_t> bytes_allocated{0};
+        std::atomic<size_t> bytes_freed{0};
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> deallocations{0};
+        std::atomic<size_t> failures{0};
+        std::atomic<int64_t> pending{0};      // Net bytes not yet folded into published_
+        std::atomic<int64_t> pending_peak{0}; // Highest pending since the last fold
+    };
+
+    struct ClassCounters {
+        std::atomic<size_t> bytes_allocated{0};
+        std::atomic<size_t> allocations{0};
+        std::atomic<size_t> deallocations{0};
+        std::atomic<size_t> failures{0};
+    };
+
+    // Two classes per cache line; each shard's classes start on a new line
+    struct alignas(64) ClassLine {
+        ClassCounters counters[2];
+    };
+
+    static size_t shardIndex();
+    ClassCounters* classCounters(size_t shard, size_t size_class) const;
+    void addPending(Shard& shard, int64_t bytes, bool exclusive);
+    void publish(Shard& shard);
+
+    std::unique_ptr<Shard[]> shards_;
+    std::unique_ptr<ClassLine[]> class_lines_;
+    size_t class_count_;
+    size_t lines_per_shard_;
+
+    // Written once per kPeakBatch bytes per shard
+    alignas(64) std::atomic<int64_t> published_{0};
+    std::atomic<int64_t> peak_{0};
+};
+
+#endif // STATS_COUNTERS_H
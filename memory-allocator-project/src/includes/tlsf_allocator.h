@@ -0,0 +1,101 @@
+#ifndef TLSF_ALLOCATOR_H
+#define TLSF_ALLOCATOR_H
+
+#include "memory_allocator.h"
+#include "contended_mutex.h"
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Two-Level Segregated Fit allocator: O(1) worst case, good-fit packing
+ *
+ * Free blocks are kept in lists indexed by two levels: the first by the power of
+ * two of the size, the second splitting each power-of-two range into 32 linear
+ * steps (sizes below 512 bytes get 16-byte steps). A bitmap per level finds the
+ * smallest non-empty list that fits with two find-first-set instructions, so no
+ * search depends on how many blocks there are. Blocks carry boundary tags (the
+ * previous physical block's address and a free bit) and are merged with their
+ * free neighbours as soon as they are freed.
+ *
+ * Requests are rounded up to 16 bytes plus the next second-level step, not to a
+ * power of two, so at most about 1/32 of a block is wasted instead of half. When
+ * no list of the rounded size has a block, the first block of the request's own
+ * list is tried as well, so the last free bytes of the region stay usable.
+ */
+class TlsfAllocator : public MemoryAllocator {
+public:
+    static constexpr size_t kAlignment = 16;
+
+    explicit TlsfAllocator(size_t total_memory = 1024 * 1024);
+    ~TlsfAllocator() override;
+
+    // Core allocation methods
+    void* allocate(size_t size) override;
+    void deallocate(void* ptr) override;
+    using MemoryAllocator::deallocate; // Sized overload, falls back to deallocate(ptr)
+
+    // Statistics and info
+    size_t getFragmentation() const override;
+    std::string getStats() const override;
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override;
+    LockStats getLockStats() const override { return {mutex_.getAcquisitions(), mutex_.getContended()}; }
+
+    // Frees everything, back to one free block
+    void reset() override;
+
+    // TLSF-specific methods
+    size_t getLargestFreeBlock() const;
+    size_t getFreeBlockCount() const;
+    size_t getBlockSize(void* ptr) const;   // Usable bytes, 0 if ptr is not allocated
+    bool checkHeap() const;                 // Walks every block; false on any inconsistency
+
+private:
+    static constexpr size_t kSlIndexCountLog2 = 5;
+    static constexpr size_t kSlIndexCount = size_t(1) << kSlIndexCountLog2;
+    static constexpr size_t kFlIndexShift = kSlIndexCountLog2 + 4;  // 4 = log2(kAlignment)
+    static constexpr size_t kSmallBlockSize = size_t(1) << kFlIndexShift;
+    static constexpr size_t kFlIndexCount = 32;                     // One bit each in fl_bitmap_
+    static constexpr size_t kMaxBlockSize = (size_t(1) << (kFlIndexCount + kFlIndexShift - 1)) - 1; // Under 1 TB
+
+    // Boundary tag at the start of every block; the payload follows it
+    struct Block {
+        Block* prev_phys;           // Previous block in memory, nullptr for the first
+        size_t size;                // Payload bytes | kFreeBit
+        // Only while free
+        Block* next_free;
+        Block* prev_free;
+    };
+    static constexpr size_t kHeaderSize = 2 * sizeof(void*);
+    static constexpr size_t kMinBlockSize = sizeof(Block) - kHeaderSize;
+    static constexpr size_t kFreeBit = 1;   // Sizes are multiples of kAlignment
+
+    static size_t blockSize(const Block* block) { return block->size & ~kFreeBit; }
+    static bool isFree(const Block* block) { return block->size & kFreeBit; }
+    static Block* nextPhys(const Block* block);
+    static void* payload(const Block* block);
+    static void mappingInsert(size_t size, size_t& fl, size_t& sl);
+
+    // One latency histogram per first-level index
+    size_t getLatencyClassCount() const override { return kFlIndexCount; }
+
+    void format();
+    void insertFree(Block* block);
+    void removeFree(Block* block);
+    Block* findFree(size_t size, size_t& fl);
+    Block* blockFromPointer(void* ptr) const;   // nullptr unless an allocated block
+
+    char* memory_;
+    size_t mapped_size_;
+    size_t usable_size_;            // Region up to the end sentinel
+    Block* sentinel_;               // Zero-size, always allocated: every block has a next
+    uint32_t fl_bitmap_;
+    uint32_t sl_bitmap_[kFlIndexCount];
+    Block* free_lists_[kFlIndexCount][kSlIndexCount];
+    size_t free_blocks_;
+    size_t free_bytes_;             // Payload bytes of the free blocks
+    size_t splits_;
+    size_t merges_;
+    mutable ContendedMutex mutex_;
+};
+
+#endif // TLSF_ALLOCATOR_H
@@ -0,0 +1,272 @@
+#include "../includes/hybrid_allocator.h"
+#include "../includes/allocation_trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <new>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @brief malloc/free replacement on top of HybridAllocator (Linux, glibc)
+ *
+ * Build with `make preload`, then run any binary with
+ *   LD_PRELOAD=bin/libhybrid_malloc.so ./program
+ *
+ * Environment:
+ * - HYBRID_MALLOC_SIZE:   bytes reserved for the allocator (default 1 GB, committed lazily)
+ * - HYBRID_MALLOC_CONFIG: HybridConfig string, or "@path" to a file written by hybrid_tuner
+ * - HYBRID_MALLOC_STATS:  when set, getStats() is written to stderr at exit
+ * - HYBRID_MALLOC_TRACE:  path of a binary allocation trace for tools/trace_replay;
+ *                         only calls the allocator serves are recorded
+ *
+ * Bootstrap: glibc's own malloc serves every call made before the allocator is
+ * constructed (and from other threads while it is being constructed), plus the
+ * allocator's internal bookkeeping (buddy tree nodes, maps), which would otherwise
+ * recurse into itself. free() sends a pointer back to whoever owns it, so those
+ * blocks never mix. Requests the tiers cannot satisfy fall back to glibc too.
+ *
+ * The allocator is never destroyed: destructors of other libraries may still free
+ * memory after ours would have run.
+ */
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace {
+
+constexpr size_t kDefaultMemory = 1024UL * 1024 * 1024;
+constexpr size_t kMinAlignment = 16; // alignof(max_align_t) on x86-64 and AArch64
+
+enum State { kUninitialized, kConstructing, kReady };
+
+std::atomic<int> state{kUninitialized};
+alignas(HybridAllocator) unsigned char storage[sizeof(HybridAllocator)];
+HybridAllocator* allocator = nullptr;
+TraceWriter* tracer = nullptr;
+std::atomic<size_t> fallbacks{0};
+size_t (*libc_usable_size)(void*) = nullptr;
+
+// Depth of malloc calls made from inside the allocator on this thread (initial-exec TLS never allocates)
+__thread int nesting __attribute__((tls_model("initial-exec"))) = 0;
+
+struct NestingGuard {
+    NestingGuard() { ++nesting; }
+    ~NestingGuard() { --nesting; }
+};
+
+size_t parseSize(const char* text, size_t fallback) {
+    if (!text || !*text) return fallback;
+    char* end = nullptr;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    return value > 0 ? static_cast<size_t>(value) : fallback;
+}
+
+void construct() {
+    NestingGuard guard;
+    libc_usable_size = reinterpret_cast<size_t (*)(void*)>(dlsym(RTLD_NEXT, "malloc_usable_size"));
+    
+    try {
+        const char* config_text = std::getenv("HYBRID_MALLOC_CONFIG");
+        HybridAllocator::HybridConfig config;
+        if (config_text && *config_text == '@') {
+            config = HybridAllocator::HybridConfig::load(config_text + 1);
+        } else if (config_text && *config_text) {
+            config = HybridAllocator::HybridConfig::fromString(config_text);
+        }
+        allocator = new (storage) HybridAllocator(parseSize(std::getenv("HYBRID_MALLOC_SIZE"), kDefaultMemory),
+                                                  config);
+    } catch (...) {
+        allocator = nullptr; // Bad config or no address space: stay on glibc
+    }
+    
+    const char* trace_path = std::getenv("HYBRID_MALLOC_TRACE");
+    if (allocator && trace_path && *trace_path) {
+        try {
+            tracer = new TraceWriter(trace_path); // From glibc, never freed
+        } catch (...) {
+            tracer = nullptr;
+        }
+    }
+}
+
+// nullptr while bootstrapping or when called from inside the allocator
+HybridAllocator* instance() {
+    if (nesting > 0) return nullptr;
+
+    int current = state.load(std::memory_order_acquire);
+    if (current == kReady) return allocator;
+
+    int expected = kUninitialized;
+    if (current == kUninitialized &&
+        state.compare_exchange_strong(expected, kConstructing, std::memory_order_acq_rel)) {
+        construct();
+        state.store(kReady, std::memory_order_release);
+        return allocator;
+    }
+    return nullptr; // Another thread is constructing it
+}
+
+void* allocateAligned(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+
+    HybridAllocator* hybrid = instance();
+    if (hybrid) {
+        NestingGuard guard;
+        void* ptr = hybrid->allocateAligned(size, alignment);
+        if (ptr) {
+            if (tracer) tracer->recordAllocation(ptr, size, alignment > kMinAlignment ? alignment : 0);
+            return ptr;
+        }
+        fallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    return alignment <= kMinAlignment ? __libc_malloc(size) : __libc_memalign(alignment, size);
+}
+
+// Only pointers the allocator handed out; glibc keeps its own
+HybridAllocator* ownerOf(void* ptr) {
+    if (nesting > 0 || state.load(std::memory_order_acquire) != kReady || !allocator) {
+        return nullptr;
+    }
+    NestingGuard guard;
+    return allocator->owns(ptr) ? allocator : nullptr;
+}
+
+void writeStats() {
+    if (!allocator || !std::getenv("HYBRID_MALLOC_STATS")) return;
+
+    NestingGuard guard; // getStats() holds the allocator's locks while building strings
+    std::string stats = allocator->getStats();
+    stats += "glibc fallbacks: " + std::to_string(fallbacks.load(std::memory_order_relaxed)) + "\n";
+    ssize_t written = ::write(STDERR_FILENO, stats.data(), stats.size());
+    (void)written;
+}
+
+struct StatsAtExit {
+    ~StatsAtExit() {
+        if (tracer) {
+            NestingGuard guard;
+            tracer->finish(); // Later calls are no longer recorded
+        }
+        writeStats();
+    }
+} stats_at_exit;
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+    return allocateAligned(size, kMinAlignment);
+}
+
+void free(void* ptr) {
+    if (!ptr) return;
+
+    HybridAllocator* hybrid = ownerOf(ptr);
+    if (hybrid) {
+        NestingGuard guard;
+        if (tracer) tracer->recordDeallocation(ptr);
+        hybrid->deallocate(ptr);
+    } else {
+        __libc_free(ptr);
+    }
+}
+
+void* calloc(size_t count, size_t size) {
+    if (size != 0 && count > static_cast<size_t>(-1) / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    if (!instance()) {
+        return __libc_calloc(count, size);
+    }
+
+    // Blocks are recycled, so they must be cleared
+    void* ptr = allocateAligned(count * size, kMinAlignment);
+    if (ptr) std::memset(ptr, 0, count * size);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) return malloc(size);
+    if (size == 0) {
+        free(ptr);
+        return nullptr;
+    }
+
+    HybridAllocator* hybrid = ownerOf(ptr);
+    if (!hybrid) {
+        return __libc_realloc(ptr, size);
+    }
+
+    NestingGuard guard;
+    // Traced as a free and a new allocation, and only once the block has moved:
+    // a failed realloc leaves ptr live
+    void* moved = hybrid->reallocate(ptr, (size + kMinAlignment - 1) & ~(kMinAlignment - 1), kMinAlignment);
+    if (moved) {
+        if (tracer) {
+            tracer->recordDeallocation(ptr);
+            tracer->recordAllocation(moved, size);
+        }
+        return moved;
+    }
+
+    // Tiers exhausted: move the block to glibc
+    moved = __libc_malloc(size);
+    if (moved) {
+        std::memcpy(moved, ptr, std::min(size, hybrid->usableSize(ptr)));
+        if (tracer) tracer->recordDeallocation(ptr); // Before the block can be handed out again
+        hybrid->deallocate(ptr);
+        fallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+    return moved;
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* ptr = allocateAligned(size, std::max(alignment, kMinAlignment));
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return allocateAligned(size, std::max(alignment, kMinAlignment));
+}
+
+void* memalign(size_t alignment, size_t size) {
+    return aligned_alloc(alignment, size);
+}
+
+void* valloc(size_t size) {
+    return allocateAligned(size, static_cast<size_t>(sysconf(_SC_PAGESIZE)));
+}
+
+size_t malloc_usable_size(void* ptr) {
+    if (!ptr) return 0;
+
+    HybridAllocator* hybrid = ownerOf(ptr);
+    if (!hybrid) {
+        return libc_usable_size ? libc_usable_size(ptr) : 0;
+    }
+
+    NestingGuard guard;
+    return hybrid->usableSize(ptr);
+}
+
+} // extern "C"
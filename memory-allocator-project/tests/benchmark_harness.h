@@ -0,0 +1,231 @@
+#ifndef BENCHMARK_HARNESS_H
+#define BENCHMARK_HARNESS_H
+
+#include "../src/includes/memory_allocator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+/**
+ * @brief Repeatable measurements for performance_tests
+ *
+ * A case runs its warm-up repetitions untimed (faulting in pages, filling free
+ * lists), then its timed repetitions on the same allocator. Each repetition
+ * gives one ns-per-operation sample; the summary reports median, mean, standard
+ * deviation, min and max, and every case can be written out as JSON.
+ */
+struct BenchmarkOptions {
+    size_t repetitions = 5;
+    size_t warmup = 1;
+    int cpu = -1;                 // Pin the process to this CPU; -1 leaves it unpinned
+    std::string json_path;        // Empty: no JSON
+    std::string filter;           // Only cases whose name contains this
+    bool matrix_only = false;     // Skip the numbered sections before the matrix
+    std::vector<size_t> thread_counts = defaultThreadCounts();
+
+    // Throws std::invalid_argument on an unknown flag
+    static BenchmarkOptions parse(int argc, char* argv[]) {
+        BenchmarkOptions options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+
+            if (arg == "--repetitions" && has_value) options.repetitions = std::max<size_t>(std::stoul(argv[++i]), 1);
+            else if (arg == "--warmup" && has_value) options.warmup = std::stoul(argv[++i]);
+            else if (arg == "--cpu" && has_value) options.cpu = std::stoi(argv[++i]);
+            else if (arg == "--json" && has_value) options.json_path = argv[++i];
+            else if (arg == "--filter" && has_value) options.filter = argv[++i];
+            else if (arg == "--threads" && has_value) options.thread_counts = parseList(argv[++i]);
+            else if (arg == "--matrix-only") options.matrix_only = true;
+            else throw std::invalid_argument("unknown option " + arg);
+        }
+        return options;
+    }
+
+    // 1, 2, 4, ... up to the hardware threads (at least 4)
+    static std::vector<size_t> defaultThreadCounts() {
+        size_t limit = std::max<size_t>(std::thread::hardware_concurrency(), 4);
+        std::vector<size_t> counts;
+        for (size_t threads = 1; threads <= limit; threads *= 2) counts.push_back(threads);
+        if (counts.back() != limit) counts.push_back(limit);
+        return counts;
+    }
+
+    // "1,2,8" -> {1, 2, 8}
+    static std::vector<size_t> parseList(const std::string& text) {
+        std::vector<size_t> values;
+        size_t start = 0;
+        while (start < text.size()) {
+            size_t end = text.find(',', start);
+            if (end == std::string::npos) end = text.size();
+            size_t value = std::stoul(text.substr(start, end - start));
+            if (value == 0) throw std::invalid_argument("thread counts must be positive");
+            values.push_back(value);
+            start = end + 1;
+        }
+        if (values.empty()) throw std::invalid_argument("empty list " + text);
+        return values;
+    }
+};
+
+struct SampleSummary {
+    size_t samples = 0;
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double min = 0.0;
+    double max = 0.0;
+
+    static SampleSummary of(std::vector<double> values) {
+        SampleSummary summary;
+        summary.samples = values.size();
+        if (values.empty()) return summary;
+
+        std::sort(values.begin(), values.end());
+        size_t middle = values.size() / 2;
+        summary.median = values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+        summary.min = values.front();
+        summary.max = values.back();
+
+        double sum = 0.0;
+        for (double value : values) sum += value;
+        summary.mean = sum / values.size();
+
+        double squares = 0.0;
+        for (double value : values) squares += (value - summary.mean) * (value - summary.mean);
+        summary.stddev = values.size() > 1 ? std::sqrt(squares / (values.size() - 1)) : 0.0;
+        return summary;
+    }
+
+    // Relative spread, to spot noisy cases
+    double cv() const { return mean > 0.0 ? stddev / mean : 0.0; }
+};
+
+/**
+ * @brief malloc/free as a MemoryAllocator, the baseline every allocator is compared to
+ */
+class SystemAllocator : public MemoryAllocator {
+public:
+    SystemAllocator() : MemoryAllocator(0) {}
+
+    void* allocate(size_t size) override { return std::malloc(size); }
+    void deallocate(void* ptr) override { std::free(ptr); }
+    size_t getFragmentation() const override { return 0; }
+    std::string getStats() const override { return "System malloc\n"; }
+    std::vector<MemoryAllocator::MemoryBlock> getMemoryLayout() const override { return {}; }
+};
+
+class BenchmarkHarness {
+public:
+    struct CaseResult {
+        std::string workload;
+        std::string allocator;
+        size_t size;
+        size_t operations;            // Per repetition, over all threads
+        SampleSummary ns_per_op;      // Wall time / operations
+        size_t threads = 1;
+        MemoryAllocator::LockStats locks; // Filled in by multithreaded cases
+    };
+
+    explicit BenchmarkHarness(const BenchmarkOptions& options) : options_(options) {}
+
+    const BenchmarkOptions& getOptions() const { return options_; }
+    const std::vector<CaseResult>& getResults() const { return results_; }
+
+    bool selected(const std::string& name) const {
+        return options_.filter.empty() || name.find(options_.filter) != std::string::npos;
+    }
+
+    // body() runs one repetition and returns how many operations it timed
+    template<typename Body>
+    CaseResult& run(const std::string& workload, const std::string& allocator, size_t size, Body body) {
+        for (size_t i = 0; i < options_.warmup; ++i) {
+            body();
+        }
+
+        CaseResult result{workload, allocator, size, 0, {}, 1, {}};
+        std::vector<double> samples;
+        samples.reserve(options_.repetitions);
+        for (size_t i = 0; i < options_.repetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            size_t operations = body();
+            auto end = std::chrono::steady_clock::now();
+
+            result.operations = operations;
+            double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+            samples.push_back(operations ? elapsed_ns / operations : 0.0);
+        }
+        result.ns_per_op = SampleSummary::of(samples);
+        results_.push_back(result);
+        return results_.back();
+    }
+
+    // Returns false when pinning is unsupported or the CPU does not exist
+    static bool pinToCpu(int cpu) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)cpu;
+        return false;
+#endif
+    }
+
+    bool writeJson() const {
+        if (options_.json_path.empty()) return true;
+
+        std::ofstream file(options_.json_path);
+        if (!file) return false;
+
+        file << std::setprecision(6);
+        file << "{\n  \"context\": {\"repetitions\": " << options_.repetitions
+             << ", \"warmup\": " << options_.warmup
+             << ", \"pinned_cpu\": " << options_.cpu
+             << ", \"hardware_threads\": " << std::thread::hardware_concurrency()
+             << ", \"compiler\": \"" << compilerName() << "\"},\n";
+        file << "  \"results\": [\n";
+        for (size_t i = 0; i < results_.size(); ++i) {
+            const CaseResult& r = results_[i];
+            const SampleSummary& s = r.ns_per_op;
+            file << "    {\"workload\": \"" << r.workload << "\", \"allocator\": \"" << r.allocator
+                 << "\", \"size\": " << r.size << ", \"operations\": " << r.operations
+                 << ", \"threads\": " << r.threads << ", \"lock_acquisitions\": " << r.locks.acquisitions
+                 << ", \"lock_contended\": " << r.locks.contended
+                 << ", \"samples\": " << s.samples << ", \"ns_per_op\": {\"median\": " << s.median
+                 << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+                 << ", \"min\": " << s.min << ", \"max\": " << s.max << "}}"
+                 << (i + 1 < results_.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n}\n";
+        return static_cast<bool>(file);
+    }
+
+private:
+    static std::string compilerName() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#else
+        return "unknown";
+#endif
+    }
+
+    BenchmarkOptions options_;
+    std::vector<CaseResult> results_;
+};
+
+#endif // BENCHMARK_HARNESS_H
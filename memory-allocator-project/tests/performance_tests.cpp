@@ -2,12 +2,24 @@
 #include "../src/includes/slab_allocator.h"
 #include "../src/includes/pool_allocator.h"
 #include "../src/includes/hybrid_allocator.h"
+#include "../src/includes/arena_allocator.h"
+#include "../src/includes/stack_allocator.h"
+#include "../src/includes/frame_allocator.h"
+#include "../src/includes/tlsf_allocator.h"
+#include "../src/includes/allocator_adapters.h"
+#include "benchmark_harness.h"
 #include <iostream>
 #include <vector>
 #include <random>
 #include <chrono>
 #include <algorithm>
 #include <iomanip>
+#include <memory>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <list>
+#include <map>
 
 struct BenchmarkResult {
     std::string allocator_name;
@@ -23,21 +35,46 @@ struct BenchmarkResult {
 
 class MemoryAllocatorBenchmark {
 public:
-    static void runComprehensiveBenchmarks() {
+    static void runComprehensiveBenchmarks(BenchmarkHarness& harness) {
         std::cout << "Memory Allocator Performance Benchmark Suite\n";
         std::cout << "============================================\n\n";
         
+        if (!harness.getOptions().matrix_only) {
+            runScenarioBenchmarks();
+        }
+        runAllocatorMatrix(harness);
+        runScalabilityBenchmark(harness);
+        runRemoteFreeBenchmark(harness);
+        
+        const BenchmarkOptions& options = harness.getOptions();
+        if (!options.json_path.empty()) {
+            if (harness.writeJson()) {
+                std::cout << "Results written to " << options.json_path << "\n";
+            } else {
+                std::cerr << "Could not write " << options.json_path << "\n";
+            }
+        }
+        
+        std::cout << "\nBenchmark suite completed!\n";
+    }
+
+private:
+    static void runScenarioBenchmarks() {
         // Different test scenarios
         runFixedSizeBenchmark();
         runVariableSizeBenchmark();
         runFragmentationBenchmark();
         runStressBenchmark();
         runRealWorldSimulation();
-        
-        std::cout << "\nBenchmark suite completed!\n";
+        runBatchBenchmark();
+        runHybridContentionBenchmark();
+        runSizeClassWasteBenchmark();
+        runContainerBenchmark();
+        runSizedDeallocationBenchmark();
+        runStatsCounterBenchmark();
+        runLatencySamplingBenchmark();
     }
-
-private:
+    
     static void runFixedSizeBenchmark() {
         std::cout << "1. Fixed Size Allocation Benchmark (64 bytes)\n";
         std::cout << "----------------------------------------------\n";
@@ -78,6 +115,7 @@ private:
         
         // Benchmark allocators with variable sizes
         results.push_back(benchmarkBuddyAllocatorVariable("Buddy", memory_size, sizes));
+        results.push_back(benchmarkTlsfAllocatorVariable("TLSF", memory_size, sizes));
         results.push_back(benchmarkHybridAllocatorVariable("Hybrid", memory_size, sizes));
         
         printBenchmarkResults(results);
@@ -92,6 +130,7 @@ private:
         
         // Test fragmentation with alternating allocate/deallocate pattern
         testFragmentation<BuddyAllocator>("Buddy", memory_size);
+        testFragmentation<TlsfAllocator>("TLSF", memory_size);
         testFragmentation<HybridAllocator>("Hybrid", memory_size);
         
         std::cout << "\n";
@@ -125,6 +164,916 @@ private:
         std::cout << "\n";
     }
     
+    static void runBatchBenchmark() {
+        std::cout << "6. Batch Allocation Benchmark (64 bytes, per-object cost)\n";
+        std::cout << "---------------------------------------------------------\n";
+        
+        const size_t total_objects = 256 * 1024;
+        const size_t alloc_size = 64;
+        const std::vector<size_t> batch_sizes = {1, 8, 32, 64, 128, 256};
+        
+        std::cout << std::setw(10) << "Batch"
+                  << std::setw(16) << "Pool (ns/obj)"
+                  << std::setw(16) << "Slab (ns/obj)" << "\n";
+        std::cout << std::string(42, '-') << "\n";
+        
+        for (size_t batch : batch_sizes) {
+            PoolAllocator::PoolConfig pool_config;
+            pool_config.block_sizes = {alloc_size};
+            pool_config.blocks_per_pool = {batch};
+            pool_config.total_memory = alloc_size * batch;
+            PoolAllocator pool(pool_config);
+            
+            SlabAllocator slab(alloc_size, 256, 4 * (alloc_size * 256 + 64));
+            
+            std::cout << std::setw(10) << batch
+                      << std::setw(16) << std::fixed << std::setprecision(1)
+                      << measureBatchCost(pool, alloc_size, batch, total_objects)
+                      << std::setw(16) << std::fixed << std::setprecision(1)
+                      << measureBatchCost(slab, alloc_size, batch, total_objects) << "\n";
+        }
+        
+        std::cout << "\n";
+    }
+    
+    static void runHybridContentionBenchmark() {
+        std::cout << "7. Hybrid Multithreaded Contention (distinct vs shared size class)\n";
+        std::cout << "-------------------------------------------------------------------\n";
+        
+        const std::vector<size_t> class_sizes = {8, 16, 32, 64, 128, 256};
+        const size_t ops_per_thread = 200000;
+        
+        std::cout << std::setw(10) << "Threads"
+                  << std::setw(20) << "Distinct (Mops/s)"
+                  << std::setw(20) << "Shared (Mops/s)" << "\n";
+        std::cout << std::string(50, '-') << "\n";
+        
+        for (size_t threads : {1, 2, 4}) {
+            double distinct = measureHybridThroughput(threads, ops_per_thread, class_sizes);
+            double shared = measureHybridThroughput(threads, ops_per_thread, {64});
+            
+            std::cout << std::setw(10) << threads
+                      << std::setw(20) << std::fixed << std::setprecision(2) << distinct
+                      << std::setw(20) << std::fixed << std::setprecision(2) << shared << "\n";
+        }
+        
+        std::cout << "\n";
+    }
+    
+    static void runSizeClassWasteBenchmark() {
+        std::cout << "8. Internal Fragmentation (bytes requested vs consumed, Hybrid)\n";
+        std::cout << "--------------------------------------------------------------\n";
+        
+        // The classes HybridAllocator used before the geometric table
+        HybridAllocator::HybridConfig fixed_config;
+        fixed_config.pool_block_sizes = {8, 16, 32, 64, 128, 256};
+        fixed_config.slab_object_sizes = {64, 128, 256, 512};
+        fixed_config.slab_objects_per_slab = {32, 24, 16, 8};
+        fixed_config.slab_max_size = 1024;
+        HybridAllocator::HybridConfig geometric_config;
+        
+        std::mt19937 gen(42);
+        auto uniform = [&gen](size_t min_size, size_t max_size) {
+            return std::uniform_int_distribution<size_t>(min_size, max_size)(gen);
+        };
+        
+        std::vector<std::pair<std::string, std::vector<size_t>>> workloads;
+        workloads.push_back({"Variable", generateRandomSizes(20000, 16, 2048)});
+        
+        std::vector<size_t> web;
+        for (int request = 0; request < 2000; ++request) {
+            web.insert(web.end(), {256, 1024, 512, 128});       // Fixed request structures
+            web.push_back(uniform(200, 700));                   // Headers
+            web.push_back(uniform(900, 1500));                  // Body
+        }
+        workloads.push_back({"WebServer", web});
+        
+        std::vector<size_t> game;
+        for (int frame = 0; frame < 60; ++frame) {
+            game.insert(game.end(), {2048, 1024, 512});
+            for (int obj = 0; obj < 50; ++obj) game.push_back(64);
+            for (int particle = 0; particle < 100; ++particle) game.push_back(uniform(24, 200));
+        }
+        workloads.push_back({"GameEngine", game});
+        
+        std::cout << std::setw(12) << "Workload"
+                  << std::setw(12) << "Classes"
+                  << std::setw(14) << "Requested"
+                  << std::setw(14) << "Consumed"
+                  << std::setw(10) << "Waste %" << "\n";
+        std::cout << std::string(62, '-') << "\n";
+        
+        for (const auto& workload : workloads) {
+            printWaste(workload.first, "Fixed", fixed_config, workload.second);
+            printWaste(workload.first, "Geometric", geometric_config, workload.second);
+        }
+        
+        std::cout << "\n";
+    }
+    
+    static void runContainerBenchmark() {
+        std::cout << "9. Node-based Containers (std::pmr::map insert/erase, std::pmr::list churn)\n";
+        std::cout << "---------------------------------------------------------------------------\n";
+        
+        const size_t elements = 20000;
+        
+        PoolAllocator::PoolConfig pool_config;
+        pool_config.block_sizes = {32, 64};   // List nodes, map nodes
+        pool_config.blocks_per_pool = {elements * 2, elements * 2};
+        pool_config.total_memory = elements * 2 * (32 + 64);
+        PoolAllocator pool(pool_config);
+        SlabAllocator slab(64, 64, elements * 4 * 64 + 64 * 1024);
+        HybridAllocator hybrid(16 * 1024 * 1024);
+        
+        MemoryResourceAdapter pool_resource(pool);
+        MemoryResourceAdapter slab_resource(slab);
+        MemoryResourceAdapter hybrid_resource(hybrid);
+        
+        std::cout << std::setw(14) << "Resource"
+                  << std::setw(20) << "Map (ms)"
+                  << std::setw(20) << "List (ms)" << "\n";
+        std::cout << std::string(54, '-') << "\n";
+        
+        printContainerCost("new/delete", std::pmr::new_delete_resource(), elements);
+        printContainerCost("Pool", &pool_resource, elements);
+        printContainerCost("Slab", &slab_resource, elements);
+        printContainerCost("Hybrid", &hybrid_resource, elements);
+        
+        std::cout << "\n";
+    }
+    
+    static void runSizedDeallocationBenchmark() {
+        std::cout << "10. Sized vs Unsized Deallocation (ns per free, -DNDEBUG drops the size checks)\n";
+        std::cout << "-------------------------------------------------------------------------------\n";
+        
+        const size_t count = 20000;
+        std::vector<size_t> small_sizes = generateRandomSizes(count, 8, 64);
+        std::vector<size_t> mixed_sizes = generateRandomSizes(count, 16, 2048);
+        
+        std::cout << std::setw(12) << "Allocator"
+                  << std::setw(16) << "Unsized"
+                  << std::setw(16) << "Sized" << "\n";
+        std::cout << std::string(44, '-') << "\n";
+        
+        auto print = [](const std::string& name, double unsized, double sized) {
+            std::cout << std::setw(12) << name
+                      << std::setw(16) << std::fixed << std::setprecision(1) << unsized
+                      << std::setw(16) << std::fixed << std::setprecision(1) << sized << "\n";
+        };
+        
+        {
+            BuddyAllocator unsized_buddy(64 * 1024 * 1024), sized_buddy(64 * 1024 * 1024);
+            print("Buddy", measureFreeCost(unsized_buddy, mixed_sizes, false),
+                  measureFreeCost(sized_buddy, mixed_sizes, true));
+        }
+        {
+            PoolAllocator::PoolConfig pool_config;
+            pool_config.block_sizes = {8, 16, 32, 64};
+            pool_config.blocks_per_pool = {count, count, count, count};
+            pool_config.total_memory = count * (8 + 16 + 32 + 64);
+            PoolAllocator unsized_pool(pool_config), sized_pool(pool_config);
+            print("Pool", measureFreeCost(unsized_pool, small_sizes, false),
+                  measureFreeCost(sized_pool, small_sizes, true));
+        }
+        {
+            SlabAllocator unsized_slab(64, 64, count * 80), sized_slab(64, 64, count * 80);
+            print("Slab", measureFreeCost(unsized_slab, small_sizes, false),
+                  measureFreeCost(sized_slab, small_sizes, true));
+        }
+        {
+            HybridAllocator unsized_hybrid(64 * 1024 * 1024), sized_hybrid(64 * 1024 * 1024);
+            print("Hybrid", measureFreeCost(unsized_hybrid, mixed_sizes, false),
+                  measureFreeCost(sized_hybrid, mixed_sizes, true));
+        }
+        
+        std::cout << "\n";
+    }
+    
+    static void runStatsCounterBenchmark() {
+        std::cout << "11. Statistics Counters (ns per allocation + free record)\n";
+        std::cout << "--------------------------------------------------------\n";
+        
+        const size_t operations = 1000000;
+        unsigned int max_threads = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+        
+        std::cout << std::setw(10) << "Threads"
+                  << std::setw(18) << "Shared atomics"
+                  << std::setw(18) << "Sharded" << "\n";
+        std::cout << std::string(46, '-') << "\n";
+        
+        for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+            // What the allocators did before: every thread bumps the same cache line
+            std::atomic<size_t> allocated{0}, allocations{0}, deallocations{0};
+            double shared = timeThreads(threads, [&]() {
+                for (size_t i = 0; i < operations; ++i) {
+                    allocated.fetch_add(64, std::memory_order_relaxed);
+                    allocations.fetch_add(1, std::memory_order_relaxed);
+                    allocated.fetch_sub(64, std::memory_order_relaxed);
+                    deallocations.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+            
+            StatsCounters counters(8);
+            double sharded = timeThreads(threads, [&]() {
+                for (size_t i = 0; i < operations; ++i) {
+                    counters.recordAllocation(64, i % 8);
+                    counters.recordDeallocation(64, i % 8);
+                }
+            });
+            
+            std::cout << std::setw(10) << threads
+                      << std::setw(18) << std::fixed << std::setprecision(1) << shared / operations
+                      << std::setw(18) << std::fixed << std::setprecision(1) << sharded / operations << "\n";
+        }
+        
+        std::cout << "\n";
+    }
+    
+    static void runLatencySamplingBenchmark() {
+        std::cout << "12. Latency Sampling (ns per allocate + free, best of 3, then sampled percentiles)\n";
+        std::cout << "---------------------------------------------------------------------------------\n";
+        
+        const size_t operations = 200000;
+        std::vector<size_t> sizes = generateRandomSizes(operations, 16, 1024);
+        
+        std::cout << std::setw(12) << "Allocator"
+                  << std::setw(12) << "Off"
+                  << std::setw(12) << "1 in 64"
+                  << std::setw(12) << "Every" << "\n";
+        std::cout << std::string(48, '-') << "\n";
+        
+        auto cost = [&](MemoryAllocator& allocator, uint32_t sample_every) {
+            if (sample_every) allocator.enableLatencySampling(sample_every);
+            else allocator.disableLatencySampling();
+            
+            double best = 0.0;
+            for (int run = 0; run < 3; ++run) {
+                auto start = std::chrono::high_resolution_clock::now();
+                for (size_t size : sizes) {
+                    allocator.deallocate(allocator.allocate(size));
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                double elapsed = std::chrono::duration<double, std::nano>(end - start).count() / operations;
+                best = run == 0 ? elapsed : std::min(best, elapsed);
+            }
+            return best;
+        };
+        
+        SlabAllocator slab(1024, 64, 1024 * 1024);
+        HybridAllocator hybrid(64 * 1024 * 1024);
+        std::vector<std::pair<std::string, MemoryAllocator*>> allocators = {{"Slab", &slab}, {"Hybrid", &hybrid}};
+        
+        for (const auto& entry : allocators) {
+            MemoryAllocator& allocator = *entry.second;
+            double off = cost(allocator, 0);
+            double sampled = cost(allocator, 64);
+            double every = cost(allocator, 1);
+            std::cout << std::setw(12) << entry.first
+                      << std::setw(12) << std::fixed << std::setprecision(1) << off
+                      << std::setw(12) << std::fixed << std::setprecision(1) << sampled
+                      << std::setw(12) << std::fixed << std::setprecision(1) << every << "\n";
+        }
+        
+        std::cout << "\n" << std::setw(12) << "Allocator"
+                  << std::setw(10) << "p50"
+                  << std::setw(10) << "p99"
+                  << std::setw(10) << "p99.9"
+                  << std::setw(12) << "max" << "  (allocate, ns)\n";
+        std::cout << std::string(54, '-') << "\n";
+        for (const auto& entry : allocators) {
+            LatencyHistogram::Summary summary = entry.second->getLatencySummary(LatencyRecorder::Op::ALLOCATE);
+            std::cout << std::setw(12) << entry.first
+                      << std::setw(10) << std::fixed << std::setprecision(0) << summary.p50_ns
+                      << std::setw(10) << summary.p99_ns
+                      << std::setw(10) << summary.p999_ns
+                      << std::setw(12) << summary.max_ns << "\n";
+        }
+        
+        std::cout << "\n";
+    }
+    
+    static void runAllocatorMatrix(BenchmarkHarness& harness) {
+        const BenchmarkOptions& options = harness.getOptions();
+        std::cout << "13. Allocator Matrix (median ns/op over " << options.repetitions << " repetitions after "
+                  << options.warmup << " warm-up, +-CV)\n";
+        std::cout << "--------------------------------------------------------------------------\n";
+        std::cout << "pairs: allocate + free at once; bulk: allocate " << kMatrixLive << " then free them;\n"
+                  << "churn: replace random objects in a working set of " << kMatrixWorkingSet << "\n\n";
+        
+        const std::vector<size_t> sizes = {16, 64, 256, 1024, 4096};
+        const std::vector<std::string> allocators = {"System", "Buddy", "TLSF", "Slab", "Pool", "Hybrid"};
+        const std::vector<std::string> workloads = {"pairs", "bulk", "churn"};
+        
+        // Same replacement order for every allocator and size
+        std::mt19937 gen(42);
+        std::vector<uint32_t> churn_slots(kMatrixChurnOps);
+        for (uint32_t& slot : churn_slots) slot = gen() % kMatrixWorkingSet;
+        
+        for (const std::string& workload : workloads) {
+            std::cout << std::setw(10) << workload;
+            for (size_t size : sizes) std::cout << std::setw(14) << (std::to_string(size) + " B");
+            std::cout << "\n" << std::string(10 + 14 * sizes.size(), '-') << "\n";
+            
+            for (const std::string& name : allocators) {
+                std::cout << std::setw(10) << name;
+                for (size_t size : sizes) {
+                    std::string label = workload + "/" + name + "/" + std::to_string(size);
+                    if (!harness.selected(label)) {
+                        std::cout << std::setw(14) << "-";
+                        continue;
+                    }
+                    
+                    std::unique_ptr<MemoryAllocator> allocator = createMatrixAllocator(name, size);
+                    size_t failures = 0;
+                    const BenchmarkHarness::CaseResult& result = harness.run(workload, name, size, [&]() {
+                        return runMatrixWorkload(workload, *allocator, size, churn_slots, failures);
+                    });
+                    
+                    std::ostringstream cell;
+                    cell << std::fixed << std::setprecision(1) << result.ns_per_op.median
+                         << "+-" << std::setprecision(0) << 100.0 * result.ns_per_op.cv() << "%"
+                         << (failures ? "!" : "");
+                    std::cout << std::setw(14) << cell.str() << std::flush;
+                }
+                std::cout << "\n";
+            }
+            std::cout << "\n";
+        }
+        std::cout << "(! = some allocations failed)\n\n";
+    }
+    
+    static constexpr size_t kMatrixPairs = 20000;
+    static constexpr size_t kMatrixLive = 4096;
+    static constexpr size_t kMatrixWorkingSet = 1024;
+    static constexpr size_t kMatrixChurnOps = 20000;
+    
+    // Every allocator can hold kMatrixLive objects of size at once
+    static std::unique_ptr<MemoryAllocator> createMatrixAllocator(const std::string& name, size_t size) {
+        const size_t memory = 64 * 1024 * 1024;
+        if (name == "Buddy") return std::make_unique<BuddyAllocator>(memory);
+        if (name == "TLSF") return std::make_unique<TlsfAllocator>(memory);
+        if (name == "Slab") return std::make_unique<SlabAllocator>(size, 64, 2 * kMatrixLive * (size + 64));
+        if (name == "Pool") return std::make_unique<PoolAllocator>(size, kMatrixLive, kMatrixLive * size);
+        if (name == "Hybrid") return std::make_unique<HybridAllocator>(memory);
+        return std::make_unique<SystemAllocator>();
+    }
+    
+    // One repetition; returns the allocate and free calls made. Leaves the allocator empty.
+    static size_t runMatrixWorkload(const std::string& workload, MemoryAllocator& allocator, size_t size,
+                                    const std::vector<uint32_t>& churn_slots, size_t& failures) {
+        size_t operations = 0;
+        
+        if (workload == "pairs") {
+            for (size_t i = 0; i < kMatrixPairs; ++i) {
+                void* ptr = allocator.allocate(size);
+                if (ptr) allocator.deallocate(ptr);
+                else ++failures;
+            }
+            return 2 * kMatrixPairs;
+        }
+        
+        std::vector<void*> live(workload == "bulk" ? kMatrixLive : kMatrixWorkingSet);
+        for (void*& ptr : live) {
+            ptr = allocator.allocate(size);
+            if (!ptr) ++failures;
+        }
+        operations += live.size();
+        
+        if (workload == "churn") {
+            for (uint32_t slot : churn_slots) {
+                if (live[slot]) allocator.deallocate(live[slot]);
+                live[slot] = allocator.allocate(size);
+                if (!live[slot]) ++failures;
+            }
+            operations += 2 * churn_slots.size();
+        }
+        
+        for (void* ptr : live) {
+            if (ptr) allocator.deallocate(ptr);
+        }
+        return operations + live.size();
+    }
+    
+    // Aggregate throughput of the classic multithreaded allocator benchmarks as the
+    // thread count grows, with the share of lock acquisitions that had to wait
+    static void runScalabilityBenchmark(BenchmarkHarness& harness) {
+        const BenchmarkOptions& options = harness.getOptions();
+        std::cout << "14. Multithreaded Scalability (M ops/s over all threads, % of lock acquisitions that waited)\n";
+        std::cout << "--------------------------------------------------------------------------------------\n";
+        std::cout << "threadtest: each thread allocates and frees batches of " << kThreadtestBatch << " x 64 B\n"
+                  << "larson:     threads replace random 16-512 B objects in a working set that the next\n"
+                  << "            round's threads inherit, so most frees come from another thread\n"
+                  << "prodcons:   producer/consumer pairs; the consumer frees what the producer allocated\n"
+                  << "shbench:    mixed 16-4096 B sizes, mostly small, freed in bursts\n"
+                  << "(hardware threads: " << std::thread::hardware_concurrency() << ")\n\n";
+        
+        const std::vector<std::string> allocators = {"System", "Buddy", "Slab", "Pool", "Hybrid"};
+        const std::vector<ScalingWorkload> workloads = {
+            {"threadtest", 64, kThreadtestBatch, runThreadtest},
+            {"larson", 512, kLarsonSlots, runLarson},
+            {"prodcons", 256, kProdConsCapacity, runProducerConsumer},
+            {"shbench", 4096, kShbenchSlots, runShbench},
+        };
+        
+        for (const ScalingWorkload& workload : workloads) {
+            std::cout << std::setw(10) << workload.name;
+            for (size_t threads : options.thread_counts) {
+                std::cout << std::setw(16) << (std::to_string(threads) + (threads == 1 ? " thread" : " threads"));
+            }
+            std::cout << "\n" << std::string(10 + 16 * options.thread_counts.size(), '-') << "\n";
+            
+            for (const std::string& name : allocators) {
+                std::cout << std::setw(10) << name;
+                double single_thread = 0.0;
+                for (size_t threads : options.thread_counts) {
+                    std::string label = workload.name + "/" + name + "/" + std::to_string(threads) + "t";
+                    if (!harness.selected(label)) {
+                        std::cout << std::setw(16) << "-";
+                        continue;
+                    }
+                    
+                    std::unique_ptr<MemoryAllocator> allocator =
+                        createScalingAllocator(name, workload.max_size, threads * workload.live_per_thread);
+                    std::atomic<size_t> failures{0};
+                    MemoryAllocator::LockStats before = allocator->getLockStats();
+                    BenchmarkHarness::CaseResult& result = harness.run(workload.name, name, workload.max_size, [&]() {
+                        return workload.run(*allocator, threads, failures);
+                    });
+                    MemoryAllocator::LockStats after = allocator->getLockStats();
+                    result.threads = threads;
+                    result.locks.acquisitions = after.acquisitions - before.acquisitions;
+                    result.locks.contended = after.contended - before.contended;
+                    
+                    double mops = result.ns_per_op.median > 0.0 ? 1000.0 / result.ns_per_op.median : 0.0;
+                    if (threads == 1) single_thread = mops;
+                    
+                    std::ostringstream cell;
+                    cell << std::fixed << std::setprecision(2) << mops;
+                    if (threads > 1 && single_thread > 0.0) {
+                        cell << " x" << std::setprecision(1) << mops / single_thread;
+                    }
+                    if (result.locks.acquisitions) {
+                        cell << " " << std::setprecision(0)
+                             << 100.0 * result.locks.contended / result.locks.acquisitions << "%";
+                    }
+                    cell << (failures ? "!" : "");
+                    std::cout << std::setw(16) << cell.str() << std::flush;
+                }
+                std::cout << "\n";
+            }
+            std::cout << "\n";
+        }
+        std::cout << "(xN = speedup over 1 thread, ! = some allocations failed)\n";
+    }
+    
+    // Producer/consumer pairs where each producer allocates from its own allocator,
+    // freed by the consumer either under the allocator's lock or through the
+    // remote-free list the producer drains on its next allocation
+    static void runRemoteFreeBenchmark(BenchmarkHarness& harness) {
+        const BenchmarkOptions& options = harness.getOptions();
+        std::cout << "15. Remote Frees (producer/consumer, one allocator per producer: M ops/s, lock acquisitions\n"
+                  << "    per message, % that waited)\n";
+        std::cout << "------------------------------------------------------------------------------------------\n";
+        std::cout << "locked: the consumer frees under the producer allocator's lock\n"
+                  << "remote: the allocator is bound to the producer; the consumer queues frees lock-free\n\n";
+        
+        // Two threads per pair, so 1 and 2 threads are the same case
+        std::vector<size_t> pair_counts;
+        for (size_t threads : options.thread_counts) {
+            size_t pairs = std::max<size_t>(threads / 2, 1);
+            if (std::find(pair_counts.begin(), pair_counts.end(), pairs) == pair_counts.end()) {
+                pair_counts.push_back(pairs);
+            }
+        }
+        
+        std::cout << std::setw(14) << "pairs";
+        for (size_t pairs : pair_counts) std::cout << std::setw(20) << pairs;
+        std::cout << "\n" << std::string(14 + 20 * pair_counts.size(), '-') << "\n";
+        
+        for (const std::string name : {"Pool", "Slab"}) {
+            for (bool remote : {false, true}) {
+                std::string mode = name + (remote ? " remote" : " locked");
+                std::cout << std::setw(14) << mode;
+                for (size_t pairs : pair_counts) {
+                    std::string label = std::string("remote-free/") + name + (remote ? "-remote/" : "-locked/")
+                                      + std::to_string(2 * pairs) + "t";
+                    if (!harness.selected(label)) {
+                        std::cout << std::setw(20) << "-";
+                        continue;
+                    }
+                    
+                    std::vector<std::unique_ptr<MemoryAllocator>> allocators;
+                    for (size_t p = 0; p < pairs; ++p) {
+                        allocators.push_back(createScalingAllocator(name, 256, 2 * kProdConsCapacity));
+                    }
+                    std::atomic<size_t> failures{0};
+                    BenchmarkHarness::CaseResult& result = harness.run(
+                        remote ? "remote-free" : "locked-free", name, 256, [&]() {
+                            return runOwnedProducerConsumer(allocators, remote, failures);
+                        });
+                    
+                    result.threads = 2 * pairs;
+                    for (const auto& allocator : allocators) {
+                        MemoryAllocator::LockStats locks = allocator->getLockStats();
+                        result.locks.acquisitions += locks.acquisitions;
+                        result.locks.contended += locks.contended;
+                    }
+                    
+                    double messages = static_cast<double>(pairs * kProdConsMessages)
+                                    * (options.warmup + options.repetitions);
+                    std::ostringstream cell;
+                    cell << std::fixed << std::setprecision(2)
+                         << (result.ns_per_op.median > 0.0 ? 1000.0 / result.ns_per_op.median : 0.0)
+                         << " " << std::setprecision(2) << result.locks.acquisitions / messages;
+                    if (result.locks.acquisitions) {
+                        cell << " " << std::setprecision(0)
+                             << 100.0 * result.locks.contended / result.locks.acquisitions << "%";
+                    }
+                    cell << (failures ? "!" : "");
+                    std::cout << std::setw(20) << cell.str() << std::flush;
+                }
+                std::cout << "\n";
+            }
+        }
+        std::cout << "\n";
+    }
+    
+    // One SPSC pair per allocator; the producer binds its allocator when remote
+    static size_t runOwnedProducerConsumer(std::vector<std::unique_ptr<MemoryAllocator>>& allocators, bool remote,
+                                           std::atomic<size_t>& failures) {
+        std::vector<MessageRing> rings(allocators.size());
+        
+        runThreads(2 * allocators.size(), [&](size_t t) {
+            MemoryAllocator& allocator = *allocators[t / 2];
+            MessageRing& ring = rings[t / 2];
+            if (t % 2 == 0) {
+                if (auto* pool = dynamic_cast<PoolAllocator*>(&allocator)) {
+                    if (remote) pool->bindOwnerThread();
+                    else pool->unbindOwnerThread();
+                } else if (auto* slab = dynamic_cast<SlabAllocator*>(&allocator)) {
+                    if (remote) slab->bindOwnerThread();
+                    else slab->unbindOwnerThread();
+                }
+            }
+            
+            for (size_t i = 0; i < kProdConsMessages; ++i) {
+                if (t % 2 == 0) {
+                    void* message = allocateCounted(allocator, 64 + (i * 37) % 193, failures);
+                    size_t tail = ring.tail.load(std::memory_order_relaxed);
+                    while (tail - ring.head.load(std::memory_order_acquire) == kProdConsCapacity) {
+                        std::this_thread::yield();
+                    }
+                    ring.slots[tail % kProdConsCapacity] = message;
+                    ring.tail.store(tail + 1, std::memory_order_release);
+                } else {
+                    size_t head = ring.head.load(std::memory_order_relaxed);
+                    while (ring.tail.load(std::memory_order_acquire) == head) {
+                        std::this_thread::yield();
+                    }
+                    void* message = ring.slots[head % kProdConsCapacity];
+                    ring.head.store(head + 1, std::memory_order_release);
+                    if (message) allocator.deallocate(message);
+                }
+            }
+        });
+        return allocators.size() * kProdConsMessages * 2;
+    }
+    
+    // One repetition on threads threads; returns the allocate and free calls made
+    using ScalingRun = size_t (*)(MemoryAllocator&, size_t threads, std::atomic<size_t>& failures);
+    
+    struct ScalingWorkload {
+        std::string name;
+        size_t max_size;
+        size_t live_per_thread;       // Most objects one thread keeps live at once
+        ScalingRun run;
+    };
+    
+    static constexpr size_t kThreadtestBatch = 1000;
+    static constexpr size_t kThreadtestRounds = 20;
+    static constexpr size_t kLarsonSlots = 1000;
+    static constexpr size_t kLarsonRounds = 4;
+    static constexpr size_t kLarsonReplacements = 5000;
+    static constexpr size_t kProdConsCapacity = 1024;
+    static constexpr size_t kProdConsMessages = 20000;
+    static constexpr size_t kShbenchSlots = 1000;
+    static constexpr size_t kShbenchIterations = 20000;
+    
+    // Every allocator can hold live objects of up to max_size at once
+    static std::unique_ptr<MemoryAllocator> createScalingAllocator(const std::string& name, size_t max_size,
+                                                                   size_t live) {
+        size_t memory = 16 * 1024 * 1024;
+        while (memory < 4 * live * max_size) memory *= 2;
+        if (name == "Buddy") return std::make_unique<BuddyAllocator>(memory);
+        if (name == "Slab") return std::make_unique<SlabAllocator>(max_size, 64, 2 * live * (max_size + 64));
+        if (name == "Pool") {
+            PoolAllocator::PoolConfig config;
+            config.total_memory = 0;
+            for (size_t size = 16; size <= max_size; size *= 2) {
+                config.block_sizes.push_back(size);
+                config.blocks_per_pool.push_back(live + 64);
+                config.total_memory += size * (live + 64);
+            }
+            return std::make_unique<PoolAllocator>(config);
+        }
+        if (name == "Hybrid") return std::make_unique<HybridAllocator>(memory);
+        return std::make_unique<SystemAllocator>();
+    }
+    
+    // Starts body(0) .. body(threads - 1) on their own threads and joins them
+    template<typename Body>
+    static void runThreads(size_t threads, Body body) {
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back(body, t);
+        }
+        for (auto& worker : workers) worker.join();
+    }
+    
+    // xorshift: cheap enough not to show up next to the allocator
+    static uint32_t nextRandom(uint32_t& state) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    
+    static void* allocateCounted(MemoryAllocator& allocator, size_t size, std::atomic<size_t>& failures) {
+        void* ptr = allocator.allocate(size);
+        if (ptr) static_cast<char*>(ptr)[0] = 1;
+        else failures.fetch_add(1, std::memory_order_relaxed);
+        return ptr;
+    }
+    
+    static size_t runThreadtest(MemoryAllocator& allocator, size_t threads, std::atomic<size_t>& failures) {
+        runThreads(threads, [&](size_t) {
+            std::vector<void*> batch(kThreadtestBatch);
+            for (size_t round = 0; round < kThreadtestRounds; ++round) {
+                for (void*& ptr : batch) ptr = allocateCounted(allocator, 64, failures);
+                for (void* ptr : batch) {
+                    if (ptr) allocator.deallocate(ptr);
+                }
+            }
+        });
+        return threads * kThreadtestRounds * kThreadtestBatch * 2;
+    }
+    
+    static size_t runLarson(MemoryAllocator& allocator, size_t threads, std::atomic<size_t>& failures) {
+        std::vector<std::vector<void*>> sets(threads, std::vector<void*>(kLarsonSlots, nullptr));
+        
+        // Every round starts fresh threads; thread t takes over the set thread t + 1 left behind
+        for (size_t round = 0; round < kLarsonRounds; ++round) {
+            runThreads(threads, [&](size_t t) {
+                std::vector<void*>& set = sets[(t + round) % threads];
+                uint32_t state = static_cast<uint32_t>(t * 7919 + round * 104729 + 1);
+                for (size_t i = 0; i < kLarsonReplacements; ++i) {
+                    void*& slot = set[nextRandom(state) % kLarsonSlots];
+                    if (slot) allocator.deallocate(slot);
+                    slot = allocateCounted(allocator, 16 + nextRandom(state) % 497, failures);
+                }
+            });
+        }
+        
+        size_t operations = threads * kLarsonRounds * kLarsonReplacements * 2;
+        for (auto& set : sets) {
+            for (void* ptr : set) {
+                if (!ptr) continue;
+                allocator.deallocate(ptr);
+                ++operations;
+            }
+        }
+        return operations;
+    }
+    
+    // Single-producer single-consumer ring of message pointers
+    struct MessageRing {
+        std::vector<void*> slots = std::vector<void*>(kProdConsCapacity);
+        std::atomic<size_t> head{0};  // Next slot the consumer reads
+        std::atomic<size_t> tail{0};  // Next slot the producer writes
+    };
+    
+    // threads / 2 producer-consumer pairs (one pair below 2 threads)
+    static size_t runProducerConsumer(MemoryAllocator& allocator, size_t threads, std::atomic<size_t>& failures) {
+        size_t pairs = std::max<size_t>(threads / 2, 1);
+        std::vector<MessageRing> rings(pairs);
+        
+        runThreads(2 * pairs, [&](size_t t) {
+            MessageRing& ring = rings[t / 2];
+            for (size_t i = 0; i < kProdConsMessages; ++i) {
+                if (t % 2 == 0) {
+                    void* message = allocateCounted(allocator, 64 + (i * 37) % 193, failures);
+                    size_t tail = ring.tail.load(std::memory_order_relaxed);
+                    while (tail - ring.head.load(std::memory_order_acquire) == kProdConsCapacity) {
+                        std::this_thread::yield();
+                    }
+                    ring.slots[tail % kProdConsCapacity] = message;
+                    ring.tail.store(tail + 1, std::memory_order_release);
+                } else {
+                    size_t head = ring.head.load(std::memory_order_relaxed);
+                    while (ring.tail.load(std::memory_order_acquire) == head) {
+                        std::this_thread::yield();
+                    }
+                    void* message = ring.slots[head % kProdConsCapacity];
+                    ring.head.store(head + 1, std::memory_order_release);
+                    if (message) allocator.deallocate(message);
+                }
+            }
+        });
+        return pairs * kProdConsMessages * 2;
+    }
+    
+    static size_t runShbench(MemoryAllocator& allocator, size_t threads, std::atomic<size_t>& failures) {
+        std::atomic<size_t> operations{0};
+        runThreads(threads, [&](size_t t) {
+            std::vector<void*> slots(kShbenchSlots, nullptr);
+            uint32_t state = static_cast<uint32_t>(t * 2654435761u + 1);
+            size_t local = 0;
+            
+            for (size_t i = 1; i <= kShbenchIterations; ++i) {
+                // 80% 16-128 B, 15% up to 1 KB, 5% up to 4 KB
+                uint32_t pick = nextRandom(state) % 100;
+                size_t size = pick < 80 ? 16 + nextRandom(state) % 113
+                            : pick < 95 ? 129 + nextRandom(state) % 896
+                            : 1025 + nextRandom(state) % 3072;
+                
+                void*& slot = slots[nextRandom(state) % kShbenchSlots];
+                if (slot) {
+                    allocator.deallocate(slot);
+                    ++local;
+                }
+                slot = allocateCounted(allocator, size, failures);
+                ++local;
+                
+                // Bursts: drop every other object now and then
+                if (i % 2000 == 0) {
+                    for (size_t s = i / 2000 % 2; s < kShbenchSlots; s += 2) {
+                        if (!slots[s]) continue;
+                        allocator.deallocate(slots[s]);
+                        slots[s] = nullptr;
+                        ++local;
+                    }
+                }
+            }
+            
+            for (void* ptr : slots) {
+                if (!ptr) continue;
+                allocator.deallocate(ptr);
+                ++local;
+            }
+            operations.fetch_add(local, std::memory_order_relaxed);
+        });
+        return operations.load();
+    }
+    
+    // Runs body on every thread at once; returns wall time in ns
+    template<typename Body>
+    static double timeThreads(unsigned int threads, Body body) {
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threads; ++t) {
+            workers.emplace_back(body);
+        }
+        for (auto& worker : workers) worker.join();
+        auto end = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+    
+    // Allocates every size, then times freeing them in shuffled order
+    static double measureFreeCost(MemoryAllocator& allocator, const std::vector<size_t>& sizes, bool sized) {
+        std::vector<std::pair<void*, size_t>> ptrs;
+        ptrs.reserve(sizes.size());
+        for (size_t size : sizes) {
+            void* ptr = allocator.allocate(size);
+            if (ptr) ptrs.push_back({ptr, size});
+        }
+        std::shuffle(ptrs.begin(), ptrs.end(), std::mt19937(7));
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const auto& ptr : ptrs) {
+            if (sized) {
+                allocator.deallocate(ptr.first, ptr.second);
+            } else {
+                allocator.deallocate(ptr.first);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        return ptrs.empty() ? 0.0 : elapsed_ns / ptrs.size();
+    }
+    
+    static void printContainerCost(const std::string& name, std::pmr::memory_resource* resource, size_t elements) {
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            std::pmr::map<int, int> map(resource);
+            for (size_t i = 0; i < elements; ++i) map.emplace(static_cast<int>(i), static_cast<int>(i));
+            for (size_t i = 0; i < elements; i += 2) map.erase(static_cast<int>(i));
+            for (size_t i = 0; i < elements; i += 2) map.emplace(static_cast<int>(i), 0);
+        }
+        auto middle = std::chrono::high_resolution_clock::now();
+        {
+            std::pmr::list<int> list(resource);
+            for (size_t i = 0; i < elements; ++i) list.push_back(static_cast<int>(i));
+            for (size_t i = 0; i < elements * 4; ++i) {
+                list.pop_front();
+                list.push_back(static_cast<int>(i));
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        
+        std::cout << std::setw(14) << name
+                  << std::setw(20) << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(middle - start).count()
+                  << std::setw(20) << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(end - middle).count() << "\n";
+    }
+    
+    // Keeps the whole workload live so getAllocatedSize() is what the classes consumed
+    static void printWaste(const std::string& workload, const std::string& classes,
+                           const HybridAllocator::HybridConfig& config, const std::vector<size_t>& sizes) {
+        HybridAllocator allocator(64 * 1024 * 1024, config);
+        std::vector<void*> ptrs;
+        ptrs.reserve(sizes.size());
+        size_t requested = 0;
+        
+        for (size_t size : sizes) {
+            void* ptr = allocator.allocate(size);
+            if (ptr) {
+                ptrs.push_back(ptr);
+                requested += size;
+            }
+        }
+        size_t consumed = allocator.getAllocatedSize();
+        
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+        
+        double waste = consumed > 0 ? 100.0 * (consumed - requested) / consumed : 0.0;
+        std::cout << std::setw(12) << workload
+                  << std::setw(12) << classes
+                  << std::setw(14) << requested
+                  << std::setw(14) << consumed
+                  << std::setw(9) << std::fixed << std::setprecision(1) << waste << "%\n";
+    }
+    
+    // Each thread churns a small working set in size class sizes[thread % sizes.size()]
+    static double measureHybridThroughput(size_t threads, size_t ops_per_thread,
+                                          const std::vector<size_t>& sizes) {
+        HybridAllocator allocator(16 * 1024 * 1024);
+        const size_t working_set = 64;
+        
+        std::vector<std::thread> workers;
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        for (size_t t = 0; t < threads; ++t) {
+            size_t size = sizes[t % sizes.size()];
+            workers.emplace_back([&allocator, size, ops_per_thread, working_set]() {
+                std::vector<void*> live(working_set, nullptr);
+                for (size_t i = 0; i < ops_per_thread; ++i) {
+                    void*& slot = live[i % working_set];
+                    if (slot) {
+                        allocator.deallocate(slot);
+                    }
+                    slot = allocator.allocate(size);
+                }
+                for (void* ptr : live) {
+                    allocator.deallocate(ptr);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed_s = std::chrono::duration<double>(end - start).count();
+        
+        return (threads * ops_per_thread * 2) / elapsed_s / 1e6;
+    }
+    
+    // Average nanoseconds per object for an allocate_batch + deallocate_batch round trip
+    static double measureBatchCost(MemoryAllocator& allocator, size_t alloc_size,
+                                   size_t batch, size_t total_objects) {
+        std::vector<void*> ptrs(batch);
+        size_t rounds = total_objects / batch;
+        size_t objects = 0;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        
+        for (size_t round = 0; round < rounds; ++round) {
+            size_t n = allocator.allocate_batch(alloc_size, batch, ptrs.data());
+            allocator.deallocate_batch(ptrs.data(), n);
+            objects += n;
+        }
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        double elapsed_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        
+        return objects > 0 ? elapsed_ns / objects : 0.0;
+    }
+    
     // Specific allocator benchmarks
     static BenchmarkResult benchmarkBuddyAllocator(const std::string& name, size_t memory_size,
                                                   size_t iterations, size_t alloc_size) {
@@ -203,6 +1152,12 @@ private:
         return runVariableSizeBenchmark(allocator, name, sizes);
     }
     
+    static BenchmarkResult benchmarkTlsfAllocatorVariable(const std::string& name, size_t memory_size,
+                                                        const std::vector<size_t>& sizes) {
+        TlsfAllocator allocator(memory_size);
+        return runVariableSizeBenchmark(allocator, name, sizes);
+    }
+    
     static BenchmarkResult benchmarkHybridAllocatorVariable(const std::string& name, size_t memory_size,
                                                           const std::vector<size_t>& sizes) {
         HybridAllocator allocator(memory_size);
@@ -329,6 +1284,7 @@ private:
         std::cout << name << " Fragmentation Test:\n";
         std::cout << "  After partial deallocation: " << fragmentation_after_partial_dealloc << "%\n";
         std::cout << "  After large allocations: " << fragmentation_after_large_alloc << "%\n";
+        std::cout << "  Large blocks placed: " << large_ptrs.size() << "/10\n";
     }
     
     static BenchmarkResult stressBenchmarkBuddy(const std::string& name, size_t memory_size, size_t iterations) {
@@ -391,19 +1347,15 @@ private:
     static void simulateWebServerWorkload() {
         std::cout << "Web Server Simulation (many small allocations):\n";
         
+        const int requests = 1000;
         HybridAllocator allocator(8 * 1024 * 1024); // 8MB
         
         auto start = std::chrono::high_resolution_clock::now();
         
         // Simulate handling 1000 requests
-        for (int request = 0; request < 1000; ++request) {
+        for (int request = 0; request < requests; ++request) {
             std::vector<void*> request_memory;
-            
-            // Each request needs various small allocations
-            request_memory.push_back(allocator.allocate(256)); // Request object
-            request_memory.push_back(allocator.allocate(1024)); // Response buffer
-            request_memory.push_back(allocator.allocate(512)); // Headers
-            request_memory.push_back(allocator.allocate(128)); // Session data
+            handleRequest(allocator, request_memory);
             
             // Clean up request memory
             for (void* ptr : request_memory) {
@@ -414,33 +1366,52 @@ private:
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration<double, std::milli>(end - start).count();
         
+        std::cout << std::fixed << std::setprecision(3);
         std::cout << "  Processed 1000 requests in " << duration << " ms\n";
-        std::cout << "  Average per request: " << duration / 1000.0 << " ms\n";
+        std::cout << "  Average per request: " << duration * 1000.0 / requests << " us\n";
         std::cout << "  Final fragmentation: " << allocator.getFragmentation() << "%\n";
+        
+        // Same requests with a request-scoped arena: no per-object frees, one reset
+        ArenaAllocator arena(1024 * 1024, 16 * 1024);
+        
+        start = std::chrono::high_resolution_clock::now();
+        for (int request = 0; request < requests; ++request) {
+            std::vector<void*> request_memory;
+            handleRequest(arena, request_memory);
+            arena.reset();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto arena_duration = std::chrono::duration<double, std::milli>(end - start).count();
+        
+        std::cout << "  Arena (reset per request): " << arena_duration << " ms ("
+                  << std::setprecision(2) << (arena_duration > 0 ? duration / arena_duration : 0.0)
+                  << "x faster), " << arena.getChunkCount() << " chunk kept\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    
+    // One request's objects: request, response buffer, headers, session data
+    static void handleRequest(MemoryAllocator& allocator, std::vector<void*>& request_memory) {
+        request_memory.push_back(allocator.allocate(256)); // Request object
+        request_memory.push_back(allocator.allocate(1024)); // Response buffer
+        request_memory.push_back(allocator.allocate(512)); // Headers
+        request_memory.push_back(allocator.allocate(128)); // Session data
+        for (void* ptr : request_memory) {
+            if (ptr) static_cast<char*>(ptr)[0] = 1;
+        }
     }
     
     static void simulateGameEngineWorkload() {
         std::cout << "Game Engine Simulation (mixed allocation patterns):\n";
         
+        const int frames = 60;
         HybridAllocator allocator(16 * 1024 * 1024); // 16MB
         
         auto start = std::chrono::high_resolution_clock::now();
         
         // Simulate game frames
-        for (int frame = 0; frame < 60; ++frame) {
+        for (int frame = 0; frame < frames; ++frame) {
             std::vector<void*> frame_memory;
-            
-            // Each frame needs various allocations
-            frame_memory.push_back(allocator.allocate(4096)); // Render commands
-            frame_memory.push_back(allocator.allocate(2048)); // Vertex buffer
-            frame_memory.push_back(allocator.allocate(1024)); // Texture data
-            frame_memory.push_back(allocator.allocate(512)); // Audio buffer
-            
-            // Multiple small allocations for game objects
-            for (int obj = 0; obj < 50; ++obj) {
-                void* ptr = allocator.allocate(64); // Game object
-                if (ptr) frame_memory.push_back(ptr);
-            }
+            allocateFrame(allocator, frame_memory);
             
             // Clean up frame memory
             for (void* ptr : frame_memory) {
@@ -451,15 +1422,91 @@ private:
         auto end = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration<double, std::milli>(end - start).count();
         
+        std::cout << std::fixed << std::setprecision(3);
         std::cout << "  Simulated 60 frames in " << duration << " ms\n";
-        std::cout << "  Average per frame: " << duration / 60.0 << " ms\n";
+        std::cout << "  Average per frame: " << duration * 1000.0 / frames << " us\n";
         std::cout << "  Final fragmentation: " << allocator.getFragmentation() << "%\n";
+        
+        // Level data from the bottom of a stack, frame data from the top, popped per frame
+        StackAllocator stack(1024 * 1024);
+        stack.allocate(256 * 1024); // Level geometry, lives across frames
+        
+        start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            std::vector<void*> frame_memory;
+            StackAllocator::Marker marker = stack.getMarker(StackAllocator::End::TOP);
+            allocateFrame(stack, frame_memory, StackAllocator::End::TOP);
+            stack.freeToMarker(marker);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto stack_duration = std::chrono::duration<double, std::milli>(end - start).count();
+        
+        // Same frames, each frame's data readable during the next one
+        FrameAllocator double_buffered(512 * 1024);
+        
+        start = std::chrono::high_resolution_clock::now();
+        for (int frame = 0; frame < frames; ++frame) {
+            std::vector<void*> frame_memory;
+            double_buffered.nextFrame();
+            allocateFrame(double_buffered, frame_memory);
+        }
+        end = std::chrono::high_resolution_clock::now();
+        auto frame_duration = std::chrono::duration<double, std::milli>(end - start).count();
+        
+        std::cout << "  Stack (marker per frame): " << stack_duration << " ms ("
+                  << std::setprecision(2) << (stack_duration > 0 ? duration / stack_duration : 0.0)
+                  << "x faster)\n";
+        std::cout << std::setprecision(3) << "  Double-buffered frames: " << frame_duration << " ms ("
+                  << std::setprecision(2) << (frame_duration > 0 ? duration / frame_duration : 0.0)
+                  << "x faster)\n";
+        std::cout << std::defaultfloat << std::setprecision(6);
+    }
+    
+    // One frame's objects: render commands, vertex buffer, texture, audio, 50 game objects
+    static void allocateFrame(MemoryAllocator& allocator, std::vector<void*>& frame_memory) {
+        frame_memory.push_back(allocator.allocate(4096)); // Render commands
+        frame_memory.push_back(allocator.allocate(2048)); // Vertex buffer
+        frame_memory.push_back(allocator.allocate(1024)); // Texture data
+        frame_memory.push_back(allocator.allocate(512)); // Audio buffer
+        
+        // Multiple small allocations for game objects
+        for (int obj = 0; obj < 50; ++obj) {
+            void* ptr = allocator.allocate(64); // Game object
+            if (ptr) frame_memory.push_back(ptr);
+        }
+    }
+    
+    static void allocateFrame(StackAllocator& stack, std::vector<void*>& frame_memory, StackAllocator::End end) {
+        for (size_t size : {4096, 2048, 1024, 512}) {
+            frame_memory.push_back(stack.allocate(size, end));
+        }
+        for (int obj = 0; obj < 50; ++obj) {
+            void* ptr = stack.allocate(64, end);
+            if (ptr) frame_memory.push_back(ptr);
+        }
     }
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    try {
+        options = BenchmarkOptions::parse(argc, argv);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n"
+                  << "Usage: performance_tests [--repetitions N] [--warmup N] [--cpu N] [--json FILE]\n"
+                  << "                         [--filter workload/Allocator/size] [--matrix-only]\n"
+                  << "                         [--threads 1,2,4,...]\n";
+        return 1;
+    }
+    
+    if (options.cpu >= 0 && !BenchmarkHarness::pinToCpu(options.cpu)) {
+        std::cerr << "Could not pin to CPU " << options.cpu << ", running unpinned\n";
+    }
+    
     try {
-        MemoryAllocatorBenchmark::runComprehensiveBenchmarks();
+        BenchmarkHarness harness(options);
+        MemoryAllocatorBenchmark::runComprehensiveBenchmarks(harness);
     }
     catch (const std::exception& e) {
         std::cerr << "Benchmark failed with exception: " << e.what() << std::endl;
@@ -2,10 +2,32 @@
 #include "../src/includes/slab_allocator.h"
 #include "../src/includes/pool_allocator.h"
 #include "../src/includes/hybrid_allocator.h"
+#include "../src/includes/allocator_adapters.h"
+#include "../src/includes/allocation_trace.h"
+#include "../src/includes/arena_allocator.h"
+#include "../src/includes/stack_allocator.h"
+#include "../src/includes/frame_allocator.h"
+#include "../src/includes/tlsf_allocator.h"
+#include "../src/includes/persistent_allocator.h"
+#include "../src/includes/shared_memory_allocator.h"
 #include <iostream>
 #include <vector>
 #include <cassert>
+#include <cstdio>
 #include <chrono>
+#include <stdexcept>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <thread>
+#include <fstream>
+#include <cstring>
+#include <random>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include <atomic>
 
 class TestRunner {
 public:
@@ -15,7 +37,31 @@ public:
         testBuddyAllocator();
         testSlabAllocator();
         testPoolAllocator();
+        testPoolLayout();
         testHybridAllocator();
+        testBatchAllocation();
+        testContiguousAllocation();
+        testHybridRouting();
+        testHybridRebalancing();
+        testSizeClassTable();
+        testHugeAllocations();
+        testHybridProfileConfig();
+        testAllocatorAdapters();
+        testAlignedAllocations();
+        testSizedDeallocation();
+        testStatsCounters();
+        testLatencyHistograms();
+        testAllocationTrace();
+        testLockContention();
+        testRemoteFrees();
+        testArenaAllocator();
+        testStackAllocator();
+        testTlsfAllocator();
+#ifndef _WIN32
+        // File and shared memory mappings are POSIX only
+        testPersistentAllocator();
+        testSharedMemoryAllocator();
+#endif
         
         std::cout << "\nAll tests completed successfully!\n";
     }
@@ -85,6 +131,21 @@ private:
         allocator.deallocate(ptr1);
         allocator.deallocate(ptr2);
         
+        // Freed objects are reused before new ones are carved
+        void* ptr4 = allocator.allocate(64);
+        assert(ptr4 == ptr2);
+        allocator.deallocate(ptr4);
+        
+        // A double free or interior pointer leaves the free list intact
+        assert(!allocator.release(ptr4));
+        assert(!allocator.release(static_cast<char*>(ptr1) + 8));
+        assert(allocator.getAllocatedSize() == 0);
+        void* ptr5 = allocator.allocate(64);
+        void* ptr6 = allocator.allocate(64);
+        assert(ptr5 && ptr6 && ptr5 != ptr6);
+        allocator.deallocate(ptr5);
+        allocator.deallocate(ptr6);
+        
         std::cout << "  ✓ Slab Allocator tests passed\n";
     }
     
@@ -124,6 +185,55 @@ private:
         std::cout << "  ✓ Pool Allocator tests passed\n";
     }
     
+    static void testPoolLayout() {
+        std::cout << "Testing Pool Layout...\n";
+        
+        // 200 blocks span four bitmap words, the last one partly
+        PoolAllocator pool(64, 200, 64 * 200);
+        std::vector<void*> blocks(200, nullptr);
+        for (int i = 0; i < 200; ++i) {
+            void* ptr = pool.allocate(64);
+            assert(ptr != nullptr);
+            size_t index = (reinterpret_cast<size_t>(ptr) - pool.getMemoryLayout()[0].address) / 64;
+            assert(index < 200 && blocks[index] == nullptr);
+            blocks[index] = ptr;
+        }
+        
+        // Every other block of the first ten, then the whole tail from 100
+        for (int i = 0; i < 10; i += 2) {
+            pool.deallocate(blocks[i]);
+        }
+        for (int i = 100; i < 200; ++i) {
+            pool.deallocate(blocks[i]);
+        }
+        
+        std::vector<MemoryAllocator::MemoryBlock> layout = pool.getMemoryLayout();
+        assert(layout.size() == 200);
+        for (size_t i = 0; i < layout.size(); ++i) {
+            bool is_free = (i < 10 && i % 2 == 0) || i >= 100;
+            assert(layout[i].address == reinterpret_cast<size_t>(blocks[i]));
+            assert(layout[i].size == 64 && layout[i].is_free == is_free);
+        }
+        
+        // Nine single-block runs, then 91 used blocks (9 to 99) and 100 free ones
+        std::vector<MemoryAllocator::MemoryBlock> runs = pool.getMemoryLayoutRuns();
+        assert(runs.size() == 11);
+        for (size_t i = 0; i < 9; ++i) {
+            assert(runs[i].address == reinterpret_cast<size_t>(blocks[i]));
+            assert(runs[i].size == 64 && runs[i].is_free == (i % 2 == 0));
+        }
+        assert(runs[9].address == reinterpret_cast<size_t>(blocks[9]) && runs[9].size == 91 * 64 && !runs[9].is_free);
+        assert(runs[10].address == reinterpret_cast<size_t>(blocks[100]) && runs[10].size == 100 * 64 && runs[10].is_free);
+        
+        // The bitmap rejects a double free and leaves the layout alone
+        size_t available = pool.getAvailableBlocks();
+        assert(!pool.release(blocks[0]));
+        assert(!pool.release(blocks[150]));
+        assert(pool.getAvailableBlocks() == available && pool.getMemoryLayoutRuns().size() == 11);
+        
+        std::cout << "  ✓ Pool Layout tests passed\n";
+    }
+    
     static void testHybridAllocator() {
         std::cout << "Testing Hybrid Allocator...\n";
         
@@ -146,6 +256,17 @@ private:
         allocator.deallocate(ptr2);
         allocator.deallocate(ptr3);
         
+        // Double frees and interior pointers are not counted
+        void* ptr4 = allocator.allocate(64);
+        allocator.deallocate(ptr4);
+        size_t deallocations = allocator.getDeallocationCount();
+        allocator.deallocate(ptr1);
+        allocator.deallocate(ptr2);
+        allocator.deallocate(ptr3);
+        allocator.deallocate(static_cast<char*>(ptr4) + 16);
+        assert(allocator.getDeallocationCount() == deallocations);
+        assert(allocator.getAllocatedSize() == 0);
+        
         // Test statistics
         std::string stats = allocator.getStats();
         assert(!stats.empty());
@@ -156,6 +277,1110 @@ private:
         
         std::cout << "  ✓ Hybrid Allocator tests passed\n";
     }
+    
+    static void testBatchAllocation() {
+        std::cout << "Testing Batch Allocation...\n";
+        
+        PoolAllocator::PoolConfig config;
+        config.block_sizes = {32, 64};
+        config.blocks_per_pool = {16, 8};
+        config.total_memory = 32 * 16 + 64 * 8;
+        PoolAllocator pool(config);
+        
+        // Batch spills from the 32-byte pool into the 64-byte pool
+        void* ptrs[32];
+        size_t count = pool.allocate_batch(32, 32, ptrs);
+        assert(count == 24);
+        pool.deallocate_batch(ptrs, count);
+        assert(pool.allocate_batch(64, 32, ptrs) == 8);
+        pool.deallocate_batch(ptrs, 8);
+        
+        SlabAllocator slab(64, 8, 4 * (64 * 8 + 64));
+        count = slab.allocate_batch(64, 32, ptrs);
+        assert(count == 32);
+        slab.deallocate_batch(ptrs, count);
+        assert(slab.allocate_batch(128, 1, ptrs) == 0);
+        
+        std::cout << "  ✓ Batch Allocation tests passed\n";
+    }
+    
+    static void testContiguousAllocation() {
+        std::cout << "Testing Contiguous Pool Allocation...\n";
+        
+        PoolAllocator::PoolConfig config;
+        config.block_sizes = {32};
+        config.blocks_per_pool = {128};
+        config.total_memory = 32 * 128;
+        PoolAllocator pool(config);
+        
+        // Punch holes so only the uncarved tail holds a long run
+        std::vector<void*> singles;
+        for (int i = 0; i < 64; ++i) {
+            singles.push_back(pool.allocate(32));
+        }
+        for (size_t i = 0; i < singles.size(); i += 2) {
+            pool.deallocate(singles[i]);
+        }
+        
+        char* run = static_cast<char*>(pool.allocate_contiguous(32, 40));
+        assert(run != nullptr);
+        assert(run >= static_cast<char*>(singles.back()) + 32);
+        assert(pool.allocate_contiguous(32, 40) == nullptr);
+        
+        // The run is released as a unit
+        pool.deallocate(run);
+        assert(pool.allocate_contiguous(32, 64) == run);
+        
+        // A sized free naming one block still releases the whole run
+        pool.deallocate(run, 32);
+        assert(pool.getAvailableBlocks() == 128 - 32);
+        assert(pool.allocate_contiguous(32, 64) == run);
+        
+        std::cout << "  ✓ Contiguous Pool Allocation tests passed\n";
+    }
+    
+    static void testHybridRouting() {
+        std::cout << "Testing Hybrid Routing...\n";
+        
+        HybridAllocator allocator(64 * 1024);
+        
+        // Exhausting the smallest class falls back along its chain
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 4096; ++i) {
+            void* ptr = allocator.allocate(8);
+            if (!ptr) break;
+            ptrs.push_back(ptr);
+        }
+        assert(ptrs.size() > 64 * 1024 * 0.3 / 6 / 8);
+        
+        // Every pointer goes back to the sub-allocator that produced it
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+        assert(allocator.getDeallocationCount() == ptrs.size());
+        
+        std::cout << "  ✓ Hybrid Routing tests passed\n";
+    }
+    
+    static void testHybridRebalancing() {
+        std::cout << "Testing Hybrid Rebalancing...\n";
+        
+        // 1MB: the 64-byte pool holds ~200 blocks, buddy gets a 512KB block.
+        // No huge tier, so the 400KB probe below has to come from buddy.
+        HybridAllocator::HybridConfig config;
+        config.huge_threshold = 0;
+        HybridAllocator allocator(1024 * 1024, config);
+        
+        // A 64-byte-heavy load outgrows its pool and borrows chunks from buddy
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 3000; ++i) {
+            void* ptr = allocator.allocate(64);
+            assert(ptr != nullptr);
+            ptrs.push_back(ptr);
+        }
+        assert(allocator.allocate(400 * 1024) == nullptr); // Buddy is lent out
+        
+        // Once the load is gone the chunks go back and buddy is whole again
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+        assert(allocator.rebalance() > 0);
+        
+        void* large = allocator.allocate(400 * 1024);
+        assert(large != nullptr);
+        allocator.deallocate(large);
+        assert(allocator.getAllocatedSize() == 0);
+        
+        // reset() returns borrowed chunks too: the same load fits again, then buddy is whole
+        auto fill = [&allocator]() {
+            std::vector<void*> live;
+            while (void* ptr = allocator.allocate(64)) live.push_back(ptr);
+            return live.size();
+        };
+        size_t capacity = fill();
+        assert(capacity > 3000);
+        allocator.reset();
+        assert(fill() == capacity);
+        allocator.reset();
+        large = allocator.allocate(400 * 1024);
+        assert(large != nullptr);
+        allocator.deallocate(large);
+        
+        // Reclaimed slots are grown again over new chunks, pool and slab classes alike
+        for (int round = 0; round < 3; ++round) {
+            ptrs.clear();
+            for (int i = 0; i < 3000; ++i) ptrs.push_back(allocator.allocate(64));
+            for (int i = 0; i < 200; ++i) ptrs.push_back(allocator.allocate(500));
+            for (void* ptr : ptrs) {
+                assert(ptr != nullptr);
+                allocator.deallocate(ptr);
+            }
+            assert(allocator.rebalance() > 0);
+        }
+        assert(allocator.getAllocatedSize() == 0);
+        
+        std::cout << "  ✓ Hybrid Rebalancing tests passed\n";
+    }
+    
+    static void testSizeClassTable() {
+        std::cout << "Testing Size Class Table...\n";
+        
+        // Four classes per doubling keep rounding waste under 25% from 32 bytes up
+        SizeClassTable table(4096);
+        assert(table.getClassesPerDoubling() == 4);
+        for (size_t size = 1; size <= 4096; ++size) {
+            size_t class_size = table.roundUp(size);
+            assert(class_size >= size && class_size % SizeClassTable::kQuantum == 0);
+            if (size >= 32) assert((class_size - size) * 4 < size);
+        }
+        assert(table.roundUp(257) == 320 && table.roundUp(1025) == 1280);
+        assert(table.roundUp(4097) == 0);
+        
+        // A tighter bound means more classes per doubling
+        SizeClassTable fine(1024, 0.1);
+        assert(fine.getClassesPerDoubling() == 16);
+        
+        // The hybrid shares one table between pools and slabs
+        HybridAllocator allocator(1024 * 1024);
+        void* ptr = allocator.allocate(1025);
+        assert(ptr != nullptr);
+        assert(allocator.getAllocatedSize() == 1280);
+        allocator.deallocate(ptr);
+        
+        std::cout << "  ✓ Size Class Table tests passed\n";
+    }
+    
+    static void testHugeAllocations() {
+        std::cout << "Testing Huge Allocations...\n";
+        
+        // Far larger than the whole allocator: mapped from the OS instead of failing
+        HybridAllocator allocator(1024 * 1024);
+        char* huge = static_cast<char*>(allocator.allocate(8 * 1024 * 1024));
+        assert(huge != nullptr);
+        huge[8 * 1024 * 1024 - 1] = 42;
+        assert(allocator.getAllocatedSize() >= 8 * 1024 * 1024);
+        
+        // Growing keeps the contents, shrinking below the threshold moves back into the tiers
+        huge = static_cast<char*>(allocator.reallocate(huge, 32 * 1024 * 1024));
+        assert(huge != nullptr && huge[8 * 1024 * 1024 - 1] == 42);
+        assert(allocator.usableSize(huge) == 32 * 1024 * 1024);
+        huge[0] = 7;
+        char* small = static_cast<char*>(allocator.reallocate(huge, 100));
+        assert(small != nullptr && small[0] == 7);
+        assert(allocator.getAllocatedSize() == allocator.usableSize(small));
+        
+        allocator.deallocate(small);
+        assert(allocator.getAllocatedSize() == 0);
+        assert(allocator.getStats().find("Huge Allocations: 1") != std::string::npos);
+        
+        std::cout << "  ✓ Huge Allocations tests passed\n";
+    }
+    
+    static void testHybridProfileConfig() {
+        std::cout << "Testing Hybrid Profile Config...\n";
+        
+        // Config strings round-trip and reject unknown keys
+        HybridAllocator::HybridConfig config = HybridAllocator::HybridConfig::fromString(
+            "pool_block_sizes=24,48; pool_class_weights=1,3\nslab_object_sizes=;slab_objects_per_slab=;profiling=1");
+        assert(config.pool_block_sizes.size() == 2 && config.slab_object_sizes.empty());
+        assert(HybridAllocator::HybridConfig::fromString(config.toString()).toString() == config.toString());
+        
+        bool rejected = false;
+        try {
+            HybridAllocator::HybridConfig::fromString("pool_ratio=0.5");
+        } catch (const std::invalid_argument&) {
+            rejected = true;
+        }
+        assert(rejected);
+        
+        // Profiling records sizes rounded to 8 bytes with their peak live count
+        HybridAllocator allocator(256 * 1024, config);
+        void* a = allocator.allocate(20);
+        void* b = allocator.allocate(24);
+        allocator.deallocate(a);
+        allocator.deallocate(b);
+        assert(allocator.getProfile().find("\n24 2 0 2 2 ") != std::string::npos);
+        
+        // Odd configured classes are rounded up, so blocks keep 16-byte alignment
+        HybridAllocator::HybridConfig odd;
+        odd.pool_block_sizes = {100, 200};
+        odd.slab_object_sizes = {1000};
+        odd.slab_objects_per_slab = {8};
+        HybridAllocator rounded(256 * 1024, odd);
+        std::vector<void*> blocks;
+        for (int i = 0; i < 50; ++i) {
+            blocks.push_back(rounded.allocate(100));
+            blocks.push_back(rounded.allocate(1000));
+        }
+        for (void* block : blocks) {
+            assert(block != nullptr && reinterpret_cast<uintptr_t>(block) % 16 == 0);
+        }
+        assert(rounded.getAllocatedSize() == 50 * (112 + 1008));
+        for (void* block : blocks) rounded.deallocate(block);
+        assert(HybridAllocator::alignClassSize(1) == 8 && HybridAllocator::alignClassSize(24) == 32);
+        
+        std::cout << "  ✓ Hybrid Profile Config tests passed\n";
+    }
+    
+    static void testAllocatorAdapters() {
+        std::cout << "Testing Allocator Adapters...\n";
+        
+        // std::pmr containers on top of the hybrid allocator
+        HybridAllocator hybrid(1024 * 1024);
+        MemoryResourceAdapter resource(hybrid);
+        {
+            std::pmr::map<int, int> map(&resource);
+            for (int i = 0; i < 1000; ++i) map[i] = i * 2;
+            assert(map.size() == 1000 && map[500] == 1000);
+            assert(hybrid.getAllocatedSize() > 0);
+        }
+        assert(hybrid.getAllocatedSize() == 0);
+        
+        // Over-aligned requests are honoured and released through the original block
+        void* aligned = resource.allocate(100, 256);
+        assert(reinterpret_cast<uintptr_t>(aligned) % 256 == 0);
+        resource.deallocate(aligned, 100, 256);
+        assert(hybrid.getAllocatedSize() == 0);
+        
+        MemoryResourceAdapter same(hybrid);
+        assert(resource.is_equal(same));
+        assert(!resource.is_equal(*std::pmr::new_delete_resource()));
+        
+        // Odd object sizes are rounded up, so pools and slabs keep kNaturalAlignment
+        SlabAllocator odd_slab(100, 8, 4096);
+        PoolAllocator odd_pool(100, 8, 1024);
+        assert(odd_slab.getObjectSize() == 104 && odd_pool.getMaxBlockSize() == 104);
+        for (MemoryAllocator* odd : {static_cast<MemoryAllocator*>(&odd_slab), static_cast<MemoryAllocator*>(&odd_pool)}) {
+            std::vector<void*> blocks;
+            for (int i = 0; i < 8; ++i) {
+                void* block = allocator_adapters::allocateAligned(*odd, 100, alignof(double));
+                assert(block && reinterpret_cast<uintptr_t>(block) % allocator_adapters::kNaturalAlignment == 0);
+                blocks.push_back(block);
+            }
+            for (void* block : blocks) allocator_adapters::deallocateAligned(*odd, block, 100, alignof(double));
+            assert(odd->getAllocatedSize() == 0);
+        }
+        
+        // Stateful std allocator: rebinding keeps the same allocator
+        PoolAllocator::PoolConfig pool_config;
+        pool_config.block_sizes = {32, 64};
+        pool_config.blocks_per_pool = {256, 256};
+        pool_config.total_memory = 64 * 1024;
+        PoolAllocator pool(pool_config);
+        {
+            StlAllocator<int> alloc(pool);
+            std::list<int, StlAllocator<int>> list(alloc);
+            for (int i = 0; i < 100; ++i) list.push_back(i);
+            assert(list.size() == 100 && list.back() == 99);
+            assert(StlAllocator<double>(alloc) == alloc);
+            
+            // Out of memory surfaces as std::bad_alloc
+            bool threw = false;
+            try {
+                alloc.allocate(1024 * 1024);
+            } catch (const std::bad_alloc&) {
+                threw = true;
+            }
+            assert(threw);
+            assert(!pool.retire()); // Nodes still live
+        }
+        assert(pool.retire());
+        
+        std::cout << "  ✓ Allocator Adapters tests passed\n";
+    }
+    
+    static void testAlignedAllocations() {
+        std::cout << "Testing Aligned Allocations...\n";
+        
+        // What the LD_PRELOAD shim relies on for posix_memalign/aligned_alloc
+        HybridAllocator allocator(1024 * 1024);
+        for (size_t alignment : {16, 64, 4096}) {
+            for (size_t size : {1, 100, 3000, 300000}) {
+                void* ptr = allocator.allocateAligned(size, alignment);
+                assert(ptr != nullptr && reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+                assert(allocator.owns(ptr) && allocator.usableSize(ptr) >= size);
+                allocator.deallocate(ptr);
+            }
+        }
+        assert(allocator.getAllocatedSize() == 0);
+        
+        // 16-aligned requests stay 16-aligned after their class runs dry and falls back,
+        // with or without growth (48 falls back to 56, 32 to 40 and 56)
+        HybridAllocator::HybridConfig fixed;
+        fixed.adaptive_rebalancing = false;
+        HybridAllocator fixed_allocator(1024 * 1024, fixed);
+        std::vector<std::pair<HybridAllocator*, size_t>> cases = {{&allocator, 48}, {&fixed_allocator, 32}};
+        for (const auto& test : cases) {
+            std::vector<void*> ptrs;
+            while (void* ptr = test.first->allocateAligned(test.second, 16)) {
+                assert(reinterpret_cast<uintptr_t>(ptr) % 16 == 0);
+                ptrs.push_back(ptr);
+            }
+            assert(ptrs.size() > 1000);
+            for (void* ptr : ptrs) test.first->deallocate(ptr);
+            assert(test.first->getAllocatedSize() == 0);
+        }
+        
+        // realloc moves keep the requested alignment too
+        void* grown = allocator.allocateAligned(16, 16);
+        for (size_t size = 32; grown && size <= 2048; size += 16) {
+            grown = allocator.reallocate(grown, size, 16);
+            assert(grown && reinterpret_cast<uintptr_t>(grown) % 16 == 0);
+        }
+        allocator.deallocate(grown);
+        
+        // Beyond a page, or not a power of two: the caller has to look elsewhere
+        assert(allocator.allocateAligned(64, 8192) == nullptr);
+        assert(allocator.allocateAligned(64, 48) == nullptr);
+        int local = 0;
+        assert(!allocator.owns(&local));
+        
+        std::cout << "  ✓ Aligned Allocations tests passed\n";
+    }
+    
+    static void testSizedDeallocation() {
+        std::cout << "Testing Sized Deallocation...\n";
+        
+        // Buddy: blocks freed by size still coalesce back into the root
+        BuddyAllocator buddy(64 * 1024);
+        std::vector<std::pair<void*, size_t>> blocks;
+        for (size_t size : {100, 32, 5000, 700, 1}) {
+            blocks.push_back({buddy.allocate(size), size});
+        }
+        for (const auto& block : blocks) {
+            buddy.deallocate(block.first, block.second);
+        }
+        assert(buddy.getAllocatedSize() == 0);
+        void* whole = buddy.allocate(64 * 1024);
+        assert(whole != nullptr);
+        buddy.deallocate(whole, 64 * 1024);
+        
+        // Pool: a request that spilled into a larger pool, and a contiguous run
+        PoolAllocator::PoolConfig pool_config;
+        pool_config.block_sizes = {32, 64};
+        pool_config.blocks_per_pool = {1, 8};
+        pool_config.total_memory = 32 + 8 * 64;
+        PoolAllocator pool(pool_config);
+        void* small = pool.allocate(20);
+        void* spilled = pool.allocate(20);
+        void* run = pool.allocate_contiguous(64, 4);
+        assert(small && spilled && run);
+        pool.deallocate(spilled, 20);
+        pool.deallocate(small, 20);
+        pool.deallocate(run, 4 * 64);
+        assert(pool.retire());
+        
+        // Hybrid: every tier, including buddy fallback and huge mappings
+        HybridAllocator hybrid(1024 * 1024);
+        std::vector<std::pair<void*, size_t>> ptrs;
+        for (size_t size : {8, 24, 250, 1000, 3000, 20000, 8 * 1024 * 1024}) {
+            void* ptr = hybrid.allocate(size);
+            assert(ptr != nullptr);
+            ptrs.push_back({ptr, size});
+        }
+        for (const auto& ptr : ptrs) {
+            hybrid.deallocate(ptr.first, ptr.second);
+        }
+        assert(hybrid.getAllocatedSize() == 0);
+        assert(hybrid.getDeallocationCount() == ptrs.size());
+        
+        std::cout << "  ✓ Sized Deallocation tests passed\n";
+    }
+    
+    static void testStatsCounters() {
+        std::cout << "Testing Stats Counters...\n";
+        
+        // Single thread: peak is exact, per-class counters add up
+        StatsCounters counters(3);
+        counters.recordAllocation(100, 0);
+        counters.recordAllocation(300, 2);
+        counters.recordDeallocation(100, 0);
+        counters.recordAllocation(50, 1);
+        counters.recordFailure(2);
+        StatsCounters::Snapshot snapshot = counters.snapshot();
+        assert(snapshot.current_bytes == 350);
+        assert(snapshot.peak_bytes == 400);
+        assert(snapshot.allocations == 3 && snapshot.deallocations == 1 && snapshot.failures == 1);
+        assert(counters.classSnapshot(0).allocations == 1 && counters.classSnapshot(0).deallocations == 1);
+        assert(counters.classSnapshot(2).bytes_allocated == 300 && counters.classSnapshot(2).failures == 1);
+        
+        // Past the publish batch the peak still comes out exact
+        counters.reset();
+        for (int i = 0; i < 100; ++i) counters.recordAllocation(4096);
+        for (int i = 0; i < 100; ++i) counters.recordDeallocation(4096);
+        counters.recordAllocation(1024);
+        snapshot = counters.snapshot();
+        assert(snapshot.peak_bytes == 100 * 4096);
+        assert(snapshot.current_bytes == 1024);
+        
+        // Several threads: counts and bytes are exact, peak stays within its bound
+        const size_t threads = 8, rounds = 20000;
+        counters.reset();
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&counters, t]() {
+                for (size_t i = 0; i < rounds; ++i) {
+                    counters.recordAllocation(64, t % 3);
+                    counters.recordDeallocation(64, t % 3);
+                }
+                counters.recordAllocation(32);
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        snapshot = counters.snapshot();
+        assert(snapshot.allocations == threads * (rounds + 1));
+        assert(snapshot.deallocations == threads * rounds);
+        assert(snapshot.current_bytes == threads * 32);
+        assert(snapshot.peak_bytes >= threads * 32);
+        assert(snapshot.peak_bytes <= threads * 64 + StatsCounters::kShards * StatsCounters::kPeakBatch);
+        size_t class_allocations = 0;
+        for (size_t c = 0; c < 3; ++c) class_allocations += counters.classSnapshot(c).allocations;
+        assert(class_allocations == threads * rounds);
+        
+        // Allocators report through the same counters
+        PoolAllocator::PoolConfig config;
+        config.block_sizes = {32, 128};
+        config.blocks_per_pool = {4, 4};
+        config.total_memory = 4096;
+        PoolAllocator pool(config);
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 5; ++i) ptrs.push_back(pool.allocate(32));
+        assert(ptrs[4] != nullptr); // Spilled into the 128-byte pool
+        assert(pool.allocate(4096) == nullptr);
+        assert(pool.getAllocatedSize() == 4 * 32 + 128);
+        assert(pool.getFailedAllocationCount() == 1);
+        for (void* ptr : ptrs) pool.deallocate(ptr);
+        MemoryAllocator::AllocationStats stats = pool.getAllocationStats();
+        assert(stats.num_allocations == 5 && stats.num_deallocations == 5 && stats.num_failures == 1);
+        assert(stats.current_allocated == 0 && stats.peak_allocated == 4 * 32 + 128);
+        
+        std::cout << "  ✓ Stats Counters tests passed\n";
+    }
+    
+    static void testLatencyHistograms() {
+        std::cout << "Testing Latency Histograms...\n";
+        
+        // Buckets round up by at most 1/16
+        for (uint64_t value : {0ULL, 1ULL, 15ULL, 16ULL, 17ULL, 100ULL, 1000ULL, 123456789ULL}) {
+            uint64_t upper = LatencyHistogram::bucketUpperBound(LatencyHistogram::bucketFor(value));
+            assert(upper >= value && upper <= value + value / 16);
+        }
+        
+        LatencyHistogram histogram;
+        for (uint64_t value = 1; value <= 1000; ++value) histogram.record(value);
+        assert(histogram.getCount() == 1000 && histogram.getMax() == 1000);
+        assert(histogram.percentile(0.5) >= 500 && histogram.percentile(0.5) <= 500 + 500 / 16);
+        assert(histogram.percentile(0.99) >= 990 && histogram.percentile(0.999) <= 1000);
+        
+        // Off by default, every call timed with a rate of 1
+        PoolAllocator::PoolConfig config;
+        config.block_sizes = {32, 128};
+        config.blocks_per_pool = {64, 64};
+        config.total_memory = 64 * (32 + 128);
+        PoolAllocator pool(config);
+        void* ptr = pool.allocate(32);
+        pool.deallocate(ptr);
+        assert(pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE).count == 0);
+        
+        pool.enableLatencySampling(1);
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 30; ++i) ptrs.push_back(pool.allocate(32));
+        for (int i = 0; i < 10; ++i) ptrs.push_back(pool.allocate(100));
+        for (void* p : ptrs) pool.deallocate(p);
+        assert(pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE).count == 40);
+        assert(pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE, 0).count == 30);
+        assert(pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE, 1).count == 10);
+        assert(pool.getLatencySummary(LatencyRecorder::Op::DEALLOCATE).count == 40);
+        
+        LatencyHistogram::Summary summary = pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE);
+        assert(summary.p50_ns <= summary.p99_ns && summary.p99_ns <= summary.p999_ns &&
+               summary.p999_ns <= summary.max_ns);
+        MemoryAllocator::AllocationStats stats = pool.getAllocationStats();
+        assert(stats.avg_alloc_time_ns > 0.0 && stats.alloc_latency.count == 40);
+        assert(pool.getStats().find("Allocate Latency:") != std::string::npos);
+        
+        // One in ten on average for each op, then off again
+        pool.reset();
+        pool.enableLatencySampling(10);
+        for (int i = 0; i < 1000; ++i) pool.deallocate(pool.allocate(32));
+        size_t sampled = pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE).count;
+        size_t sampled_frees = pool.getLatencySummary(LatencyRecorder::Op::DEALLOCATE).count;
+        assert(sampled >= 50 && sampled <= 150 && sampled_frees >= 50 && sampled_frees <= 150);
+        pool.disableLatencySampling();
+        for (int i = 0; i < 100; ++i) pool.deallocate(pool.allocate(32));
+        assert(pool.getLatencySummary(LatencyRecorder::Op::ALLOCATE).count == sampled);
+        
+        // Hybrid attributes samples to the class that served them
+        HybridAllocator hybrid(4 * 1024 * 1024);
+        hybrid.enableLatencySampling(1);
+        for (int i = 0; i < 20; ++i) hybrid.deallocate(hybrid.allocate(24));
+        assert(hybrid.getLatencySummary(LatencyRecorder::Op::ALLOCATE).count == 20);
+        assert(hybrid.getLatencySummary(LatencyRecorder::Op::DEALLOCATE).count == 20);
+        assert(hybrid.getStats().find("      allocate:") != std::string::npos);
+        
+        std::cout << "  ✓ Latency Histograms tests passed\n";
+    }
+    
+    static void testAllocationTrace() {
+        std::cout << "Testing Allocation Trace...\n";
+        
+        const std::string path = "allocation_trace_test.bin";
+        BuddyAllocator buddy(1024 * 1024);
+        {
+            // More records than one chunk per thread, two threads, one object freed by the other thread
+            TraceWriter writer(path);
+            TracingAllocator traced(buddy, writer);
+            void* shared = traced.allocate(100);
+            
+            auto work = [&traced](size_t size) {
+                for (int i = 0; i < 3000; ++i) {
+                    void* ptr = traced.allocate(size);
+                    assert(ptr != nullptr);
+                    traced.deallocate(ptr, size);
+                }
+            };
+            std::thread other(work, 48);
+            work(16);
+            other.join();
+            
+            std::thread([&traced, shared]() { traced.deallocate(shared); }).join();
+            writer.finish();
+            assert(writer.getRecordCount() == 2 + 4 * 3000);
+        }
+        assert(buddy.getAllocatedSize() == 0);
+        
+        AllocationTrace trace = AllocationTrace::load(path);
+        std::remove(path.c_str());
+        assert(trace.thread_count == 3 && trace.records.size() == 2 + 4 * 3000);
+        assert(trace.ns_per_tick > 0.0);
+        
+        // Sorted by time, and every free follows the allocation it releases
+        std::map<uint64_t, size_t> live;
+        size_t per_thread[3] = {0, 0, 0};
+        for (size_t i = 0; i < trace.records.size(); ++i) {
+            const TraceRecord& record = trace.records[i];
+            assert(i == 0 || trace.records[i - 1].timestamp <= record.timestamp);
+            ++per_thread[record.thread];
+            if (static_cast<TraceOp>(record.op) == TraceOp::ALLOCATE) {
+                assert(live.count(record.object_id) == 0);
+                live[record.object_id] = record.size;
+            } else {
+                assert(live.count(record.object_id) == 1);
+                assert(record.size == 0 || record.size == live[record.object_id]);
+                live.erase(record.object_id);
+            }
+        }
+        assert(live.empty());
+        assert(per_thread[0] == 1 + 6000 && per_thread[1] == 6000 && per_thread[2] == 1);
+        
+        bool rejected = false;
+        try {
+            AllocationTrace::load("missing_trace.bin");
+        } catch (const std::runtime_error&) {
+            rejected = true;
+        }
+        assert(rejected);
+        
+        std::cout << "  ✓ Allocation Trace tests passed\n";
+    }
+    
+    static void testLockContention() {
+        std::cout << "Testing Lock Contention Counters...\n";
+        
+        // Every acquisition counts, only the ones that had to wait count as contended
+        ContendedMutex mutex;
+        {
+            std::lock_guard<ContendedMutex> lock(mutex);
+        }
+        assert(mutex.try_lock());
+        mutex.unlock();
+        assert(mutex.getAcquisitions() == 2 && mutex.getContended() == 0);
+        
+        std::atomic<bool> started{false};
+        mutex.lock();
+        std::thread waiter([&]() {
+            started = true;
+            std::lock_guard<ContendedMutex> lock(mutex);
+        });
+        while (!started) std::this_thread::yield();
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        assert(!mutex.try_lock());
+        mutex.unlock();
+        waiter.join();
+        assert(mutex.getAcquisitions() == 4 && mutex.getContended() == 1);
+        
+        BuddyAllocator buddy(1024 * 1024);
+        PoolAllocator pool(64, 16, 64 * 16);
+        SlabAllocator slab(64, 16, 64 * 1024);
+        HybridAllocator hybrid(1024 * 1024);
+        for (MemoryAllocator* allocator : std::vector<MemoryAllocator*>{&buddy, &pool, &slab, &hybrid}) {
+            MemoryAllocator::LockStats before = allocator->getLockStats();
+            void* ptr = allocator->allocate(64);
+            assert(ptr != nullptr);
+            allocator->deallocate(ptr);
+            MemoryAllocator::LockStats after = allocator->getLockStats();
+            assert(after.acquisitions >= before.acquisitions + 2);
+            assert(after.contended == 0);
+        }
+        
+        std::cout << "  ✓ Lock Contention Counter tests passed\n";
+    }
+    
+    static void testRemoteFrees() {
+        std::cout << "Testing Remote Frees...\n";
+        
+        PoolAllocator pool(64, 256, 64 * 256);
+        SlabAllocator slab(64, 64, 64 * 1024);
+        pool.bindOwnerThread();
+        slab.bindOwnerThread();
+        
+        auto check = [](MemoryAllocator& allocator, auto& remote) {
+            std::vector<void*> blocks;
+            for (int i = 0; i < 100; ++i) {
+                blocks.push_back(allocator.allocate(64));
+                assert(blocks.back() != nullptr);
+            }
+            size_t allocated = allocator.getAllocatedSize();
+            
+            // Other threads never take the lock; the blocks stay allocated until drained
+            uint64_t acquisitions = allocator.getLockStats().acquisitions;
+            std::thread first([&]() { for (int i = 0; i < 50; ++i) allocator.deallocate(blocks[i]); });
+            std::thread second([&]() { allocator.deallocate_batch(blocks.data() + 50, 49); });
+            first.join();
+            second.join();
+            assert(allocator.getLockStats().acquisitions == acquisitions);
+            assert(remote.getRemoteFreeCount() == 99);
+            assert(allocator.getAllocatedSize() == allocated);
+            
+            // The owner's free is local, its next allocation returns the queued ones
+            allocator.deallocate(blocks[99]);
+            void* ptr = allocator.allocate(64);
+            assert(ptr != nullptr);
+            assert(allocator.getAllocatedSize() == 64);
+            allocator.deallocate(ptr);
+            assert(allocator.getAllocatedSize() == 0);
+            
+            // Pointers outside the region are refused before anything is written through them;
+            // a double free loops the queue, and the drain skips it without losing the other blocks
+            void* a = allocator.allocate(64);
+            void* b = allocator.allocate(64);
+            std::thread([&]() {
+                int outside = 0;
+                assert(!remote.release(&outside));
+                assert(!remote.release(static_cast<char*>(a) + 8));
+                assert(remote.release(a) && remote.release(a) && remote.release(b));
+            }).join();
+            assert(remote.getRemoteFreeCount() == 102);
+            remote.drainRemoteFrees();
+            assert(allocator.getAllocatedSize() == 0);
+            
+            // Unbound, a foreign free is immediate again
+            remote.unbindOwnerThread();
+            ptr = allocator.allocate(64);
+            std::thread([&]() { allocator.deallocate(ptr); }).join();
+            assert(allocator.getAllocatedSize() == 0 && remote.getRemoteFreeCount() == 102);
+        };
+        check(pool, pool);
+        check(slab, slab);
+        
+        // retire() drains first, so a block freed remotely does not keep the pool alive
+        PoolAllocator owned(64, 16, 64 * 16);
+        owned.bindOwnerThread();
+        void* ptr = owned.allocate(64);
+        std::thread([&]() { owned.deallocate(ptr); }).join();
+        assert(owned.retire());
+        
+        std::cout << "  ✓ Remote Free tests passed\n";
+    }
+    
+    static void testArenaAllocator() {
+        std::cout << "Testing Arena Allocator...\n";
+        
+        ArenaAllocator arena(1024 * 1024, 4096);
+        assert(arena.getChunkCount() == 1);
+        
+        // Bump allocations are aligned and consecutive within a chunk
+        char* first = static_cast<char*>(arena.allocate(10));
+        char* second = static_cast<char*>(arena.allocate(10));
+        assert(first && second == first + 16);
+        void* page = arena.allocate(100, 256);
+        assert(reinterpret_cast<uintptr_t>(page) % 256 == 0);
+        assert(arena.allocate(8, 3) == nullptr); // Not a power of two
+        
+        // deallocate() is a no-op, memory stays in use until reset()
+        arena.deallocate(first);
+        assert(arena.getAllocatedSize() == 120);
+        
+        // Overflowing a chunk chains a new one; a large request gets its own chunk
+        for (int i = 0; i < 100; ++i) {
+            assert(arena.allocate(64) != nullptr);
+        }
+        void* large = arena.allocate(64 * 1024);
+        assert(large != nullptr);
+        assert(arena.getChunkCount() >= 3);
+        assert(arena.getFragmentation() < 100);
+        
+        // reset() unmaps all but the first chunk and rewinds it
+        size_t allocations = arena.getAllocationCount();
+        arena.reset();
+        assert(arena.getChunkCount() == 1 && arena.getMappedBytes() == 4096);
+        assert(arena.getAllocatedSize() == 0 && arena.getDeallocationCount() == allocations);
+        assert(arena.allocate(10) == first);
+        
+        // The cap bounds what can be mapped
+        ArenaAllocator small(8192, 4096);
+        assert(small.allocate(16 * 1024) == nullptr);
+        assert(small.allocate(2048) != nullptr && small.allocate(2048) != nullptr);
+        assert(small.allocate(2048) == nullptr && small.getFailedAllocationCount() == 2);
+        
+        auto from_factory = AllocatorFactory::create_allocator(AllocatorFactory::AllocatorType::ARENA, 1024 * 1024);
+        assert(from_factory->allocate(100) != nullptr);
+        
+        std::cout << "  ✓ Arena Allocator tests passed\n";
+    }
+    
+    static void testStackAllocator() {
+        std::cout << "Testing Stack and Frame Allocators...\n";
+        
+        using End = StackAllocator::End;
+        StackAllocator stack(4096);
+        
+        // Persistent data from the bottom, scratch from the top
+        char* level = static_cast<char*>(stack.allocate(100));
+        assert(level && stack.getUsed(End::BOTTOM) == 100);
+        StackAllocator::Marker frame_start = stack.getMarker(End::TOP);
+        char* scratch = static_cast<char*>(stack.allocate(200, End::TOP, 64));
+        assert(scratch && reinterpret_cast<uintptr_t>(scratch) % 64 == 0);
+        assert(scratch + 200 <= level + 4096 && scratch > level + 100);
+        assert(stack.allocate(50, End::TOP) != nullptr);
+        assert(stack.getAllocationCount() == 3 && stack.getAllocatedSize() == 350);
+        
+        // Popping the top leaves the bottom alone
+        stack.freeToMarker(frame_start);
+        assert(stack.getUsed(End::TOP) == 0 && stack.getUsed(End::BOTTOM) == 100);
+        assert(stack.getAllocatedSize() == 100 && stack.getDeallocationCount() == 2);
+        assert(stack.allocate(200, End::TOP, 64) == scratch);
+        
+        // Nested markers on the bottom
+        StackAllocator::Marker outer = stack.getMarker();
+        stack.allocate(16);
+        StackAllocator::Marker inner = stack.getMarker();
+        stack.allocate(16);
+        stack.freeToMarker(inner);
+        stack.freeToMarker(outer);
+        assert(stack.getUsed(End::BOTTOM) == 100);
+        bool threw = false;
+        try {
+            stack.freeToMarker(inner); // Stale: above the current top
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        
+        // The ends meet: failure, not overlap
+        size_t remaining = stack.getRemaining();
+        assert(stack.allocate(remaining + 1) == nullptr);
+        assert(stack.allocate(remaining, End::TOP, 1) != nullptr && stack.getRemaining() == 0);
+        assert(stack.allocate(1) == nullptr);
+        stack.reset();
+        assert(stack.getAllocatedSize() == 0 && stack.getRemaining() == 4096);
+        
+        // Double-buffered frames: data lives through the next frame only
+        FrameAllocator frames(8192);
+        assert(frames.getFrameCapacity() == 4096);
+        int* first = static_cast<int*>(frames.allocate(sizeof(int)));
+        *first = 42;
+        frames.nextFrame();
+        assert(frames.getUsed(true) > 0 && *first == 42);
+        int* second = static_cast<int*>(frames.allocate(sizeof(int)));
+        assert(second != first && frames.getAllocatedSize() == 2 * sizeof(int));
+        frames.nextFrame(); // Frees the first frame's data
+        assert(frames.getAllocatedSize() == sizeof(int) && frames.getFrameNumber() == 2);
+        assert(frames.allocate(sizeof(int)) == first);
+        assert(frames.allocate(4097) == nullptr);
+        frames.reset();
+        assert(frames.getAllocatedSize() == 0);
+        
+        auto from_factory = AllocatorFactory::create_allocator(AllocatorFactory::AllocatorType::STACK, 64 * 1024);
+        assert(from_factory->allocate(100) != nullptr);
+        
+        std::cout << "  ✓ Stack and Frame Allocator tests passed\n";
+    }
+    
+    static void testTlsfAllocator() {
+        std::cout << "Testing TLSF Allocator...\n";
+        
+        TlsfAllocator tlsf(64 * 1024);
+        size_t whole = tlsf.getLargestFreeBlock();
+        assert(tlsf.getFreeBlockCount() == 1 && tlsf.checkHeap());
+        
+        // Rounded to 16 bytes, not to a power of two
+        void* a = tlsf.allocate(100);
+        void* b = tlsf.allocate(1000);
+        void* c = tlsf.allocate(3000);
+        assert(a && b && c);
+        assert(reinterpret_cast<uintptr_t>(a) % TlsfAllocator::kAlignment == 0);
+        assert(tlsf.getBlockSize(a) == 112 && tlsf.getBlockSize(b) == 1008 && tlsf.getBlockSize(c) == 3008);
+        std::memset(b, 0xAB, 1000);
+        
+        // A freed block is reused by a request of its size
+        tlsf.deallocate(b);
+        assert(tlsf.getBlockSize(b) == 0 && tlsf.checkHeap());
+        assert(tlsf.allocate(1000) == b);
+        void* sized = tlsf.allocate(200);
+        tlsf.deallocate(sized, 200);
+        assert(tlsf.getBlockSize(sized) == 0 && tlsf.checkHeap());
+        
+        // Double frees and foreign pointers are ignored
+        tlsf.deallocate(b);
+        size_t deallocations = tlsf.getDeallocationCount();
+        tlsf.deallocate(b);
+        int outside = 0;
+        tlsf.deallocate(&outside);
+        tlsf.deallocate(static_cast<char*>(c) + 16);
+        assert(tlsf.getDeallocationCount() == deallocations && tlsf.checkHeap());
+        
+        // Freeing everything coalesces back into one block
+        tlsf.deallocate(a);
+        tlsf.deallocate(c);
+        assert(tlsf.getFreeBlockCount() == 1 && tlsf.getLargestFreeBlock() == whole);
+        assert(tlsf.getAllocatedSize() == 0 && tlsf.getFragmentation() == 0);
+        
+        // The whole region can be handed out, and nothing more
+        void* all = tlsf.allocate(whole);
+        assert(all && tlsf.allocate(16) == nullptr);
+        tlsf.deallocate(all);
+        assert(tlsf.allocate(whole + 1) == nullptr);
+        
+        // Random churn keeps the boundary tags, lists and bitmaps consistent
+        std::mt19937 gen(7);
+        std::vector<void*> live;
+        for (int i = 0; i < 20000; ++i) {
+            if (!live.empty() && gen() % 2) {
+                size_t index = gen() % live.size();
+                tlsf.deallocate(live[index]);
+                live[index] = live.back();
+                live.pop_back();
+            } else if (void* ptr = tlsf.allocate(1 + gen() % 2048)) {
+                live.push_back(ptr);
+            }
+            if (i % 1000 == 0) assert(tlsf.checkHeap());
+        }
+        assert(tlsf.getFragmentation() <= 100);
+        for (void* ptr : live) tlsf.deallocate(ptr);
+        assert(tlsf.checkHeap() && tlsf.getFreeBlockCount() == 1);
+        
+        tlsf.allocate(500);
+        tlsf.reset();
+        assert(tlsf.getLargestFreeBlock() == whole && tlsf.getAllocatedSize() == 0);
+        
+        auto from_factory = AllocatorFactory::create_allocator(AllocatorFactory::AllocatorType::TLSF, 1024 * 1024);
+        assert(from_factory->allocate(100) != nullptr);
+        
+        std::cout << "  ✓ TLSF Allocator tests passed\n";
+    }
+    
+#ifndef _WIN32
+    struct PersistentNode {
+        uint64_t value;
+        OffsetPtr<PersistentNode> next;
+    };
+    
+    static void testPersistentAllocator() {
+        std::cout << "Testing Persistent Allocator...\n";
+        
+        const std::string path = "persistent_heap_test.bin";
+        const std::string crashed = "persistent_heap_crashed.bin";
+        std::remove(path.c_str());
+        std::remove(crashed.c_str());
+        
+        // A list of 1000 nodes plus some garbage that gets freed
+        size_t allocated = 0;
+        {
+            PersistentAllocator heap(path, 4 * 1024 * 1024, PersistentAllocator::OpenMode::CREATE);
+            assert(heap.wasCreated() && heap.getRoot() == nullptr);
+            
+            PersistentNode* head = nullptr;
+            for (uint64_t i = 0; i < 1000; ++i) {
+                void* garbage = heap.allocate(100 + i);
+                auto* node = static_cast<PersistentNode*>(heap.allocate(sizeof(PersistentNode)));
+                assert(node != nullptr && reinterpret_cast<uintptr_t>(node) % 16 == 0);
+                node->value = i;
+                node->next = head;
+                head = node;
+                heap.deallocate(garbage);
+            }
+            void* sized = heap.allocate(64);
+            heap.deallocate(sized, 64);
+            heap.setRoot(head);
+            allocated = heap.getAllocatedSize();
+            
+            // A second user of the same file is refused while this one has it
+            bool refused = false;
+            try {
+                PersistentAllocator other(path, 0);
+            } catch (const std::runtime_error&) {
+                refused = true;
+            }
+            assert(refused);
+            
+            // Copying the file now captures the heap as a crashed process would leave it
+            std::ifstream in(path, std::ios::binary);
+            std::ofstream out(crashed, std::ios::binary);
+            out << in.rdbuf();
+        }
+        
+        auto verify = [allocated](PersistentAllocator& heap) {
+            assert(!heap.wasCreated());
+            assert(heap.getAllocatedSize() == allocated);
+            uint64_t expected = 1000;
+            for (auto* node = static_cast<PersistentNode*>(heap.getRoot()); node; node = node->next.get()) {
+                assert(node->value == --expected);
+            }
+            assert(expected == 0);
+        };
+        {
+            PersistentAllocator heap(path, 0, PersistentAllocator::OpenMode::OPEN);
+            assert(!heap.wasRecovered());
+            verify(heap);
+            
+            // Freed blocks are reused before new space is carved
+            void* ptr = heap.allocate(100);
+            assert(ptr != nullptr && heap.getFragmentation() > 0);
+            heap.deallocate(ptr);
+            heap.deallocate(ptr); // Double free is ignored
+            assert(heap.getAllocatedSize() == allocated);
+        }
+        {
+            PersistentAllocator heap(crashed, 0, PersistentAllocator::OpenMode::OPEN);
+            assert(heap.wasRecovered());
+            verify(heap);
+            
+            heap.reset();
+            assert(heap.getRoot() == nullptr && heap.getAllocatedSize() == 0);
+        }
+        
+        // Wrong mode, or a file that is not a heap
+        auto rejects = [](const std::string& file, PersistentAllocator::OpenMode mode) {
+            try {
+                PersistentAllocator heap(file, 1024 * 1024, mode);
+            } catch (const std::runtime_error&) {
+                return true;
+            }
+            return false;
+        };
+        assert(rejects(path, PersistentAllocator::OpenMode::CREATE));
+        assert(rejects("missing_heap.bin", PersistentAllocator::OpenMode::OPEN));
+        {
+            std::ofstream out(crashed, std::ios::binary | std::ios::trunc);
+            out << std::string(8192, 'x');
+        }
+        assert(rejects(crashed, PersistentAllocator::OpenMode::OPEN_OR_CREATE));
+        
+        std::remove(path.c_str());
+        std::remove(crashed.c_str());
+        std::cout << "  ✓ Persistent Allocator tests passed\n";
+    }
+    
+    struct SharedMessage {
+        uint64_t sequence;
+        char text[56];
+    };
+    
+    static void testSharedMemoryAllocator() {
+        std::cout << "Testing Shared Memory Allocator...\n";
+        
+        // Two mappings of one named region: blocks cross over by offset
+        const std::string name = "/memory-allocator-test-" + std::to_string(getpid());
+        {
+            SharedMemoryAllocator front(name, 1024 * 1024, SharedMemoryAllocator::OpenMode::CREATE);
+            SharedMemoryAllocator worker(name, 0, SharedMemoryAllocator::OpenMode::OPEN);
+            assert(front.wasCreated() && !worker.wasCreated());
+            assert(front.fromOffset(1) != worker.fromOffset(1)); // Mapped at different addresses
+            
+            auto* message = static_cast<SharedMessage*>(front.allocate(sizeof(SharedMessage)));
+            assert(message != nullptr);
+            message->sequence = 7;
+            std::strcpy(message->text, "hello");
+            
+            auto* received = static_cast<SharedMessage*>(worker.fromOffset(front.toOffset(message)));
+            assert(received->sequence == 7 && std::strcmp(received->text, "hello") == 0);
+            worker.deallocate(received);
+            assert(front.getHeapTotals().live_blocks == 0);
+            
+            // Freed by the worker, reused by the front end
+            assert(front.allocate(sizeof(SharedMessage)) == message);
+            front.deallocate(message);
+            
+            void* sized = worker.allocate(sizeof(SharedMessage));
+            worker.deallocate(sized, sizeof(SharedMessage));
+            assert(front.getHeapTotals().live_blocks == 0);
+            
+            bool refused = false;
+            try {
+                SharedMemoryAllocator again(name, 1024, SharedMemoryAllocator::OpenMode::CREATE);
+            } catch (const std::runtime_error&) {
+                refused = true;
+            }
+            assert(refused);
+        }
+        assert(SharedMemoryAllocator::unlink(name));
+        
+        // Blocks are buddies: a larger free block is split down, freed halves merge back
+        {
+            SharedMemoryAllocator heap(64 * 1024);
+            char* small = static_cast<char*>(heap.allocate(16));     // 32-byte class
+            char* large = static_cast<char*>(heap.allocate(1000));   // 1024-byte class
+            assert(large - small == 1024);                           // Aligned to its size
+            assert(heap.getHeapTotals().used == 2048 && heap.getHeapTotals().free_bytes == 1024 - 32);
+            heap.deallocate(small);
+            assert(heap.getHeapTotals().free_bytes == 1024);         // Merged with the gap blocks
+            
+            heap.deallocate(large);
+            char* first = static_cast<char*>(heap.allocate(100));    // 128-byte class
+            char* second = static_cast<char*>(heap.allocate(100));
+            assert(first == small && second == first + 128);
+            assert(heap.getHeapTotals().used == 2048 && heap.getHeapTotals().free_bytes == 2048 - 256);
+            
+            heap.deallocate(second);
+            heap.deallocate(first);
+            std::vector<MemoryAllocator::MemoryBlock> layout = heap.getMemoryLayout();
+            assert(layout.size() == 3 && layout[1].size == 2048 && layout[1].is_free);
+            assert(heap.allocate(2000) == small);
+        }
+        
+        // Anonymous region shared with a forked child, which frees the message and answers
+        SharedMemoryAllocator shared(1024 * 1024);
+        auto* request = static_cast<SharedMessage*>(shared.allocate(sizeof(SharedMessage)));
+        request->sequence = 41;
+        uint64_t request_offset = shared.toOffset(request);
+        
+        pid_t child = fork();
+        if (child == 0) {
+            std::unique_ptr<SharedMemoryAllocator> attached = SharedMemoryAllocator::attach(shared.getFd());
+            auto* in = static_cast<SharedMessage*>(attached->fromOffset(request_offset));
+            auto* reply = static_cast<SharedMessage*>(attached->allocate(sizeof(SharedMessage)));
+            bool ok = in->sequence == 41 && reply != nullptr;
+            if (ok) {
+                reply->sequence = in->sequence + 1;
+                attached->deallocate(in);
+                attached->setRoot(reply);
+            }
+            _exit(ok ? 0 : 1);
+        }
+        int status = 0;
+        assert(child > 0 && waitpid(child, &status, 0) == child);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        
+        auto* reply = static_cast<SharedMessage*>(shared.getRoot());
+        assert(reply != nullptr && reply->sequence == 42);
+        assert(shared.getHeapTotals().live_blocks == 1);
+        shared.deallocate(reply);
+        assert(shared.getRoot() == nullptr && shared.getHeapTotals().allocated_bytes == 0);
+        
+        std::cout << "  ✓ Shared Memory Allocator tests passed\n";
+    }
+#endif
 };
 
 // Performance benchmarks
@@ -0,0 +1,273 @@
+#include "hybrid_allocator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Offline HybridConfig tuner
+ *
+ * Reads a profile written by HybridAllocator::saveProfile() (run with
+ * HybridConfig::profiling = true) and prints a HybridConfig string that
+ * AllocatorFactory::create_allocator(HYBRID, size, "@file") can load.
+ *
+ * - Size classes: routed sizes are split into at most pool + slab classes
+ *   so that the bytes wasted rounding up to a class, weighted by how many
+ *   objects of that size were live at peak, are minimal (dynamic programming
+ *   over the sorted sizes). Classes are the aligned sizes the allocator
+ *   accepts (HybridAllocator::alignClassSize).
+ * - Blocks per class: peak live objects plus any failed requests, with
+ *   headroom for short-lived sizes whose peak varies from run to run.
+ * - Tier ratios: bytes each tier needs, keeping a share of buddy for
+ *   adaptive rebalancing.
+ *
+ * Usage: hybrid_tuner <profile> [-o file] [--pool-classes N] [--slab-classes N]
+ *                     [--max-routed BYTES] [--headroom F] [--buddy-reserve F]
+ */
+
+namespace {
+
+struct SizeDemand {
+    size_t size;
+    size_t requests;
+    size_t failures;
+    size_t peak_live;
+    size_t frees;
+    uint64_t lifetime_sum;
+    size_t need;  // Objects to provision for
+};
+
+struct TunerOptions {
+    std::string profile_path;
+    std::string output_path;
+    size_t pool_classes = 6;
+    size_t slab_classes = 4;
+    size_t max_routed = 4096;
+    double headroom = 0.25;       // Extra blocks for short-lived sizes
+    double long_headroom = 0.05;  // Extra blocks for sizes that live most of the run
+    double buddy_reserve = 0.1;   // Share of memory left to buddy for rebalancing
+};
+
+void printUsage() {
+    std::cerr << "Usage: hybrid_tuner <profile> [-o file] [--pool-classes N] [--slab-classes N]\n"
+              << "                    [--max-routed BYTES] [--headroom F] [--buddy-reserve F]\n";
+}
+
+bool parseOptions(int argc, char* argv[], TunerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "-o" && has_value) options.output_path = argv[++i];
+        else if (arg == "--pool-classes" && has_value) options.pool_classes = std::stoul(argv[++i]);
+        else if (arg == "--slab-classes" && has_value) options.slab_classes = std::stoul(argv[++i]);
+        else if (arg == "--max-routed" && has_value) options.max_routed = std::stoul(argv[++i]);
+        else if (arg == "--headroom" && has_value) options.headroom = std::stod(argv[++i]);
+        else if (arg == "--buddy-reserve" && has_value) options.buddy_reserve = std::stod(argv[++i]);
+        else if (arg[0] != '-' && options.profile_path.empty()) options.profile_path = arg;
+        else return false;
+    }
+    return !options.profile_path.empty();
+}
+
+bool readProfile(const std::string& path, std::vector<SizeDemand>& demands) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream row(line);
+        SizeDemand demand{};
+        if (row >> demand.size >> demand.requests >> demand.failures >> demand.peak_live
+                >> demand.frees >> demand.lifetime_sum) {
+            demands.push_back(demand);
+        }
+    }
+
+    std::sort(demands.begin(), demands.end(),
+              [](const SizeDemand& a, const SizeDemand& b) { return a.size < b.size; });
+    return true;
+}
+
+size_t nextPowerOfTwo(size_t size) {
+    size_t power = 32; // Buddy's minimum block
+    while (power < size) power <<= 1;
+    return power;
+}
+
+// Splits demands[0..n) into at most max_groups classes; returns the last index of each class
+std::vector<size_t> chooseClasses(const std::vector<SizeDemand>& demands, size_t max_groups) {
+    size_t n = demands.size();
+    if (n == 0 || max_groups == 0) return {};
+    max_groups = std::min(max_groups, n);
+
+    // Prefix sums of objects and bytes so a class's waste is O(1)
+    std::vector<double> objects(n + 1, 0.0), bytes(n + 1, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        objects[i + 1] = objects[i] + demands[i].need;
+        bytes[i + 1] = bytes[i] + static_cast<double>(demands[i].need) * demands[i].size;
+    }
+    auto waste = [&](size_t first, size_t last) { // Sizes first..last rounded up to demands[last]'s class
+        double class_size = static_cast<double>(HybridAllocator::alignClassSize(demands[last].size));
+        return class_size * (objects[last + 1] - objects[first]) - (bytes[last + 1] - bytes[first]);
+    };
+
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<double>> cost(max_groups + 1, std::vector<double>(n, infinity));
+    std::vector<std::vector<size_t>> split(max_groups + 1, std::vector<size_t>(n, 0));
+
+    for (size_t last = 0; last < n; ++last) {
+        cost[1][last] = waste(0, last);
+    }
+    for (size_t groups = 2; groups <= max_groups; ++groups) {
+        for (size_t last = groups - 1; last < n; ++last) {
+            for (size_t first = groups - 1; first <= last; ++first) {
+                double candidate = cost[groups - 1][first - 1] + waste(first, last);
+                if (candidate < cost[groups][last]) {
+                    cost[groups][last] = candidate;
+                    split[groups][last] = first;
+                }
+            }
+        }
+    }
+
+    // Fewer classes are fine when they waste no more
+    size_t best = 1;
+    for (size_t groups = 2; groups <= max_groups; ++groups) {
+        if (cost[groups][n - 1] < cost[best][n - 1]) best = groups;
+    }
+
+    std::vector<size_t> ends;
+    for (size_t groups = best, last = n - 1; groups > 0; --groups) {
+        ends.push_back(last);
+        if (groups > 1) last = split[groups][last] - 1;
+    }
+    std::reverse(ends.begin(), ends.end());
+    return ends;
+}
+
+// Bytes lost rounding each routed size up to its class, as a percentage of requested bytes
+double internalFragmentation(const std::vector<SizeDemand>& demands, const std::vector<size_t>& class_sizes) {
+    double requested = 0.0, wasted = 0.0;
+    for (const auto& demand : demands) {
+        auto it = std::lower_bound(class_sizes.begin(), class_sizes.end(), demand.size);
+        if (it == class_sizes.end()) continue;
+        requested += static_cast<double>(demand.need) * demand.size;
+        wasted += static_cast<double>(demand.need) * (*it - demand.size);
+    }
+    return requested > 0.0 ? wasted * 100.0 / requested : 0.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TunerOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<SizeDemand> demands;
+    if (!readProfile(options.profile_path, demands) || demands.empty()) {
+        std::cerr << "Cannot read profile " << options.profile_path << "\n";
+        return 1;
+    }
+
+    // The run length in allocations is the yardstick for "long-lived"
+    uint64_t run_length = 0;
+    for (const auto& demand : demands) run_length += demand.requests - demand.failures;
+
+    std::vector<SizeDemand> routed;
+    double buddy_bytes = 0.0;
+    for (auto& demand : demands) {
+        bool long_lived = demand.frees == 0 ||
+                          demand.lifetime_sum / demand.frees * 4 >= std::max<uint64_t>(run_length, 1);
+        double headroom = long_lived ? options.long_headroom : options.headroom;
+        demand.need = static_cast<size_t>(std::ceil((demand.peak_live + demand.failures) * (1.0 + headroom)));
+
+        if (demand.size <= options.max_routed) {
+            routed.push_back(demand);
+        } else {
+            buddy_bytes += static_cast<double>(demand.need) * nextPowerOfTwo(demand.size);
+        }
+    }
+
+    HybridAllocator::HybridConfig config;
+    config.pool_block_sizes.clear();
+    config.slab_object_sizes.clear();
+    config.slab_objects_per_slab.clear();
+
+    // Smallest classes become pools, the rest slabs
+    std::vector<size_t> ends = chooseClasses(routed, options.pool_classes + options.slab_classes);
+    double pool_bytes = 0.0, slab_bytes = 0.0;
+    size_t first = 0;
+    for (size_t group = 0; group < ends.size(); ++group) {
+        size_t class_size = HybridAllocator::alignClassSize(routed[ends[group]].size);
+        size_t objects = 0;
+        for (size_t i = first; i <= ends[group]; ++i) objects += routed[i].need;
+        first = ends[group] + 1;
+
+        if (group < options.pool_classes) {
+            double class_bytes = static_cast<double>(class_size) * objects;
+            config.pool_block_sizes.push_back(class_size);
+            config.pool_class_weights.push_back(class_bytes);
+            pool_bytes += class_bytes;
+        } else {
+            // Roughly page-sized slabs
+            size_t per_slab = std::min<size_t>(std::max<size_t>(4096 / class_size, 8), 64);
+            size_t slabs = (objects + per_slab - 1) / per_slab;
+            double class_bytes = static_cast<double>(slabs) * SlabAllocator::getSlabSize(class_size, per_slab);
+            config.slab_object_sizes.push_back(class_size);
+            config.slab_objects_per_slab.push_back(per_slab);
+            config.slab_class_weights.push_back(class_bytes);
+            slab_bytes += class_bytes;
+        }
+    }
+
+    config.pool_max_size = config.pool_block_sizes.empty() ? 0 : config.pool_block_sizes.back();
+    config.slab_max_size = config.slab_object_sizes.empty() ? config.pool_max_size : config.slab_object_sizes.back();
+
+    double total_bytes = pool_bytes + slab_bytes + buddy_bytes;
+    config.pool_memory_ratio = total_bytes > 0.0 ? pool_bytes / total_bytes : 0.0;
+    config.slab_memory_ratio = total_bytes > 0.0 ? slab_bytes / total_bytes : 0.0;
+    double routed_share = config.pool_memory_ratio + config.slab_memory_ratio;
+    if (routed_share > 1.0 - options.buddy_reserve) {
+        double scale = (1.0 - options.buddy_reserve) / routed_share;
+        config.pool_memory_ratio *= scale;
+        config.slab_memory_ratio *= scale;
+    }
+    size_t suggested_size = static_cast<size_t>(total_bytes / (1.0 - options.buddy_reserve));
+
+    // Compare against the built-in classes so the gain is visible
+    HybridAllocator::HybridConfig defaults;
+    SizeClassTable default_table(std::max(defaults.pool_max_size, defaults.slab_max_size),
+                                 defaults.max_internal_fragmentation);
+    const std::vector<size_t>& default_classes = default_table.getClassSizes();
+    std::vector<size_t> tuned_classes = config.pool_block_sizes;
+    tuned_classes.insert(tuned_classes.end(), config.slab_object_sizes.begin(), config.slab_object_sizes.end());
+
+    std::ostringstream out;
+    out << "# Generated by hybrid_tuner from " << options.profile_path << "\n";
+    out << "# Suggested total memory: " << suggested_size << " bytes\n";
+    out << "# Internal fragmentation: " << internalFragmentation(routed, tuned_classes) << "% (default classes: "
+        << internalFragmentation(routed, default_classes) << "%)\n";
+    out << config.toString() << "\n";
+
+    if (options.output_path.empty()) {
+        std::cout << out.str();
+    } else {
+        std::ofstream file(options.output_path);
+        if (!(file << out.str())) {
+            std::cerr << "Cannot write " << options.output_path << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+#include "allocation_trace.h"
+#include "allocator_adapters.h"
+#include "buddy_allocator.h"
+#include "hybrid_allocator.h"
+#include "latency_histogram.h"
+#include "pool_allocator.h"
+#include "size_class_table.h"
+#include "slab_allocator.h"
+#include "stats_counters.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Replays a binary allocation trace against the allocators
+ *
+ * Traces come from TracingAllocator or from the preload library
+ * (HYBRID_MALLOC_TRACE=path). Every traced thread gets a replay thread that runs
+ * its calls in program order, as fast as possible (think time is not replayed).
+ * A free of an object allocated on another thread waits until that allocation
+ * has been replayed; --strict runs every call in the traced global order instead.
+ *
+ * - Frees of objects the trace never saw allocated (memory from before tracing
+ *   started) are dropped; objects still live at the end are freed untimed.
+ * - pool uses SizeClassTable classes up to --max-class bytes, provisioned for
+ *   the peak live count of each class in the trace; slab has one object size,
+ *   the largest request up to --max-class. Larger requests count as failures.
+ *
+ * Reports throughput, allocate/deallocate latency percentiles (every call is
+ * timed) and the allocator's peak allocated bytes against the peak of requested
+ * bytes in the same replay (threads interleave differently from the traced run,
+ * so the traced peak is only reached with --strict).
+ *
+ * Usage: trace_replay <trace> [buddy|slab|pool|hybrid ...] [--memory BYTES]
+ *                     [--max-class BYTES] [--hybrid-config TEXT|@file] [--strict]
+ */
+
+namespace {
+
+struct ReplayOptions {
+    std::string trace_path;
+    std::vector<std::string> allocators;
+    size_t memory = 0;          // 0: from the trace's peak
+    size_t max_class = 4096;
+    std::string hybrid_config;
+    bool strict = false;
+};
+
+struct ReplayOp {
+    uint64_t sequence;          // Position in the traced global order
+    uint32_t slot;              // Object, numbered by allocation
+    TraceOp op;
+    bool sized;                 // Free passed its size
+};
+
+struct ReplayPlan {
+    std::vector<std::vector<ReplayOp>> per_thread;
+    std::vector<size_t> slot_size;
+    std::vector<size_t> slot_alignment;   // 0 = natural
+    std::vector<size_t> class_peak_live;  // Pool provisioning, per SizeClassTable class
+    size_t operations = 0;
+    size_t unmatched_frees = 0;
+    size_t failed_in_trace = 0;
+    size_t peak_requested = 0;
+    size_t max_request = 0;
+    double traced_seconds = 0.0;
+};
+
+struct Slot {
+    std::atomic<void*> ptr{nullptr};
+    std::atomic<bool> replayed{false};
+};
+
+struct ReplayResult {
+    double seconds = 0.0;
+    size_t failures = 0;
+    size_t peak_allocated = 0;
+    StatsCounters requested;          // Bytes the replay asked for, peak included
+    LatencyHistogram allocate;
+    LatencyHistogram deallocate;
+};
+
+void printUsage() {
+    std::cerr << "Usage: trace_replay <trace> [buddy|slab|pool|hybrid ...] [--memory BYTES]\n"
+              << "                    [--max-class BYTES] [--hybrid-config TEXT|@file] [--strict]\n";
+}
+
+bool parseOptions(int argc, char* argv[], ReplayOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--memory" && has_value) options.memory = std::stoull(argv[++i]);
+        else if (arg == "--max-class" && has_value) options.max_class = std::stoull(argv[++i]);
+        else if (arg == "--hybrid-config" && has_value) options.hybrid_config = argv[++i];
+        else if (arg == "--strict") options.strict = true;
+        else if (arg == "buddy" || arg == "slab" || arg == "pool" || arg == "hybrid") options.allocators.push_back(arg);
+        else if (arg[0] != '-' && options.trace_path.empty()) options.trace_path = arg;
+        else return false;
+    }
+    if (options.allocators.empty()) {
+        options.allocators = {"buddy", "slab", "pool", "hybrid"};
+    }
+    return !options.trace_path.empty();
+}
+
+ReplayPlan buildPlan(const AllocationTrace& trace, const SizeClassTable& classes) {
+    ReplayPlan plan;
+    plan.per_thread.resize(trace.thread_count);
+    plan.class_peak_live.assign(classes.getClassCount(), 0);
+    std::vector<size_t> class_live(classes.getClassCount(), 0);
+
+    std::unordered_map<uint64_t, uint32_t> live; // Traced address -> slot
+    size_t requested = 0;
+
+    for (const TraceRecord& record : trace.records) {
+        ReplayOp op{plan.operations, 0, static_cast<TraceOp>(record.op), record.size != 0};
+
+        if (op.op == TraceOp::ALLOCATE) {
+            if (record.object_id == 0) {
+                ++plan.failed_in_trace;
+                continue;
+            }
+            op.slot = static_cast<uint32_t>(plan.slot_size.size());
+            // An address still live here was freed on a thread whose record lost the race; the old slot leaks
+            live[record.object_id] = op.slot;
+            plan.slot_size.push_back(record.size);
+            plan.slot_alignment.push_back(record.alignment_log2 ? size_t(1) << record.alignment_log2 : 0);
+
+            requested += record.size;
+            plan.peak_requested = std::max(plan.peak_requested, requested);
+            plan.max_request = std::max<size_t>(plan.max_request, record.size);
+            size_t size_class = classes.classIndex(record.size);
+            if (size_class < class_live.size()) {
+                plan.class_peak_live[size_class] = std::max(plan.class_peak_live[size_class], ++class_live[size_class]);
+            }
+        } else {
+            auto found = live.find(record.object_id);
+            if (found == live.end()) {
+                ++plan.unmatched_frees;
+                continue;
+            }
+            op.slot = found->second;
+            live.erase(found);
+
+            size_t size = plan.slot_size[op.slot];
+            requested -= size;
+            size_t size_class = classes.classIndex(size);
+            if (size_class < class_live.size()) --class_live[size_class];
+        }
+        plan.per_thread[record.thread].push_back(op);
+        ++plan.operations;
+    }
+
+    if (!trace.records.empty()) {
+        plan.traced_seconds = trace.records.back().timestamp * trace.ns_per_tick / 1e9;
+    }
+    return plan;
+}
+
+size_t nextPowerOfTwo(size_t size) {
+    size_t power = 1;
+    while (power < size) power <<= 1;
+    return power;
+}
+
+std::unique_ptr<MemoryAllocator> createAllocator(const std::string& name, const ReplayOptions& options,
+                                                 const ReplayPlan& plan, const SizeClassTable& classes,
+                                                 size_t memory) {
+    if (name == "buddy") {
+        return std::make_unique<BuddyAllocator>(memory);
+    }
+    if (name == "slab") {
+        size_t object_size = (std::min(std::max<size_t>(plan.max_request, 8), options.max_class) + 7) & ~size_t(7);
+        return std::make_unique<SlabAllocator>(object_size, 64, memory);
+    }
+    if (name == "pool") {
+        PoolAllocator::PoolConfig config;
+        config.total_memory = 0;
+        for (size_t c = 0; c < classes.getClassCount(); ++c) {
+            size_t peak = plan.class_peak_live[c];
+            if (peak == 0) continue;
+            size_t blocks = peak + peak / 4 + 8; // Replayed frees can lag behind the traced order
+            config.block_sizes.push_back(classes.getClassSize(c));
+            config.blocks_per_pool.push_back(blocks);
+            config.total_memory += classes.getClassSize(c) * blocks;
+        }
+        if (config.block_sizes.empty()) {
+            config.block_sizes.push_back(classes.getClassSize(0));
+            config.blocks_per_pool.push_back(1);
+            config.total_memory = classes.getClassSize(0);
+        }
+        return std::make_unique<PoolAllocator>(config);
+    }
+
+    HybridAllocator::HybridConfig config;
+    if (!options.hybrid_config.empty() && options.hybrid_config[0] == '@') {
+        config = HybridAllocator::HybridConfig::load(options.hybrid_config.substr(1));
+    } else if (!options.hybrid_config.empty()) {
+        config = HybridAllocator::HybridConfig::fromString(options.hybrid_config);
+    }
+    return std::make_unique<HybridAllocator>(memory, config);
+}
+
+void replayThread(MemoryAllocator& allocator, const ReplayPlan& plan, const std::vector<ReplayOp>& ops,
+                  std::vector<Slot>& slots, std::atomic<uint64_t>& turn, bool strict,
+                  std::atomic<bool>& start, ReplayResult& result, std::atomic<size_t>& failures) {
+    LatencyHistogram allocate_latency;
+    LatencyHistogram deallocate_latency;
+    size_t failed = 0;
+
+    while (!start.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    for (const ReplayOp& op : ops) {
+        if (strict) {
+            while (turn.load(std::memory_order_acquire) != op.sequence) std::this_thread::yield();
+        }
+
+        Slot& slot = slots[op.slot];
+        size_t size = plan.slot_size[op.slot];
+        size_t alignment = plan.slot_alignment[op.slot];
+
+        if (op.op == TraceOp::ALLOCATE) {
+            uint64_t begin = cycle_clock::now();
+            void* ptr = alignment ? allocator_adapters::allocateAligned(allocator, size, alignment)
+                                  : allocator.allocate(size);
+            allocate_latency.record(cycle_clock::now() - begin);
+
+            if (ptr) result.requested.recordAllocation(size);
+            else ++failed;
+            slot.ptr.store(ptr, std::memory_order_relaxed);
+            slot.replayed.store(true, std::memory_order_release);
+        } else {
+            // Allocated on another thread that has not got there yet
+            while (!slot.replayed.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            void* ptr = slot.ptr.exchange(nullptr, std::memory_order_relaxed);
+            if (ptr) {
+                uint64_t begin = cycle_clock::now();
+                if (alignment) allocator_adapters::deallocateAligned(allocator, ptr, size, alignment);
+                else if (op.sized) allocator.deallocate(ptr, size);
+                else allocator.deallocate(ptr);
+                deallocate_latency.record(cycle_clock::now() - begin);
+                result.requested.recordDeallocation(size);
+            }
+        }
+
+        if (strict) turn.store(op.sequence + 1, std::memory_order_release);
+    }
+
+    result.allocate.merge(allocate_latency);
+    result.deallocate.merge(deallocate_latency);
+    failures.fetch_add(failed, std::memory_order_relaxed);
+}
+
+void replay(MemoryAllocator& allocator, const ReplayPlan& plan, bool strict, ReplayResult& result) {
+    std::vector<Slot> slots(plan.slot_size.size());
+    std::atomic<uint64_t> turn{0};
+    std::atomic<bool> start{false};
+    std::atomic<size_t> failures{0};
+
+    std::vector<std::thread> threads;
+    for (const auto& ops : plan.per_thread) {
+        threads.emplace_back(replayThread, std::ref(allocator), std::cref(plan), std::cref(ops), std::ref(slots),
+                             std::ref(turn), strict, std::ref(start), std::ref(result), std::ref(failures));
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    result.failures = failures.load(std::memory_order_relaxed);
+    result.peak_allocated = allocator.getPeakAllocatedSize();
+
+    // Objects the trace never freed
+    for (size_t i = 0; i < slots.size(); ++i) {
+        void* ptr = slots[i].ptr.load(std::memory_order_relaxed);
+        if (!ptr) continue;
+        if (plan.slot_alignment[i]) {
+            allocator_adapters::deallocateAligned(allocator, ptr, plan.slot_size[i], plan.slot_alignment[i]);
+        } else {
+            allocator.deallocate(ptr);
+        }
+    }
+}
+
+void printLatency(const std::string& label, const LatencyHistogram& histogram) {
+    LatencyHistogram::Summary summary = histogram.summary();
+    std::cout << "  " << std::left << std::setw(11) << label << std::right;
+    if (summary.count == 0) {
+        std::cout << "-\n";
+        return;
+    }
+    std::cout << "p50 " << summary.p50_ns << " ns, p99 " << summary.p99_ns << " ns, p99.9 "
+              << summary.p999_ns << " ns, max " << summary.max_ns << " ns\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ReplayOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    AllocationTrace trace;
+    try {
+        trace = AllocationTrace::load(options.trace_path);
+    } catch (const std::exception& e) {
+        std::cerr << "trace_replay: " << e.what() << "\n";
+        return 1;
+    }
+
+    SizeClassTable classes(options.max_class);
+    ReplayPlan plan = buildPlan(trace, classes);
+    size_t memory = options.memory ? options.memory
+                                   : nextPowerOfTwo(std::max<size_t>(4 * plan.peak_requested, 16 * 1024 * 1024));
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "Trace: " << trace.records.size() << " records from " << trace.thread_count << " threads over "
+              << std::setprecision(3) << plan.traced_seconds << " s" << std::setprecision(0) << "\n";
+    std::cout << "  replayed " << plan.operations << " calls (" << plan.slot_size.size() << " allocations), "
+              << plan.unmatched_frees << " frees of untraced memory dropped, "
+              << plan.failed_in_trace << " allocations failed when traced\n";
+    std::cout << "  traced peak requested " << plan.peak_requested << " bytes, largest request " << plan.max_request
+              << " bytes, replay memory " << memory << " bytes"
+              << (options.strict ? ", strict order" : "") << "\n\n";
+
+    for (const std::string& name : options.allocators) {
+        std::unique_ptr<MemoryAllocator> allocator;
+        try {
+            allocator = createAllocator(name, options, plan, classes, memory);
+        } catch (const std::exception& e) {
+            std::cerr << name << ": " << e.what() << "\n";
+            continue;
+        }
+
+        ReplayResult result;
+        replay(*allocator, plan, options.strict, result);
+
+        double ops_per_second = result.seconds > 0 ? plan.operations / result.seconds : 0.0;
+        std::cout << name << ": " << std::setprecision(3) << result.seconds << " s, "
+                  << std::setprecision(2) << ops_per_second / 1e6 << " M calls/s, "
+                  << result.failures << " failed allocations\n" << std::setprecision(0);
+        printLatency("allocate", result.allocate);
+        printLatency("deallocate", result.deallocate);
+        size_t peak_requested = result.requested.snapshot().peak_bytes;
+        std::cout << "  peak allocated " << result.peak_allocated << " bytes for " << peak_requested << " requested";
+        if (peak_requested > 0) {
+            double overhead = 100.0 * (static_cast<double>(result.peak_allocated) / peak_requested - 1.0);
+            std::cout << " (" << std::showpos << overhead << std::noshowpos << "%)";
+        }
+        std::cout << "\n\n";
+    }
+    return 0;
+}